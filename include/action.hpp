@@ -22,7 +22,10 @@
 #ifndef LIBSEMIGROUPS_INCLUDE_ACTION_HPP_
 #define LIBSEMIGROUPS_INCLUDE_ACTION_HPP_
 
+#include <algorithm>      // for min
 #include <cstddef>        // for size_t
+#include <cstdint>        // for uint8_t, uint64_t
+#include <thread>         // for thread::hardware_concurrency, get_id
 #include <type_traits>    // for is_trivially_default_construc...
 #include <unordered_map>  // for unordered_map
 #include <vector>         // for vector
@@ -30,9 +33,11 @@
 #include "adapters.hpp"                 // for One
 #include "bruidhinn-traits.hpp"         // for detail::BruidhinnTraits
 #include "digraph.hpp"                  // for ActionDigraph
+#include "forest.hpp"                   // for Forest
 #include "libsemigroups-debug.hpp"      // for LIBSEMIGROUPS_ASSERT
 #include "libsemigroups-exception.hpp"  // for LIBSEMIGROUPS_EXCEPTION
-#include "report.hpp"                   // for REPORT_DEFAULT
+#include "parallel.hpp"                 // for detail::parallel_for
+#include "report.hpp"                   // for REPORT_DEFAULT, THREAD_ID_MANAGER
 #include "runner.hpp"                   // for Runner
 
 namespace libsemigroups {
@@ -48,6 +53,24 @@ namespace libsemigroups {
     right
   };
 
+  namespace detail {
+    // ActionUsesFlatIndex<T>::value is T::flat_index if T has a static data
+    // member flat_index, and false if not, so that traits classes written
+    // before flat_index existed can still be used.
+    template <typename T>
+    struct ActionUsesFlatIndex {
+     private:
+      template <typename S>
+      static std::integral_constant<bool, S::flat_index> test(int);
+
+      template <typename S>
+      static std::false_type test(...);
+
+     public:
+      static constexpr bool value = decltype(test<T>(0))::value;
+    };
+  }  // namespace detail
+
   //! Defined in ``action.hpp``.
   //!
   //! This page contains details of the Action class in ``libsemigroups`` for
@@ -107,7 +130,10 @@ namespace libsemigroups {
   //! The ``run`` member function finds points that can be obtained by acting
   //! on the seeds of \c this by the generators of \c this until no
   //! further points can be found, or Runner::stopped returns \c true.
-  //! This is achieved by performing a breadth first search.
+  //! This is achieved by performing a breadth first search. If
+  //! max_threads() is greater than \c 1, then the images of the points in
+  //! (a block of) the current level of the search are computed in parallel,
+  //! see max_threads(size_t) for details.
   //!
   //! \complexity
   //! The time complexity is \f$O(mn)\f$ where \f$m\f$ is the total
@@ -145,6 +171,144 @@ namespace libsemigroups {
       }
     };
 
+    // The index of the points used if TTraits::flat_index is false (or does
+    // not exist).
+    class MapIndex {
+     public:
+      void reserve(size_t n, std::vector<internal_point_type> const&) {
+        _map.reserve(n);
+      }
+
+      size_t find(internal_const_point_type x,
+                  std::vector<internal_point_type> const&) const {
+        auto it = _map.find(x);
+        return (it == _map.end() ? size_t(UNDEFINED) : (*it).second);
+      }
+
+      void insert(size_t pos, std::vector<internal_point_type> const& orb) {
+        _map.emplace(orb[pos], pos);
+      }
+
+      size_t memory_used() const noexcept {
+        // Every node in the map contains a key, a value, and a pointer to the
+        // next node.
+        return _map.bucket_count() * sizeof(void*)
+               + _map.size()
+                     * (sizeof(internal_const_point_type) + sizeof(size_t)
+                        + sizeof(void*));
+      }
+
+     private:
+      std::unordered_map<internal_const_point_type,
+                         size_t,
+                         InternalHash,
+                         InternalEqualTo>
+          _map;
+    };
+
+    // The index of the points used if TTraits::flat_index is true. This is
+    // an open addressing hash table with linear probing which only contains
+    // the positions of the points in _orb (and an 8-bit fingerprint of the
+    // hash value of each point, so that most comparisons of unequal points
+    // are avoided). The points themselves are only stored in _orb.
+    class FlatIndex {
+     public:
+      FlatIndex() : _fingerprints(), _nr(0), _shift(64), _slots() {}
+
+      void reserve(size_t n, std::vector<internal_point_type> const& orb) {
+        if (2 * n > _slots.size()) {
+          rehash(2 * n, orb);
+        }
+      }
+
+      size_t find(internal_const_point_type               x,
+                  std::vector<internal_point_type> const& orb) const {
+        if (_slots.empty()) {
+          return UNDEFINED;
+        }
+        uint64_t const h    = hash(x);
+        uint8_t const  fp   = fingerprint(h);
+        size_t const   mask = _slots.size() - 1;
+        for (size_t i = slot(h);; i = (i + 1) & mask) {
+          if (_slots[i] == UNDEFINED) {
+            return UNDEFINED;
+          } else if (_fingerprints[i] == fp
+                     && InternalEqualTo()(orb[_slots[i]], x)) {
+            return _slots[i];
+          }
+        }
+      }
+
+      void insert(size_t pos, std::vector<internal_point_type> const& orb) {
+        // The load factor is at most 1/2
+        if (2 * (_nr + 1) > _slots.size()) {
+          rehash(2 * (_nr + 1), orb);
+        }
+        place(pos, hash(orb[pos]));
+        ++_nr;
+      }
+
+      size_t memory_used() const noexcept {
+        return _slots.capacity() * sizeof(size_t)
+               + _fingerprints.capacity() * sizeof(uint8_t);
+      }
+
+     private:
+      static uint64_t hash(internal_const_point_type x) {
+        // Fibonacci hashing, since many hash functions for points (such as
+        // std::hash for integers) do not change the low bits at all.
+        return static_cast<uint64_t>(InternalHash()(x))
+               * uint64_t(0x9E3779B97F4A7C15);
+      }
+
+      size_t slot(uint64_t h) const noexcept {
+        return (_shift == 64 ? 0 : static_cast<size_t>(h >> _shift));
+      }
+
+      uint8_t fingerprint(uint64_t h) const noexcept {
+        // The 8 bits below those used by slot(h)
+        return static_cast<uint8_t>(h >> (_shift - 8));
+      }
+
+      void place(size_t pos, uint64_t h) {
+        size_t const mask = _slots.size() - 1;
+        size_t       i    = slot(h);
+        while (_slots[i] != UNDEFINED) {
+          i = (i + 1) & mask;
+        }
+        _slots[i]        = pos;
+        _fingerprints[i] = fingerprint(h);
+      }
+
+      // Rehashes so that there are at least n slots.
+      void rehash(size_t n, std::vector<internal_point_type> const& orb) {
+        size_t size = 16;
+        _shift      = 60;
+        while (size < n) {
+          size *= 2;
+          _shift--;
+        }
+        std::vector<size_t> old(size, size_t(UNDEFINED));
+        std::swap(old, _slots);
+        _fingerprints.assign(size, 0);
+        for (auto pos : old) {
+          if (pos != UNDEFINED) {
+            place(pos, hash(orb[pos]));
+          }
+        }
+      }
+
+      std::vector<uint8_t> _fingerprints;
+      size_t               _nr;
+      size_t               _shift;
+      std::vector<size_t>  _slots;
+    };
+
+    using Index =
+        typename std::conditional<detail::ActionUsesFlatIndex<TTraits>::value,
+                                  FlatIndex,
+                                  MapIndex>::type;
+
     static_assert(
         std::is_const<internal_const_point_type>::value
             || std::is_const<typename std::remove_pointer<
@@ -225,17 +389,19 @@ namespace libsemigroups {
     template <typename TSfinae = void>
     auto internal_product(element_type &      xy,
                           element_type const &x,
-                          element_type const &y) ->
+                          element_type const &y,
+                          size_t              tid = 0) ->
         typename std::enable_if<side::right == TLeftOrRight, TSfinae>::type {
-      Product()(xy, x, y);
+      Product()(xy, x, y, tid);
     }
 
     template <typename TSfinae = void>
     auto internal_product(element_type &      xy,
                           element_type const &x,
-                          element_type const &y) ->
+                          element_type const &y,
+                          size_t              tid = 0) ->
         typename std::enable_if<side::left == TLeftOrRight, TSfinae>::type {
-      Product()(xy, y, x);
+      Product()(xy, y, x, tid);
     }
 
    public:
@@ -255,9 +421,13 @@ namespace libsemigroups {
     //! \par Parameters
     //! (None)
     Action()
-        : _gens(),
+        : _cache_scc_multipliers(false),
+          _gens(),
           _graph(),
-          _map(),
+          _index(),
+          _max_threads(1),
+          _multipliers_from_scc_root(),
+          _multipliers_to_scc_root(),
           _orb(),
           _pos(0),
           _tmp_point(),
@@ -304,8 +474,8 @@ namespace libsemigroups {
     //! At most linear in the size() of the Action.
     void reserve(size_t val) {
       _graph.reserve(val, _gens.size());
-      _map.reserve(val);
       _orb.reserve(val);
+      _index.reserve(val, _orb);
     }
 
     //! Add a seed to the action.
@@ -329,9 +499,10 @@ namespace libsemigroups {
         _tmp_point_init = true;
         _tmp_point      = this->internal_copy(internal_seed);
       }
-      _map.emplace(internal_seed, _orb.size());
       _orb.push_back(internal_seed);
+      _index.insert(_orb.size() - 1, _orb);
       _graph.add_nodes(1);
+      clear_multipliers();
     }
 
     //! Add a generator to the action. An Action instance represents the
@@ -349,6 +520,100 @@ namespace libsemigroups {
     //! At most linear in the size() of the action.
     void add_generator(element_type gen) {
       _gens.push_back(gen);
+      clear_multipliers();
+    }
+
+    //! Set the maximum number of threads.
+    //!
+    //! This member function sets the maximum number of threads used to
+    //! enumerate the action. If \p nr_threads is greater than \c 1, then the
+    //! points are processed in blocks, the images of the points in a block
+    //! under the generators (and whether or not these images have been seen
+    //! before) are computed in parallel, and then the new points are added
+    //! in this thread. The points and the digraph of the action are the same
+    //! for every value of \p nr_threads.
+    //!
+    //! The default value is \c 1.
+    //!
+    //! \param nr_threads the maximum number of threads to use, a value of \c
+    //! 0 is treated as \c 1.
+    //!
+    //! \returns A reference to \c this.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    Action &max_threads(size_t nr_threads) noexcept {
+      _max_threads = (nr_threads == 0 ? 1 : nr_threads);
+      return *this;
+    }
+
+    //! Returns the current value of the maximum number of threads.
+    //!
+    //! \returns
+    //! A `size_t`.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    //!
+    //! \par Parameters
+    //! (None)
+    size_t max_threads() const noexcept {
+      return _max_threads;
+    }
+
+    //! Set whether or not to cache the multipliers to and from the roots of
+    //! the strongly connected components.
+    //!
+    //! If \p val is \c true, then the first call to
+    //! multiplier_from_scc_root (or multiplier_to_scc_root) computes the
+    //! multipliers for every point in the action at that time, and these are
+    //! stored, so that subsequent calls only copy the stored value. The
+    //! multiplier of a point is computed from that of its parent in the
+    //! (reverse) spanning forest using a single product, and so this
+    //! requires one product per point in total, rather than one product
+    //! for every point on the path to the root for every call. The stored
+    //! multipliers are discarded if the action changes.
+    //!
+    //! The default value is \c false.
+    //!
+    //! \param val whether or not to cache the multipliers.
+    //!
+    //! \returns A reference to \c this.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    //!
+    //! \sa multipliers_from_scc_root and multipliers_to_scc_root.
+    Action &cache_scc_multipliers(bool val) noexcept {
+      _cache_scc_multipliers = val;
+      return *this;
+    }
+
+    //! Returns whether or not the multipliers to and from the roots of the
+    //! strongly connected components are cached.
+    //!
+    //! \returns
+    //! A `bool`.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    //!
+    //! \par Parameters
+    //! (None)
+    bool cache_scc_multipliers() const noexcept {
+      return _cache_scc_multipliers;
     }
 
     ////////////////////////////////////////////////////////////////////////
@@ -368,12 +633,7 @@ namespace libsemigroups {
     //! \complexity
     //! Constant.
     index_type position(const_reference_point_type pt) const {
-      auto it = _map.find(this->to_internal_const(pt));
-      if (it != _map.end()) {
-        return (*it).second;
-      } else {
-        return UNDEFINED;
-      }
+      return _index.find(this->to_internal_const(pt), _orb);
     }
 
     //! Checks if the Action has no elements.
@@ -522,6 +782,10 @@ namespace libsemigroups {
     element_type multiplier_from_scc_root(index_type pos) {
       validate_gens();
       validate_index(pos);
+      if (_cache_scc_multipliers) {
+        init_multipliers_from_scc_root();
+        return _multipliers_from_scc_root[pos];
+      }
       element_type out = One()(_gens[0]);
       element_type tmp = One()(_gens[0]);
       while (_graph.spanning_forest().parent(pos) != UNDEFINED) {
@@ -551,6 +815,10 @@ namespace libsemigroups {
     element_type multiplier_to_scc_root(index_type pos) {
       validate_gens();
       validate_index(pos);
+      if (_cache_scc_multipliers) {
+        init_multipliers_to_scc_root();
+        return _multipliers_to_scc_root[pos];
+      }
       element_type out = One()(_gens[0]);
       element_type tmp = One()(_gens[0]);
       while (_graph.reverse_spanning_forest().parent(pos) != UNDEFINED) {
@@ -562,6 +830,60 @@ namespace libsemigroups {
       return out;
     }
 
+    //! Returns the multipliers from the roots of the strongly connected
+    //! components for all of the points in the action.
+    //!
+    //! The value in position \c i of the returned vector equals
+    //! `multiplier_from_scc_root(i)`. The multipliers are computed using
+    //! one product per point, and in parallel using up to max_threads()
+    //! threads. The multipliers are stored whether or not
+    //! cache_scc_multipliers() is \c true.
+    //!
+    //! \returns A const reference to a `std::vector<TElementType>`.
+    //!
+    //! \complexity
+    //! At most \f$O(mn)\f$ where \f$m\f$ is the complexity of multiplying
+    //! elements of type \c TElementType and \f$n\f$ is the size of the fully
+    //! enumerated orbit.
+    //!
+    //! \throws LibsemigroupsException if there are no generators yet added.
+    //!
+    //! \par Parameters
+    //! (None)
+    std::vector<element_type> const &multipliers_from_scc_root() {
+      run();
+      validate_gens();
+      init_multipliers_from_scc_root();
+      return _multipliers_from_scc_root;
+    }
+
+    //! Returns the multipliers to the roots of the strongly connected
+    //! components for all of the points in the action.
+    //!
+    //! The value in position \c i of the returned vector equals
+    //! `multiplier_to_scc_root(i)`. The multipliers are computed using
+    //! one product per point, and in parallel using up to max_threads()
+    //! threads. The multipliers are stored whether or not
+    //! cache_scc_multipliers() is \c true.
+    //!
+    //! \returns A const reference to a `std::vector<TElementType>`.
+    //!
+    //! \complexity
+    //! At most \f$O(mn)\f$ where \f$m\f$ is the complexity of multiplying
+    //! elements of type \c TElementType and \f$n\f$ is the size of the fully
+    //! enumerated orbit.
+    //!
+    //! \throws LibsemigroupsException if there are no generators yet added.
+    //!
+    //! \par Parameters
+    //! (None)
+    std::vector<element_type> const &multipliers_to_scc_root() {
+      run();
+      validate_gens();
+      init_multipliers_to_scc_root();
+      return _multipliers_to_scc_root;
+    }
+
     //! Returns an Action::const_reference_point_type to the root point of
     //! the strongly connected component of the action containing the point \p
     //! x.
@@ -618,6 +940,30 @@ namespace libsemigroups {
       return _graph;
     }
 
+    ////////////////////////////////////////////////////////////////////////
+    // Runner - overridden member functions - public
+    ////////////////////////////////////////////////////////////////////////
+
+    //! Returns an estimate of the number of bytes used by the points, the
+    //! index of the points, the digraph, and the stored multipliers (if
+    //! any), of the action. Any memory allocated by the points or the
+    //! multipliers themselves (rather than the containers holding them) is
+    //! not included. This is the value compared with Runner::memory_limit.
+    //!
+    //! \complexity
+    //! Constant.
+    //!
+    //! \par Parameters
+    //! (None)
+    size_t memory_used() const override {
+      return _orb.capacity() * sizeof(internal_point_type)
+             + _index.memory_used()
+             + _graph.nr_nodes() * _graph.out_degree() * sizeof(size_t)
+             + (_multipliers_from_scc_root.capacity()
+                + _multipliers_to_scc_root.capacity())
+                   * sizeof(element_type);
+    }
+
    private:
     ////////////////////////////////////////////////////////////////////////
     // Runner - pure virtual member functions - private
@@ -628,6 +974,7 @@ namespace libsemigroups {
     }
 
     void run_impl() override {
+      clear_multipliers();
       size_t old_nr_gens = _graph.out_degree();
       _graph.add_to_out_degree(_gens.size() - _graph.out_degree());
       if (started() && old_nr_gens < _gens.size()) {
@@ -637,32 +984,35 @@ namespace libsemigroups {
             ActionOp()(this->to_external(_tmp_point),
                        this->to_external_const(_orb[i]),
                        _gens[j]);
-            auto it = _map.find(_tmp_point);
-            if (it == _map.end()) {
+            size_t const pt = _index.find(_tmp_point, _orb);
+            if (pt == UNDEFINED) {
               _graph.add_nodes(1);
               _graph.add_edge(i, _orb.size(), j);
               _orb.push_back(this->internal_copy(_tmp_point));
-              _map.emplace(_orb.back(), _orb.size() - 1);
+              _index.insert(_orb.size() - 1, _orb);
             } else {
-              _graph.add_edge(i, (*it).second, j);
+              _graph.add_edge(i, pt, j);
             }
           }
         }
       }
 
+      if (_max_threads > 1) {
+        run_parallel();
+      }
       for (; _pos < _orb.size() && !stopped(); ++_pos) {
         for (size_t j = 0; j < _gens.size(); ++j) {
           ActionOp()(this->to_external(_tmp_point),
                      this->to_external_const(_orb[_pos]),
                      _gens[j]);
-          auto it = _map.find(_tmp_point);
-          if (it == _map.end()) {
+          size_t const pt = _index.find(_tmp_point, _orb);
+          if (pt == UNDEFINED) {
             _graph.add_nodes(1);
             _graph.add_edge(_pos, _orb.size(), j);
             _orb.push_back(this->internal_copy(_tmp_point));
-            _map.emplace(_orb.back(), _orb.size() - 1);
+            _index.insert(_orb.size() - 1, _orb);
           } else {
-            _graph.add_edge(_pos, (*it).second, j);
+            _graph.add_edge(_pos, pt, j);
           }
         }
         if (report()) {
@@ -676,8 +1026,178 @@ namespace libsemigroups {
     // Action - member functions - private
     ////////////////////////////////////////////////////////////////////////
 
+    // The points are processed in blocks. The images of the points in a
+    // block under the generators, and their positions (if any) in the points
+    // found before the block, are computed in parallel, since neither the
+    // points nor _index are modified while this happens. The new points and
+    // the edges of the digraph are then added in this thread, in the same
+    // order as in the serial loop in run_impl, and so the result does not
+    // depend on the number of threads.
+    void run_parallel() {
+      size_t const nr_gens    = _gens.size();
+      size_t const block_size = 1024 * _max_threads;
+      // Points in an Action are not necessarily small, and so we only
+      // compute the images for so many points at a time.
+      std::vector<internal_point_type> images;
+      std::vector<size_t>              found;
+
+      while (_pos < _orb.size() && !stopped()) {
+        size_t const first = _pos;
+        size_t const last  = std::min(_orb.size(), first + block_size);
+        size_t const n     = (last - first) * nr_gens;
+        while (images.size() < n) {
+          images.push_back(this->internal_copy(_tmp_point));
+        }
+        found.resize(n);
+        detail::parallel_for(
+            last - first,
+            _max_threads,
+            64,
+            [this, &images, &found, first, nr_gens](size_t i, size_t j) {
+              for (size_t m = i * nr_gens; m < j * nr_gens; ++m) {
+                ActionOp()(this->to_external(images[m]),
+                           this->to_external_const(_orb[first + m / nr_gens]),
+                           _gens[m % nr_gens]);
+                found[m] = _index.find(images[m], _orb);
+              }
+            });
+        for (size_t m = 0; m < n; ++m) {
+          size_t pt = found[m];
+          if (pt == UNDEFINED) {
+            // images[m] might equal a point found earlier in this block
+            pt = _index.find(images[m], _orb);
+            if (pt == UNDEFINED) {
+              pt = _orb.size();
+              _graph.add_nodes(1);
+              _orb.push_back(this->internal_copy(images[m]));
+              _index.insert(pt, _orb);
+            }
+          }
+          _graph.add_edge(first + m / nr_gens, pt, m % nr_gens);
+        }
+        _pos = last;
+        if (report()) {
+          REPORT_DEFAULT("found %d points, so far\n", _orb.size());
+        }
+      }
+      for (auto pt : images) {
+        this->internal_free(pt);
+      }
+    }
+
+    void clear_multipliers() {
+      _multipliers_from_scc_root.clear();
+      _multipliers_to_scc_root.clear();
+    }
+
+    void init_multipliers_from_scc_root() {
+      if (_multipliers_from_scc_root.size() != _orb.size()) {
+        init_multipliers(true, _multipliers_from_scc_root);
+      }
+    }
+
+    void init_multipliers_to_scc_root() {
+      if (_multipliers_to_scc_root.size() != _orb.size()) {
+        init_multipliers(false, _multipliers_to_scc_root);
+      }
+    }
+
+    // Computes the multiplier of every point from (if from is true) or to
+    // the root of its strongly connected component. The multiplier of a
+    // point is the product of the multiplier of its parent in the (reverse)
+    // spanning forest and a single generator, and so the points are
+    // processed in order of their depth in the forest, and the multipliers
+    // of the points at the same depth are computed in parallel.
+    void init_multipliers(bool from, std::vector<element_type> &out) {
+      Forest const &forest = (from ? _graph.spanning_forest()
+                                   : _graph.reverse_spanning_forest());
+      size_t const  n      = _orb.size();
+
+      // Find the depth of every point, and sort the points by depth
+      std::vector<size_t> depth(n, size_t(UNDEFINED));
+      std::vector<size_t> stack;
+      size_t              max_depth = 0;
+      for (size_t i = 0; i < n; ++i) {
+        size_t j = i;
+        while (depth[j] == UNDEFINED && forest.parent(j) != UNDEFINED) {
+          stack.push_back(j);
+          j = forest.parent(j);
+        }
+        if (depth[j] == UNDEFINED) {
+          depth[j] = 0;
+        }
+        for (; !stack.empty(); stack.pop_back()) {
+          depth[stack.back()] = depth[j] + 1;
+          j                   = stack.back();
+        }
+        max_depth = std::max(max_depth, depth[i]);
+      }
+      std::vector<size_t> first(max_depth + 2, 0);
+      for (size_t i = 0; i < n; ++i) {
+        first[depth[i] + 1]++;
+      }
+      for (size_t d = 1; d < first.size(); ++d) {
+        first[d] += first[d - 1];
+      }
+      std::vector<size_t> sorted(n);
+      {
+        std::vector<size_t> next(first.cbegin(), first.cend() - 1);
+        for (size_t i = 0; i < n; ++i) {
+          sorted[next[depth[i]]++] = i;
+        }
+      }
+
+      // The multiplier of every root is the identity, and every other
+      // multiplier is overwritten below. One is called for every point so
+      // that no two multipliers are the same object, if element_type is a
+      // pointer.
+      out.clear();
+      out.reserve(n);
+      for (size_t i = 0; i < n; ++i) {
+        out.push_back(One()(_gens[0]));
+      }
+
+      // The points at every depth are split into at most as many chunks as
+      // there are hardware threads. Some element types use temporary storage
+      // indexed by the thread id in their products, and so every chunk uses
+      // the id of the thread that runs it.
+      size_t const max_chunks = std::min(
+          _max_threads,
+          std::max(size_t(1),
+                   static_cast<size_t>(std::thread::hardware_concurrency())));
+      for (size_t d = 1; d <= max_depth; ++d) {
+        size_t const lo = first[d];
+        size_t const hi = first[d + 1];
+        size_t const nr_chunks
+            = std::max(size_t(1), std::min(max_chunks, (hi - lo) / 64));
+        detail::parallel_for(
+            nr_chunks,
+            nr_chunks,
+            1,
+            [this, &forest, &out, &sorted, from, lo, hi, nr_chunks](
+                size_t c, size_t last_c) {
+              size_t const tid
+                  = THREAD_ID_MANAGER.tid(std::this_thread::get_id());
+              for (; c < last_c; ++c) {
+                size_t const begin = lo + (hi - lo) * c / nr_chunks;
+                size_t const end   = lo + (hi - lo) * (c + 1) / nr_chunks;
+                for (size_t k = begin; k < end; ++k) {
+                  size_t const        pos    = sorted[k];
+                  size_t const        parent = forest.parent(pos);
+                  element_type const &gen    = _gens[forest.label(pos)];
+                  if (from) {
+                    internal_product(out[pos], out[parent], gen, tid);
+                  } else {
+                    internal_product(out[pos], gen, out[parent], tid);
+                  }
+                }
+              }
+            });
+      }
+    }
+
     void validate_index(index_type i) const {
-      if (i > _orb.size()) {
+      if (i >= _orb.size()) {
         LIBSEMIGROUPS_EXCEPTION(
             "index out of range, expected value in [0, %d) but found %d",
             current_size(),
@@ -696,13 +1216,13 @@ namespace libsemigroups {
     // Action - data members - private
     ////////////////////////////////////////////////////////////////////////
 
-    std::vector<element_type> _gens;
-    ActionDigraph<size_t>     _graph;
-    std::unordered_map<internal_const_point_type,
-                       size_t,
-                       InternalHash,
-                       InternalEqualTo>
-                                     _map;
+    bool                             _cache_scc_multipliers;
+    std::vector<element_type>        _gens;
+    ActionDigraph<size_t>            _graph;
+    Index                            _index;
+    size_t                           _max_threads;
+    std::vector<element_type>        _multipliers_from_scc_root;
+    std::vector<element_type>        _multipliers_to_scc_root;
     std::vector<internal_point_type> _orb;
     size_t                           _pos;
     internal_point_type              _tmp_point;
@@ -728,6 +1248,13 @@ namespace libsemigroups {
     using One = ::libsemigroups::One<TElementType>;
     //! \copydoc libsemigroups::Product
     using Product = ::libsemigroups::Product<TElementType>;
+    //! If this is \c true, then an Action looks up its points in a flat open
+    //! addressing hash table, which only contains the positions of the points
+    //! and not copies of the points themselves, rather than in a
+    //! std::unordered_map. This uses considerably less memory for large
+    //! actions on small points, such as BMat8. A traits class without this
+    //! member is treated as if it were \c false.
+    static constexpr bool flat_index = false;
   };
 
   //! This class represents the right action of a semigroup on a set.
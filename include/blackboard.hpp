@@ -0,0 +1,117 @@
+//
+// libsemigroups - C++ library for semigroups and monoids
+// Copyright (C) 2019 James D. Mitchell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// This file contains the declaration of the Blackboard class, which is used
+// by the Runners in a cooperative Race to share the pairs of words that they
+// discover are equal.
+
+#ifndef LIBSEMIGROUPS_INCLUDE_BLACKBOARD_HPP_
+#define LIBSEMIGROUPS_INCLUDE_BLACKBOARD_HPP_
+
+#include <atomic>   // for atomic
+#include <cstddef>  // for size_t
+#include <mutex>    // for mutex, lock_guard
+#include <utility>  // for pair
+#include <vector>   // for vector
+
+#include "types.hpp"  // for word_type, relation_type
+
+namespace libsemigroups {
+  namespace detail {
+    // A Blackboard is an append-only list of pairs of words, together with
+    // the object that published each pair. Every Runner in a cooperative Race
+    // holds a shared_ptr to the same Blackboard, publishes the pairs of words
+    // that it knows to be equal (in the congruence or semigroup that all of
+    // the Runners are computing), and periodically consumes the pairs
+    // published by the other Runners. Since only pairs that hold in the
+    // result are ever published, consuming a pair never changes the result of
+    // a Runner, but it can make it arrive there faster.
+    //
+    // The number of pairs is capped, so that a prolific publisher cannot use
+    // unbounded memory. Once the Blackboard is full, all further pairs are
+    // silently discarded.
+    class Blackboard final {
+     public:
+      explicit Blackboard(size_t max_pairs = 65536)
+          : _max_pairs(max_pairs), _mtx(), _nr_pairs(0), _pairs() {}
+
+      Blackboard(Blackboard const&) = delete;
+      Blackboard(Blackboard&&)      = delete;
+      Blackboard& operator=(Blackboard const&) = delete;
+      Blackboard& operator=(Blackboard&&) = delete;
+
+      ~Blackboard() = default;
+
+      // Publish the pair (u, v) on behalf of source, returns false if the
+      // Blackboard is full, and true otherwise.
+      bool publish(void const* source, word_type const& u, word_type const& v) {
+        if (full()) {
+          return false;
+        }
+        std::lock_guard<std::mutex> lg(_mtx);
+        if (_pairs.size() >= _max_pairs) {
+          return false;
+        }
+        _pairs.emplace_back(source, relation_type(u, v));
+        _nr_pairs = _pairs.size();
+        return true;
+      }
+
+      // Appends to out every pair with index at least pos that was not
+      // published by source, and sets pos to the number of pairs. Returns
+      // true if anything was appended to out. If there are no new pairs, then
+      // this does not lock the mutex.
+      bool consume(void const*                 source,
+                   size_t&                     pos,
+                   std::vector<relation_type>& out) const {
+        if (pos == _nr_pairs) {
+          return false;
+        }
+        std::lock_guard<std::mutex> lg(_mtx);
+        size_t const                n = out.size();
+        for (; pos < _pairs.size(); ++pos) {
+          if (_pairs[pos].first != source) {
+            out.push_back(_pairs[pos].second);
+          }
+        }
+        return out.size() != n;
+      }
+
+      // Returns the number of pairs published so far.
+      size_t nr_pairs() const noexcept {
+        return _nr_pairs;
+      }
+
+      // Returns the maximum number of pairs that can be published.
+      size_t max_pairs() const noexcept {
+        return _max_pairs;
+      }
+
+      bool full() const noexcept {
+        return _nr_pairs >= _max_pairs;
+      }
+
+     private:
+      size_t const                                       _max_pairs;
+      mutable std::mutex                                 _mtx;
+      std::atomic<size_t>                                _nr_pairs;
+      std::vector<std::pair<void const*, relation_type>> _pairs;
+    };
+  }  // namespace detail
+}  // namespace libsemigroups
+#endif  // LIBSEMIGROUPS_INCLUDE_BLACKBOARD_HPP_
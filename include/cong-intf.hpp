@@ -46,6 +46,9 @@ namespace libsemigroups {
   //! common to all its derived classes. CongruenceInterface is an abstract
   //! class.
   class CongruenceInterface : public Runner {
+    // Congruence calls the private member functions of its runners.
+    friend class Congruence;
+
    public:
     ////////////////////////////////////////////////////////////////////////////
     // CongruenceInterface - typedefs + enums - public
@@ -66,6 +69,123 @@ namespace libsemigroups {
     //! \sa cbegin_generating_pairs and cend_generating_pairs.
     using const_iterator = std::vector<relation_type>::const_iterator;
 
+    //! Type for the non-trivial classes of a congruence, where the elements
+    //! of every class are given by their indices in the parent FroidurePin.
+    //!
+    //! The indices of the elements in all of the classes are stored in a
+    //! single array, and the words representing the elements are only
+    //! computed when they are requested.
+    //!
+    //! \sa non_trivial_class_indices.
+    class NonTrivialClassIndices {
+      friend class CongruenceInterface;
+
+     public:
+      //! Type for a `const_iterator` to the indices of the elements of a
+      //! class.
+      using const_iterator = std::vector<size_t>::const_iterator;
+
+      //! Returns the number of non-trivial classes.
+      //!
+      //! \returns A value of type \c size_t.
+      //!
+      //! \exceptions
+      //! \noexcept
+      //!
+      //! \complexity
+      //! Constant.
+      //!
+      //! \par Parameters
+      //! (None)
+      size_t nr_classes() const noexcept {
+        return _first.size() - 1;
+      }
+
+      //! Returns the number of elements in a class.
+      //!
+      //! \param i the index of the class, which must be less than
+      //! nr_classes().
+      //!
+      //! \returns A value of type \c size_t.
+      //!
+      //! \exceptions
+      //! \no_libsemigroups_except
+      //!
+      //! \complexity
+      //! Constant.
+      size_t size(size_t i) const {
+        return _first[i + 1] - _first[i];
+      }
+
+      //! Returns a const iterator pointing to the index (in the parent
+      //! FroidurePin) of the first element of a class.
+      //!
+      //! \param i the index of the class, which must be less than
+      //! nr_classes().
+      //!
+      //! \returns
+      //! A NonTrivialClassIndices::const_iterator.
+      //!
+      //! \exceptions
+      //! \no_libsemigroups_except
+      //!
+      //! \complexity
+      //! Constant.
+      const_iterator cbegin(size_t i) const {
+        return _elements.cbegin() + _first[i];
+      }
+
+      //! Returns a const iterator pointing one-past-the-end of the indices
+      //! (in the parent FroidurePin) of the elements of a class.
+      //!
+      //! \param i the index of the class, which must be less than
+      //! nr_classes().
+      //!
+      //! \returns
+      //! A NonTrivialClassIndices::const_iterator.
+      //!
+      //! \exceptions
+      //! \no_libsemigroups_except
+      //!
+      //! \complexity
+      //! Constant.
+      const_iterator cend(size_t i) const {
+        return _elements.cbegin() + _first[i + 1];
+      }
+
+      //! Returns a word representing an element of a class.
+      //!
+      //! \param i the index of the class.
+      //! \param j the position of the element in the class.
+      //!
+      //! \returns A \ref word_type.
+      //!
+      //! \throws LibsemigroupsException if \p i is not less than
+      //! nr_classes(), or \p j is not less than size(i).
+      //!
+      //! \complexity
+      //! Linear in the length of the returned word.
+      word_type word(size_t i, size_t j) const;
+
+      //! Returns words representing the elements of a class.
+      //!
+      //! \param i the index of the class.
+      //!
+      //! \returns A std::vector of \ref word_type.
+      //!
+      //! \throws LibsemigroupsException if \p i is not less than
+      //! nr_classes().
+      //!
+      //! \complexity
+      //! Linear in the total length of the returned words.
+      std::vector<word_type> words(size_t i) const;
+
+     private:
+      std::vector<size_t>              _elements;
+      std::vector<size_t>              _first;
+      std::shared_ptr<FroidurePinBase> _parent;
+    };
+
     ////////////////////////////////////////////////////////////////////////////
     // CongruenceInterface - constructors + destructor - public
     ////////////////////////////////////////////////////////////////////////////
@@ -126,6 +246,31 @@ namespace libsemigroups {
       return u == v || word_to_class_index(u) == word_to_class_index(v);
     }
 
+    //! Check if each of a collection of pairs of words belongs to the
+    //! congruence.
+    //!
+    //! The item in position \c i of the returned vector is equal to
+    //! \c contains(pairs[i].first, pairs[i].second). Every word in \p pairs
+    //! is validated before anything is computed, and the class indices of
+    //! the words are found using words_to_class_indices, and so possibly
+    //! using up to max_threads() threads.
+    //!
+    //! \param pairs the pairs of words to check.
+    //!
+    //! \returns A std::vector of \c bool.
+    //!
+    //! \throws LibsemigroupsException if any word in \p pairs contains a
+    //! letter that is out of bounds.
+    //!
+    //! \par Complexity
+    //! See warning.
+    //!
+    //! \warning The problem of determining the return value of this function
+    //! is undecidable in general, and this function may never terminate.
+    //!
+    //! \sa contains(word_type const&, word_type const&).
+    virtual std::vector<bool> contains(std::vector<relation_type> const& pairs);
+
     // Same as the above but only uses the so far computed information to
     // answer. In particular, does not call this->run().
     //! Check if a pair of words is known to belong to the congruence.
@@ -254,6 +399,80 @@ namespace libsemigroups {
     //! functions.
     class_index_type word_to_class_index(word_type const& w);
 
+    //! Returns the indices of the congruence classes of a collection of
+    //! words.
+    //!
+    //! The item in position \c i of the returned vector is equal to
+    //! \c word_to_class_index(words[i]). Every word in \p words is validated
+    //! before any class indices are computed. Once the congruence is known,
+    //! the class indices may be computed using up to max_threads() threads,
+    //! depending on the implementation.
+    //!
+    //! \param words the words whose class indices we want to find.
+    //!
+    //! \returns A std::vector of CongruenceInterface::class_index_type.
+    //!
+    //! \throws LibsemigroupsException if any word in \p words contains a
+    //! letter that is out of bounds, or the object has not been fully
+    //! initialised.
+    //!
+    //! \par Complexity
+    //! See warning.
+    //!
+    //! \warning The function for finding the structure of a congruence may be
+    //! non-deterministic, or undecidable, and this function may never return
+    //! a result.
+    //!
+    //! \sa word_to_class_index.
+    std::vector<class_index_type>
+    words_to_class_indices(std::vector<word_type> const& words);
+
+    //! Set the maximum number of threads.
+    //!
+    //! This member function sets the maximum number of threads to be used by
+    //! words_to_class_indices and
+    //! contains(std::vector<relation_type> const&). The number of threads is
+    //! limited to the maximum of 1 and \p nr_threads.
+    //!
+    //! The default value is **std::thread::hardware_concurrency()**.
+    //!
+    //! \param nr_threads the maximum number of threads to use.
+    //!
+    //! \returns A reference to \c this.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    //!
+    //! \sa
+    //! max_threads().
+    CongruenceInterface& max_threads(size_t nr_threads) noexcept {
+      _max_threads = (nr_threads == 0 ? 1 : nr_threads);
+      return *this;
+    }
+
+    //! Returns the current value of the maximum number of threads.
+    //!
+    //! \returns
+    //! A `size_t`.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    //!
+    //! \sa
+    //! max_threads(size_t).
+    //!
+    //! \par Parameters
+    //! (None)
+    size_t max_threads() const noexcept {
+      return _max_threads;
+    }
+
     //! Set the number of generators of the congruence.
     //!
     //! \param n the number of generators.
@@ -394,6 +613,31 @@ namespace libsemigroups {
       return _non_trivial_classes;
     }
 
+    //! Returns a shared pointer to the non-trivial classes, where the
+    //! elements of every class are given by their indices in the parent
+    //! FroidurePin.
+    //!
+    //! This is a more compact alternative to non_trivial_classes, since no
+    //! words are computed until NonTrivialClassIndices::word or
+    //! NonTrivialClassIndices::words is called. The class indices of the
+    //! elements of the parent are computed using up to max_threads()
+    //! threads, depending on the implementation.
+    //!
+    //! \returns A std::shared_ptr to
+    //! CongruenceInterface::NonTrivialClassIndices.
+    //!
+    //! \throws LibsemigroupsException if `!this->has_parent_froidure_pin()`.
+    //!
+    //! \par Complexity
+    //! See warning.
+    //!
+    //! \warning The problem of determining the return value of this function
+    //! is undecidable in general, and this function may never terminate.
+    //!
+    //! \par Parameters
+    //! (None)
+    std::shared_ptr<NonTrivialClassIndices const> non_trivial_class_indices();
+
     //! Returns the number of generators specified by
     //! CongruenceInterface::set_nr_generators.
     //!
@@ -709,6 +953,17 @@ namespace libsemigroups {
     virtual std::shared_ptr<non_trivial_classes_type const>
     non_trivial_classes_impl();
 
+    // Override words_to_class_indices_impl to compute many class indices at
+    // once, for example, in parallel. The words have already been validated.
+    virtual std::vector<class_index_type>
+    words_to_class_indices_impl(std::vector<word_type> const&);
+
+    // Returns the class index of every element of the parent FroidurePin,
+    // which is the argument. Override parent_class_indices_impl to use the
+    // structure of the parent, for example, its Cayley graph.
+    virtual std::vector<class_index_type>
+    parent_class_indices_impl(FroidurePinBase&);
+
     virtual bool is_quotient_obviously_finite_impl() = 0;
     // virtual bool is_quotient_obviously_finite_impl() {
     //   return false;
@@ -742,6 +997,7 @@ namespace libsemigroups {
     // Only data members which (potentially) change the mathematical object
     // defined by *this are non-mutable.
     std::vector<relation_type>       _gen_pairs;
+    size_t                           _max_threads;
     size_t                           _nr_gens;
     std::shared_ptr<LazyFroidurePin> _parent;
     congruence_type                  _type;
@@ -756,6 +1012,8 @@ namespace libsemigroups {
     mutable std::shared_ptr<FroidurePinBase> _quotient;
     mutable std::shared_ptr<non_trivial_classes_type const>
         _non_trivial_classes;
+    mutable std::shared_ptr<NonTrivialClassIndices const>
+        _non_trivial_class_indices;
 
     /////////////////////////////////////////////////////////////////////////
     // CongruenceInterface - static data members - private
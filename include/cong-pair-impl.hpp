@@ -68,9 +68,13 @@ namespace libsemigroups {
         _nr_non_trivial_classes(UNDEFINED),
         _nr_non_trivial_elemnts(UNDEFINED),
         _pairs_to_mult(),
+        _product_index(),
+        _products(),
         _reverse_map(),
         _tmp1(),
-        _tmp2() {}
+        _tmp2() {
+    CongruenceInterface::max_threads(1);
+  }
 
   ////////////////////////////////////////////////////////////////////////
   // CongruenceByPairs - constructor + destructor - public
@@ -168,50 +172,10 @@ namespace libsemigroups {
     detail::Timer t;
     init();
 
-    size_t tid = THREAD_ID_MANAGER.tid(std::this_thread::get_id());
-    while (!_pairs_to_mult.empty() && !stopped()) {
-      // Get the next pair
-      auto& current_pair = _pairs_to_mult.front();
-
-      auto prnt = static_cast<froidure_pin_type*>(parent_froidure_pin().get());
-      // Add its left and/or right multiples
-      for (size_t i = 0; i < prnt->nr_generators(); i++) {
-        const_reference gen = prnt->generator(i);
-        if (kind() == congruence_type::left
-            || kind() == congruence_type::twosided) {
-          Product()(this->to_external(_tmp1),
-                    gen,
-                    this->to_external_const(current_pair.first),
-                    tid);
-          Product()(this->to_external(_tmp2),
-                    gen,
-                    this->to_external_const(current_pair.second),
-                    tid);
-          internal_add_pair(_tmp1, _tmp2);
-        }
-        if (kind() == congruence_type::right
-            || kind() == congruence_type::twosided) {
-          Product()(this->to_external(_tmp1),
-                    this->to_external_const(current_pair.first),
-                    gen,
-                    tid);
-          Product()(this->to_external(_tmp2),
-                    this->to_external_const(current_pair.second),
-                    gen,
-                    tid);
-          internal_add_pair(_tmp1, _tmp2);
-        }
-      }
-      _pairs_to_mult.pop();
-      if (report()) {
-        REPORT_DEFAULT(
-            "found %d pairs: %d elements in %d classes, %d pairs on the "
-            "stack\n",
-            _found_pairs.size(),
-            _map_next,
-            _lookup.nr_blocks(),
-            _pairs_to_mult.size())
-      }
+    if (max_threads() == 1) {
+      run_serial();
+    } else {
+      run_parallel();
     }
 
     if (_pairs_to_mult.empty()) {
@@ -223,7 +187,11 @@ namespace libsemigroups {
         size_t max  = 0;
         LIBSEMIGROUPS_ASSERT(_lookup.find(0) == 0);
         _class_lookup.push_back(0);
-        for (size_t i = 1; i < _lookup.get_size(); i++) {
+        // This loop only stops early if this is killed, and not if it times
+        // out, since finished_impl returns true whether or not the lookup is
+        // complete.
+        detail::CancellationToken cancelled(*this);
+        for (size_t i = 1; i < _lookup.get_size() && !cancelled(); i++) {
           size_t nr = _lookup.find(i);
           if (nr > max) {
             _class_lookup.push_back(_next_class++);
@@ -363,6 +331,11 @@ namespace libsemigroups {
         .swap(_found_pairs);
     std::queue<std::pair<internal_element_type, internal_element_type>>().swap(
         _pairs_to_mult);
+    for (auto& x : _products) {
+      this->internal_free(x);
+    }
+    std::vector<internal_element_type>().swap(_products);
+    std::vector<size_t>().swap(_product_index);
   }
 
   SIZE_T P_CLASS::get_index(internal_element_type x) const {
@@ -373,6 +346,158 @@ namespace libsemigroups {
     return it->second;
   }
 
+  VOID P_CLASS::run_serial() {
+    size_t tid = THREAD_ID_MANAGER.tid(std::this_thread::get_id());
+    while (!_pairs_to_mult.empty() && !stopped()) {
+      // Get the next pair
+      auto& current_pair = _pairs_to_mult.front();
+
+      auto prnt = static_cast<froidure_pin_type*>(parent_froidure_pin().get());
+      // Add its left and/or right multiples
+      for (size_t i = 0; i < prnt->nr_generators(); i++) {
+        const_reference gen = prnt->generator(i);
+        if (kind() == congruence_type::left
+            || kind() == congruence_type::twosided) {
+          Product()(this->to_external(_tmp1),
+                    gen,
+                    this->to_external_const(current_pair.first),
+                    tid);
+          Product()(this->to_external(_tmp2),
+                    gen,
+                    this->to_external_const(current_pair.second),
+                    tid);
+          internal_add_pair(_tmp1, _tmp2);
+        }
+        if (kind() == congruence_type::right
+            || kind() == congruence_type::twosided) {
+          Product()(this->to_external(_tmp1),
+                    this->to_external_const(current_pair.first),
+                    gen,
+                    tid);
+          Product()(this->to_external(_tmp2),
+                    this->to_external_const(current_pair.second),
+                    gen,
+                    tid);
+          internal_add_pair(_tmp1, _tmp2);
+        }
+      }
+      _pairs_to_mult.pop();
+      if (report()) {
+        REPORT_DEFAULT(
+            "found %d pairs: %d elements in %d classes, %d pairs on the "
+            "stack\n",
+            _found_pairs.size(),
+            _map_next,
+            _lookup.nr_blocks(),
+            _pairs_to_mult.size())
+      }
+    }
+  }
+
+  VOID P_CLASS::run_parallel() {
+    auto prnt = static_cast<froidure_pin_type*>(parent_froidure_pin().get());
+    size_t const nr_gens = prnt->nr_generators();
+    bool const   left    = (kind() == congruence_type::left
+                         || kind() == congruence_type::twosided);
+    bool const   right   = (kind() == congruence_type::right
+                          || kind() == congruence_type::twosided);
+    // The number of products computed for every pair in a batch
+    size_t const stride     = 2 * nr_gens * ((left ? 1 : 0) + (right ? 1 : 0));
+    size_t const nr_threads = max_threads();
+    size_t const batch_size = 256 * nr_threads;
+
+    std::vector<std::pair<internal_element_type, internal_element_type>> batch;
+    batch.reserve(batch_size);
+
+    // Computes the products of the pairs in the t-th block of the batch, and
+    // looks them up in _map. Every product has its own slot in _products,
+    // and _map is not modified while this runs, so the threads do not need
+    // to synchronise.
+    auto process = [this, &batch, prnt, nr_gens, nr_threads, left, right,
+                    stride](size_t t, size_t tid) {
+      size_t const first = (batch.size() * t) / nr_threads;
+      size_t const last  = (batch.size() * (t + 1)) / nr_threads;
+      for (size_t k = first; k < last; ++k) {
+        size_t          pos = k * stride;
+        const_reference x   = this->to_external_const(batch[k].first);
+        const_reference y   = this->to_external_const(batch[k].second);
+        for (size_t i = 0; i < nr_gens; ++i) {
+          const_reference gen = prnt->generator(i);
+          if (left) {
+            Product()(this->to_external(_products[pos++]), gen, x, tid);
+            Product()(this->to_external(_products[pos++]), gen, y, tid);
+          }
+          if (right) {
+            Product()(this->to_external(_products[pos++]), x, gen, tid);
+            Product()(this->to_external(_products[pos++]), y, gen, tid);
+          }
+        }
+      }
+      for (size_t pos = first * stride; pos < last * stride; ++pos) {
+        auto it             = _map.find(_products[pos]);
+        _product_index[pos] = (it == _map.end() ? UNDEFINED : it->second);
+      }
+    };
+
+    while (!_pairs_to_mult.empty() && !stopped()) {
+      // The last pair in the batch is only popped from _pairs_to_mult once
+      // the batch has been processed, so that finished() remains false
+      // while new elements are being added.
+      batch.clear();
+      while (batch.size() < batch_size - 1 && _pairs_to_mult.size() > 1) {
+        batch.push_back(_pairs_to_mult.front());
+        _pairs_to_mult.pop();
+      }
+      batch.push_back(_pairs_to_mult.front());
+
+      size_t const nr_products = batch.size() * stride;
+      while (_products.size() < nr_products) {
+        _products.push_back(this->internal_copy(_tmp1));
+      }
+      _product_index.resize(nr_products);
+
+      // The blocks are run on the threads of detail::thread_pool(), and so
+      // the number of thread ids used in the calls to Product is bounded by
+      // the size of the pool.
+      detail::parallel_for(
+          nr_threads, nr_threads, 1, [&process](size_t first, size_t last) {
+            size_t tid = THREAD_ID_MANAGER.tid(std::this_thread::get_id());
+            for (size_t t = first; t < last; ++t) {
+              process(t, tid);
+            }
+          });
+
+      // Add the new elements and pairs in the calling thread. A pair is
+      // only added to _pairs_to_mult if its entries belong to different
+      // classes; otherwise its multiples are consequences of the multiples
+      // of the pairs already added.
+      for (size_t pos = 0; pos < nr_products; pos += 2) {
+        size_t i = _product_index[pos];
+        if (i == UNDEFINED) {
+          i = get_index(_products[pos]);
+        }
+        size_t j = _product_index[pos + 1];
+        if (j == UNDEFINED) {
+          j = get_index(_products[pos + 1]);
+        }
+        if (_lookup.find(i) != _lookup.find(j)) {
+          _lookup.unite(i, j);
+          _pairs_to_mult.emplace(_reverse_map[std::min(i, j)],
+                                 _reverse_map[std::max(i, j)]);
+        }
+      }
+      _pairs_to_mult.pop();
+      if (report()) {
+        REPORT_DEFAULT("%d elements in %d classes, %d pairs on the stack "
+                       "(%d threads)\n",
+                       _map_next,
+                       _lookup.nr_blocks(),
+                       _pairs_to_mult.size(),
+                       nr_threads)
+      }
+    }
+  }
+
   VOID P_CLASS::init() {
     if (!_init_done) {
       LIBSEMIGROUPS_ASSERT(has_parent_froidure_pin());
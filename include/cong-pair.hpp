@@ -67,21 +67,24 @@
 #include <cstddef>        // for size_t
 #include <memory>         // for shared_ptr
 #include <queue>          // for queue
+#include <thread>         // for this_thread
 #include <unordered_map>  // for unordered_map
 #include <unordered_set>  // for unordered_set
 #include <utility>        // for pair
 #include <vector>         // for vector
 
-#include "adapters.hpp"          // for Product
-#include "bruidhinn-traits.hpp"  // for detail::BruidhinnTraits
-#include "cong-intf.hpp"         // for CongruenceInterface::class_index_type
-#include "cong-wrap.hpp"         // for CongruenceWrapper
-#include "froidure-pin.hpp"      // for FroidurePin
-#include "kbe.hpp"               // for detail::KBE
-#include "knuth-bendix.hpp"      // for fpsemigroup::KnuthBendix
-#include "tce.hpp"               // for TCE
-#include "types.hpp"             // for word_type
-#include "uf.hpp"                // for UF
+#include "adapters.hpp"           // for Product
+#include "bruidhinn-traits.hpp"   // for detail::BruidhinnTraits
+#include "cong-intf.hpp"          // for CongruenceInterface::class_index_type
+#include "cong-wrap.hpp"          // for CongruenceWrapper
+#include "froidure-pin-base.hpp"  // for FroidurePinBase
+#include "froidure-pin.hpp"       // for FroidurePin
+#include "kbe.hpp"                // for detail::KBE
+#include "knuth-bendix.hpp"       // for fpsemigroup::KnuthBendix
+#include "parallel.hpp"           // for detail::parallel_for
+#include "tce.hpp"                // for TCE
+#include "types.hpp"              // for word_type
+#include "uf.hpp"                 // for UF
 
 namespace libsemigroups {
   class Element;          // Forward declaration, for default template parameter
@@ -267,6 +270,55 @@ namespace libsemigroups {
     //! This constructor is deleted.
     CongruenceByPairs& operator=(CongruenceByPairs&&) = delete;
 
+    ////////////////////////////////////////////////////////////////////////
+    // CongruenceByPairs - settings - public
+    ////////////////////////////////////////////////////////////////////////
+
+    //! Set the maximum number of threads used to compute the products of the
+    //! pairs found so far with the generators of the parent semigroup.
+    //!
+    //! If the value is \c 1, then the pairs are processed one at a time,
+    //! in the calling thread. Otherwise, the pairs are processed in batches:
+    //! the products of the pairs in a batch with the generators, and the
+    //! look up of these products among the elements found so far, are
+    //! distributed among up to \p nr_threads threads. The products are then
+    //! added to the congruence in the calling thread.  In the latter case,
+    //! the template parameters \p TElementProduct and \p TElementHash must
+    //! be safe to call concurrently on distinct arguments.
+    //!
+    //! The numbers of classes of the congruence do not depend on this value,
+    //! but the class indices of elements (see word_to_class_index) might.
+    //!
+    //! \param nr_threads the maximum number of threads to use, a value of \c
+    //! 0 is treated as \c 1.
+    //!
+    //! \returns
+    //! A reference to \c this.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    CongruenceByPairs& max_threads(size_t nr_threads) noexcept {
+      CongruenceInterface::max_threads(nr_threads);
+      return *this;
+    }
+
+    //! Returns the current value of the maximum number of threads.
+    //!
+    //! \returns
+    //! A `size_t`, the default value is \c 1.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    size_t max_threads() const noexcept {
+      return CongruenceInterface::max_threads();
+    }
+
    protected:
     ////////////////////////////////////////////////////////////////////////
     // CongruenceInterface - non-pure virtual member functions - protected
@@ -325,6 +377,8 @@ namespace libsemigroups {
     void   delete_tmp_storage();
     size_t get_index(internal_element_type) const;
     void   init();
+    void   run_parallel();
+    void   run_serial();
 
     ////////////////////////////////////////////////////////////////////////
     // CongruenceByPairs - inner structs - private
@@ -371,6 +425,8 @@ namespace libsemigroups {
     size_t                   _nr_non_trivial_elemnts;
     std::queue<std::pair<internal_element_type, internal_element_type>>
                                                _pairs_to_mult;
+    std::vector<size_t>                        _product_index;
+    std::vector<internal_element_type>         _products;
     mutable std::vector<internal_element_type> _reverse_map;
     internal_element_type                      _tmp1;
     internal_element_type                      _tmp2;
@@ -510,6 +566,159 @@ namespace libsemigroups {
     std::shared_ptr<KnuthBendix> _kb;
   };
 
+  //! Defined in ``cong-pair.hpp``.
+  //!
+  //! On this page, we describe the functionality relating to the brute force
+  //! enumeration of pairs of elements belonging to a congruence (of any type)
+  //! that is implemented in the class CayleyGraphCongruenceByPairs. This class
+  //! implements the same algorithm as CongruenceByPairs, the difference being
+  //! that CayleyGraphCongruenceByPairs fully enumerates its parent semigroup
+  //! first, and then works only with the indices of elements in the parent,
+  //! and its left and right Cayley graphs. No elements are multiplied, copied,
+  //! or hashed, and so this is much faster than CongruenceByPairs, provided
+  //! that the parent semigroup can be fully enumerated.
+  //!
+  //! Another difference is that a pair of elements is only multiplied by the
+  //! generators if it is not already known to belong to the congruence, and
+  //! so at most \f$n - 1\f$ pairs are multiplied, where \f$n\f$ is the size
+  //! of the parent semigroup.
+  //!
+  //! \sa congruence_type, tril, and CongruenceByPairs.
+  //!
+  //! \par Example
+  //! \code
+  //! using Transf = typename TransfHelper<8>::type;
+  //! FroidurePin<Transf> S({Transf({7, 3, 5, 3, 4, 2, 7, 7}),
+  //!                        Transf({1, 2, 4, 4, 7, 3, 0, 7}),
+  //!                        Transf({0, 6, 4, 2, 2, 6, 6, 4}),
+  //!                        Transf({3, 6, 3, 4, 0, 6, 0, 7})});
+  //!
+  //! CayleyGraphCongruenceByPairs cong(left, S);
+  //! cong.add_pair({0, 3, 2, 1, 3, 2, 2}, {3, 2, 2, 1, 3, 3});
+  //! cong.nr_classes();   // 7449
+  //! \endcode
+  // Implemented in cong-pair.cpp.
+  class CayleyGraphCongruenceByPairs final : public CongruenceInterface {
+   public:
+    ////////////////////////////////////////////////////////////////////////
+    // CayleyGraphCongruenceByPairs - typedefs - public
+    ////////////////////////////////////////////////////////////////////////
+
+    //! The type of the indices of elements in the parent semigroup.
+    using element_index_type = FroidurePinBase::element_index_type;
+
+    ////////////////////////////////////////////////////////////////////////
+    // CayleyGraphCongruenceByPairs - constructors - public
+    ////////////////////////////////////////////////////////////////////////
+
+    //! Construct a CayleyGraphCongruenceByPairs over the FroidurePin instance
+    //! \p S representing a left/right/2-sided congruence according to \p
+    //! type.
+    //!
+    //! \param type whether the congruence is left, right, or 2-sided
+    //! \param S  a shared_ptr to the semigroup over which the congruence is
+    //! defined.
+    //!
+    //! \par Exceptions
+    //! This function is `noexcept` and is guaranteed never to throw.
+    //!
+    //! \par Complexity
+    //! Constant.
+    //!
+    //! \note
+    //! The FroidurePinBase pointed to by \p S is not copied, and it is fully
+    //! enumerated when \c this is run.
+    CayleyGraphCongruenceByPairs(congruence_type                  type,
+                                 std::shared_ptr<FroidurePinBase> S) noexcept;
+
+    //! Construct a CayleyGraphCongruenceByPairs over the FroidurePin instance
+    //! \p S representing a left/right/2-sided congruence according to \p
+    //! type.
+    //!
+    //! \tparam T a class derived from FroidurePinBase.
+    //!
+    //! \param type whether the congruence is left, right, or 2-sided
+    //! \param S  a reference to the semigroup over which the congruence is
+    //! defined.
+    //!
+    //! \par Complexity
+    //! Constant.
+    //!
+    //! \warning the parameter `T& S` is copied, this might be expensive, use
+    //! a std::shared_ptr to avoid the copy!
+    template <typename T>
+    CayleyGraphCongruenceByPairs(congruence_type type, T const& S)
+        : CayleyGraphCongruenceByPairs(
+            type,
+            static_cast<std::shared_ptr<FroidurePinBase>>(
+                std::make_shared<T>(S))) {
+      static_assert(std::is_base_of<FroidurePinBase, T>::value,
+                    "the template parameter must be a derived class of "
+                    "FroidurePinBase");
+    }
+
+    //! Deleted.
+    CayleyGraphCongruenceByPairs() = delete;
+
+    //! Deleted.
+    CayleyGraphCongruenceByPairs(CayleyGraphCongruenceByPairs const&) = delete;
+
+    //! Deleted.
+    CayleyGraphCongruenceByPairs(CayleyGraphCongruenceByPairs&&) = delete;
+
+    //! Deleted.
+    CayleyGraphCongruenceByPairs& operator=(CayleyGraphCongruenceByPairs const&)
+        = delete;
+
+    //! Deleted.
+    CayleyGraphCongruenceByPairs& operator=(CayleyGraphCongruenceByPairs&&)
+        = delete;
+
+   private:
+    ////////////////////////////////////////////////////////////////////////
+    // Runner - pure virtual member functions - private
+    ////////////////////////////////////////////////////////////////////////
+
+    void run_impl() override;
+    bool finished_impl() const override;
+
+    ////////////////////////////////////////////////////////////////////////
+    // CongruenceInterface - pure virtual member functions - private
+    ////////////////////////////////////////////////////////////////////////
+
+    word_type class_index_to_word_impl(class_index_type) override;
+    size_t    nr_classes_impl() override;
+    std::shared_ptr<FroidurePinBase> quotient_impl() override;
+    class_index_type word_to_class_index_impl(word_type const&) override;
+
+    ////////////////////////////////////////////////////////////////////////
+    // CongruenceInterface - non-pure virtual member functions - private
+    ////////////////////////////////////////////////////////////////////////
+
+    class_index_type const_word_to_class_index(word_type const&) const override;
+    std::shared_ptr<non_trivial_classes_type const>
+         non_trivial_classes_impl() override;
+    bool is_quotient_obviously_finite_impl() override;
+
+    ////////////////////////////////////////////////////////////////////////
+    // CayleyGraphCongruenceByPairs - member functions - private
+    ////////////////////////////////////////////////////////////////////////
+
+    void init();
+    void unite(element_index_type, element_index_type);
+
+    ////////////////////////////////////////////////////////////////////////
+    // CayleyGraphCongruenceByPairs - data - private
+    ////////////////////////////////////////////////////////////////////////
+
+    std::vector<class_index_type>   _class_lookup;
+    std::vector<element_index_type> _class_reps;
+    bool                            _init_done;
+    detail::UF                      _lookup;
+    std::vector<std::pair<element_index_type, element_index_type>>
+        _pairs_to_mult;
+  };
+
   template <typename TElementType  = Element const*,
             typename TElementHash  = Hash<TElementType>,
             typename TElementEqual = EqualTo<TElementType>>
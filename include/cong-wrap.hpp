@@ -26,6 +26,7 @@
 #include <cstddef>  // for size_t
 #include <memory>   // for unique_ptr, shared_ptr
 #include <string>   // for string
+#include <vector>   // for vector
 
 #include "cong-intf.hpp"          // for congruence_type, con...
 #include "fpsemi-intf.hpp"        // for FpSemigroupInterface
@@ -171,6 +172,11 @@ namespace libsemigroups {
           _wrapped_cong->word_to_class_index(w));
     }
 
+    // The following are required for overload resolution.
+    // Documented in FpSemigroupInterface
+    using FpSemigroupInterface::equal_to;
+    using FpSemigroupInterface::normal_form;
+
     ////////////////////////////////////////////////////////////////////////////
     // CongruenceWrapper - member functions - public
     ////////////////////////////////////////////////////////////////////////////
@@ -193,14 +199,31 @@ namespace libsemigroups {
       return *_wrapped_cong.get();
     }
 
+    //! Returns the memory used by the underlying congruence.
+    //!
+    //! \returns
+    //! A value of type \c size_t.
+    //!
+    //! \par Parameters
+    //! (None)
+    //!
+    //! \sa Runner::memory_used
+    size_t memory_used() const override {
+      return _wrapped_cong->memory_used();
+    }
+
    private:
     //////////////////////////////////////////////////////////////////////////
     // FpSemigroupInterface - pure virtual member functions - private
     //////////////////////////////////////////////////////////////////////////
 
     void run_impl() override {
+      _wrapped_cong->blackboard(blackboard());
       _wrapped_cong->run_until(
-          [this]() -> bool { return dead() || timed_out(); });
+          [this]() -> bool {
+            return dead() || timed_out() || over_memory_limit()
+                   || over_cpu_time_limit();
+          });
     }
 
     bool finished_impl() const override {
@@ -251,6 +274,29 @@ namespace libsemigroups {
       return _wrapped_cong->is_quotient_obviously_finite();
     }
 
+    // The normal forms are computed one at a time by default, since in
+    // general word_to_class_index may modify the wrapped congruence. This is
+    // specialised for congruence::ToddCoxeter in todd-coxeter.hpp.
+    std::vector<std::string>
+    normal_forms_impl(std::vector<std::string> const& words) override {
+      std::vector<std::string> result;
+      result.reserve(words.size());
+      for (auto const& w : words) {
+        result.push_back(normal_form(w));
+      }
+      return result;
+    }
+
+    std::vector<word_type>
+    normal_forms_impl(std::vector<word_type> const& words) override {
+      std::vector<word_type> result;
+      result.reserve(words.size());
+      for (auto const& w : words) {
+        result.push_back(normal_form(w));
+      }
+      return result;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     // CongruenceWrapper - data - private
     //////////////////////////////////////////////////////////////////////////
@@ -24,6 +24,8 @@
 
 #include <cstddef>  // for size_t
 #include <memory>   // for shared_ptr
+#include <string>   // for string
+#include <vector>   // for vector
 
 #include "cong-intf.hpp"     // for congruence::type
 #include "knuth-bendix.hpp"  // for KnuthBendix
@@ -178,6 +180,7 @@ namespace libsemigroups {
     // CongruenceInterface - non-pure virtual member functions - public
     //////////////////////////////////////////////////////////////////////////
 
+    using CongruenceInterface::contains;
     bool contains(word_type const&, word_type const&) override;
     tril const_contains(word_type const&, word_type const&) const override;
 
@@ -267,6 +270,50 @@ namespace libsemigroups {
       return todd_coxeter() != nullptr;
     }
 
+    //! Set whether or not the runners are started adaptively.
+    //!
+    //! If \p val is \c true, then when \c this is run, some cheap features
+    //! of the congruence are recorded (its kind, the number of generators,
+    //! the total length of the generating pairs and defining relations, the
+    //! size of the parent semigroup if it is known, and the runners used to
+    //! compute it), together with the runner that wins. If another adaptive
+    //! Congruence with the same features was run before, then only the
+    //! runners that won most often for those features are started at first,
+    //! and the others are only started one by one if none of the runners
+    //! already started has finished after a short time. This can
+    //! substantially reduce the CPU time used to compute many similar
+    //! congruences. If \p val is \c false (the default), then every runner
+    //! (up to the maximum number of threads) is started at once.
+    //!
+    //! \param val whether or not to start the runners adaptively.
+    //!
+    //! \returns A reference to \c this.
+    //!
+    //! \par Exceptions
+    //! This function is `noexcept` and is guaranteed never to throw.
+    //!
+    //! \par Complexity
+    //! Constant.
+    Congruence& adaptive(bool val) noexcept {
+      _adaptive = val;
+      return *this;
+    }
+
+    //! Returns whether or not the runners are started adaptively.
+    //!
+    //! \returns A `bool`.
+    //!
+    //! \par Exceptions
+    //! This function is `noexcept` and is guaranteed never to throw.
+    //!
+    //! \par Complexity
+    //! Constant.
+    //!
+    //! \sa adaptive(bool).
+    bool adaptive() const noexcept {
+      return _adaptive;
+    }
+
     // The next function is required by the GAP package Semigroups.
     //! No doc
     template <typename T>
@@ -286,10 +333,10 @@ namespace libsemigroups {
     size_t    nr_classes_impl() override;
     std::shared_ptr<FroidurePinBase> quotient_impl() override;
     class_index_type word_to_class_index_impl(word_type const&) override;
+    std::vector<class_index_type>
+    words_to_class_indices_impl(std::vector<word_type> const&) override;
 
-    void run_impl() override {
-      _race.run();
-    }
+    void run_impl() override;
 
     bool finished_impl() const override {
       return _race.finished();
@@ -302,14 +349,24 @@ namespace libsemigroups {
     void add_pair_impl(word_type const&, word_type const&) override;
     std::shared_ptr<CongruenceInterface::non_trivial_classes_type const>
          non_trivial_classes_impl() override;
+    std::vector<class_index_type>
+    parent_class_indices_impl(FroidurePinBase&) override;
     bool is_quotient_obviously_finite_impl() override;
     bool is_quotient_obviously_infinite_impl() override;
     void set_nr_generators_impl(size_t) override;
 
+    /////////////////////////////////////////////////////////////////////////
+    // Congruence - member functions - private
+    /////////////////////////////////////////////////////////////////////////
+
+    std::string features() const;
+
     /////////////////////////////////////////////////////////////////////////
     // Congruence - data - private
     /////////////////////////////////////////////////////////////////////////
+    bool         _adaptive;
     detail::Race _race;
+    size_t       _relations_length;
   };
 }  // namespace libsemigroups
 
@@ -19,10 +19,11 @@
 #ifndef LIBSEMIGROUPS_INCLUDE_CONTAINERS_HPP_
 #define LIBSEMIGROUPS_INCLUDE_CONTAINERS_HPP_
 
-#include <array>     // for array
-#include <cstddef>   // for size_t
-#include <iterator>  // for reverse_iterator
-#include <vector>    // for vector, allocator
+#include <algorithm>  // for fill, max, move
+#include <array>      // for array
+#include <cstddef>    // for size_t
+#include <iterator>   // for reverse_iterator
+#include <vector>     // for vector, allocator
 
 #include "iterator.hpp"             // for ConstIteratorStateful, ConstItera...
 #include "libsemigroups-debug.hpp"  // for LIBSEMIGROUPS_ASSERT
@@ -248,6 +249,13 @@ namespace libsemigroups {
             old_it -= old_nr_cols;
             new_it -= new_nr_cols;
           }
+          // The values moved out of a row remain in the unused columns of
+          // the new row, and so these are reset.
+          for (size_t i = 0; i < _nr_rows; ++i) {
+            std::fill(_vec.begin() + i * new_nr_cols + _nr_used_cols,
+                      _vec.begin() + (i + 1) * new_nr_cols,
+                      _default_val);
+          }
         }
         _nr_used_cols += nr;
         _nr_unused_cols = new_nr_cols - _nr_used_cols;
@@ -645,6 +653,12 @@ namespace libsemigroups {
         _sizes.fill(0);
       }
 
+      // Not noexcept because std::array::operator[] isn't
+      void clear(size_t depth) {
+        LIBSEMIGROUPS_ASSERT(depth < N);
+        _sizes[depth] = 0;
+      }
+
       // Not noexcept because std::array::operator[] isn't
       void push_back(size_t depth, T x) {
         LIBSEMIGROUPS_ASSERT(depth < N);
@@ -732,6 +746,12 @@ namespace libsemigroups {
         return _arrays[depth];
       }
 
+      // Not noexcept because std::array::operator[] isn't
+      inline std::array<T, N> const& operator[](size_t depth) const {
+        LIBSEMIGROUPS_ASSERT(depth < N);
+        return _arrays[depth];
+      }
+
       // Not noexcept because std::array::at can throw
       inline T const& at(size_t depth, size_t index) const {
         return _arrays.at(depth).at(index);
@@ -29,18 +29,26 @@
 #include <cstddef>  // for size_t
 
 #include <algorithm>    // for uniform_int_distribution
+#include <atomic>       // for atomic
+#include <cstdint>      // for uint64_t
+#include <iterator>     // for forward_iterator_tag
+#include <memory>       // for shared_ptr, make_shared
+#include <numeric>      // for iota
 #include <queue>        // for queue
 #include <random>       // for mt19937
 #include <stack>        // for stack
 #include <type_traits>  // for is_integral, is_unsigned
 #include <vector>       // for vector
 
+#include "constants.hpp"                // for POSITIVE_INFINITY, UNDEFINED
 #include "containers.hpp"               // for DynamicArray2
 #include "forest.hpp"                   // for Forest
 #include "int-range.hpp"                // for IntegralRange
 #include "iterator.hpp"                 // for ConstIteratorStateless
 #include "libsemigroups-debug.hpp"      // for LIBSEMIGROUPS_ASSERT
 #include "libsemigroups-exception.hpp"  // for LIBSEMIGROUPS_EXCEPTION
+#include "parallel.hpp"                 // for detail::parallel_for
+#include "types.hpp"                    // for word_type
 
 namespace libsemigroups {
 
@@ -53,6 +61,15 @@ namespace libsemigroups {
   //! number \c m is referred to as the *out-degree* of the digraph, or any of
   //! its nodes.
   //!
+  //! The strongly connected components and spanning forests of a digraph
+  //! are computed when they are first required, and are then stored. If
+  //! the only changes to the digraph since they were computed are the
+  //! addition of new nodes, and of edges whose source is one of the new
+  //! nodes, as happens when an Action is extended by adding seeds, then no
+  //! existing component can change, and only the components of the new nodes
+  //! are computed. Any other change (such as add_to_out_degree, or
+  //! add_edge with source an existing node) means that everything is
+  //! computed again from scratch.
   //!
   //! \tparam T the type of the nodes in the digraph, must be an unsigned
   //! integer type.
@@ -153,8 +170,12 @@ namespace libsemigroups {
     // Not noexcept
     explicit ActionDigraph(T m = 0, T n = 0)
         : _degree(n),
+          _max_threads(1),
+          _nr_edges(0),
           _nr_nodes(m),
           _dynamic_array_2(_degree, _nr_nodes, UNDEFINED),
+          _in_edges(),
+          _out_edges(),
           _scc_back_forest(),
           _scc_forest(),
           _scc() {}
@@ -194,6 +215,7 @@ namespace libsemigroups {
       std::generate(g._dynamic_array_2.begin(),
                     g._dynamic_array_2.end(),
                     [&dist, &mt]() { return dist(mt); });
+      g._nr_edges = size_t(m) * n;
       return g;
     }
 
@@ -224,7 +246,7 @@ namespace libsemigroups {
                                   - (_dynamic_array_2.nr_rows() - _nr_nodes));
       }
       _nr_nodes += nr;
-      reset();
+      reset_appended();
     }
 
     //! Adds \p nr to the out-degree of \c this.
@@ -246,6 +268,9 @@ namespace libsemigroups {
     //! \iterator_invalid
     // Not noexcept because DynamicArray2::add_cols isn't.
     void inline add_to_out_degree(size_t nr) {
+      if (nr == 0) {
+        return;
+      }
       if (nr > _dynamic_array_2.nr_cols() - _degree) {
         _dynamic_array_2.add_cols(nr - (_dynamic_array_2.nr_cols() - _degree));
       }
@@ -276,8 +301,15 @@ namespace libsemigroups {
       validate_node(i);
       validate_node(j);
       validate_label(lbl);
+      if (_dynamic_array_2.get(i, lbl) == UNDEFINED) {
+        _nr_edges++;
+      }
       _dynamic_array_2.set(i, lbl, j);
-      reset();
+      if (i < _scc._nr_nodes) {
+        reset();
+      } else {
+        reset_appended();
+      }
     }
 
     //! Ensures that \c this has capacity for \p m nodes each with \p
@@ -305,6 +337,60 @@ namespace libsemigroups {
       _dynamic_array_2.add_rows(m - _dynamic_array_2.nr_rows());
     }
 
+    ////////////////////////////////////////////////////////////////////////
+    // ActionDigraph - settings - public
+    ////////////////////////////////////////////////////////////////////////
+
+    //! Set the maximum number of threads used to compute the strongly
+    //! connected components and the spanning forests.
+    //!
+    //! If \p nr_threads is greater than \c 1, then the strongly connected
+    //! components are found using a parallel colouring algorithm, rather
+    //! than Gabow's algorithm, and the spanning forests are found using a
+    //! parallel breadth-first search, which processes the nodes at the same
+    //! distance from the roots at the same time. In this case, the strongly
+    //! connected components are ordered by their least nodes, the root of
+    //! every component is its least node, and the nodes in every component
+    //! are sorted. Otherwise the order of the components and of the nodes in
+    //! every component is that found by Gabow's algorithm. The spanning
+    //! forests are the same in both cases, given the same roots.
+    //!
+    //! The default value is \c 1. Changing this value does not change any
+    //! components or forests that were already computed.
+    //!
+    //! \param nr_threads the maximum number of threads to use, a value of \c
+    //! 0 is treated as \c 1.
+    //!
+    //! \returns A reference to \c this.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    ActionDigraph& max_threads(size_t nr_threads) noexcept {
+      _max_threads = (nr_threads == 0 ? 1 : nr_threads);
+      return *this;
+    }
+
+    //! Returns the maximum number of threads used to compute the strongly
+    //! connected components and the spanning forests.
+    //!
+    //! \returns
+    //! A `size_t`.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    //!
+    //! \par Parameters
+    //! (None)
+    size_t max_threads() const noexcept {
+      return _max_threads;
+    }
+
     ////////////////////////////////////////////////////////////////////////
     // ActionDigraph - nodes, neighbors, etc - public
     ////////////////////////////////////////////////////////////////////////
@@ -354,18 +440,15 @@ namespace libsemigroups {
     //! The total number of edges, a value of type \c size_t.
     //!
     //! \exceptions
-    //! \no_libsemigroups_except
+    //! \noexcept
     //!
     //! \complexity
-    //! \f$O(mn)\f$ where \c m is nr_nodes() and \c n is out_degree().
+    //! Constant.
     //!
     //! \par Parameters
     //! (None)
-    // Not noexcept because std::count isn't
-    size_t nr_edges() const {
-      return _dynamic_array_2.nr_rows() * _dynamic_array_2.nr_cols()
-             - std::count(
-                 _dynamic_array_2.cbegin(), _dynamic_array_2.cend(), UNDEFINED);
+    size_t nr_edges() const noexcept {
+      return _nr_edges;
     }
 
     //! Returns the out-degree of \c this.
@@ -394,7 +477,7 @@ namespace libsemigroups {
     //! \noexcept
     //!
     //! \complexity
-    //! \f$O(mn)\f$ where \c m is nr_nodes() and \c n is out_degree().
+    //! Constant.
     //!
     //! \par Parameters
     //! (None)
@@ -710,28 +793,33 @@ namespace libsemigroups {
         // Validity checked in gabow_scc
         gabow_scc();
 
-        std::vector<bool> seen(nr_nodes(), false);
+        // Only the trees of the components found since the forest was last
+        // computed are added, see reset_appended.
+        T const first = init_forest(_scc_forest._forest, _scc_forest._nr_sccs);
+        if (_max_threads > 1) {
+          parallel_spanning_forest(first);
+          return _scc_forest._forest;
+        }
+        std::vector<bool> seen(nr_nodes() - first, false);
         std::queue<T>     queue;
 
-        _scc_forest._forest.clear();
-        _scc_forest._forest.add_nodes(nr_nodes());
-
-        for (size_t i = 0; i < nr_scc(); ++i) {
+        for (size_t i = _scc_forest._nr_sccs; i < nr_scc(); ++i) {
           queue.push(_scc._comps[i][0]);
-          seen[_scc._comps[i][0]] = true;
+          seen[_scc._comps[i][0] - first] = true;
           do {
             size_t x = queue.front();
             for (size_t j = 0; j < _degree; ++j) {
               size_t y = _dynamic_array_2.get(x, j);
-              if (!seen[y] && _scc._id[y] == _scc._id[x]) {
+              if (_scc._id[y] == _scc._id[x] && !seen[y - first]) {
                 _scc_forest._forest.set(y, x, j);
                 queue.push(y);
-                seen[y] = true;
+                seen[y - first] = true;
               }
             }
             queue.pop();
           } while (!queue.empty());
         }
+        _scc_forest._nr_sccs = nr_scc();
         _scc_forest._defined = true;
       }
       return _scc_forest._forest;
@@ -759,49 +847,909 @@ namespace libsemigroups {
         // Validity checked in gabow_scc
         gabow_scc();
 
-        _scc_back_forest._forest.clear();
-        _scc_back_forest._forest.add_nodes(nr_nodes());
-
-        std::vector<std::vector<T>> reverse_edges(nr_nodes(), std::vector<T>());
-        std::vector<std::vector<T>> reverse_labels(nr_nodes(),
+        // Only the trees of the components found since the forest was last
+        // computed are added, see reset_appended. The nodes in these
+        // components are all at least first, and so the reverse edges and
+        // seen are indexed by the node minus first.
+        T const first
+            = init_forest(_scc_back_forest._forest, _scc_back_forest._nr_sccs);
+        if (_max_threads > 1) {
+          parallel_reverse_spanning_forest(first);
+          return _scc_back_forest._forest;
+        }
+        std::vector<std::vector<T>> reverse_edges(nr_nodes() - first,
+                                                  std::vector<T>());
+        std::vector<std::vector<T>> reverse_labels(nr_nodes() - first,
                                                    std::vector<T>());
 
-        for (size_t i = 0; i < nr_nodes(); ++i) {
-          size_t const scc_id_i = scc_id(i);
+        for (size_t i = first; i < nr_nodes(); ++i) {
+          size_t const scc_id_i = _scc._id[i];
           for (size_t j = 0; j < out_degree(); ++j) {
             size_t const k = _dynamic_array_2.get(i, j);
-            if (scc_id(k) == scc_id_i) {
-              reverse_edges[k].push_back(i);
-              reverse_labels[k].push_back(j);
+            if (_scc._id[k] == scc_id_i) {
+              reverse_edges[k - first].push_back(i);
+              reverse_labels[k - first].push_back(j);
             }
           }
         }
         std::queue<size_t> queue;
-        std::vector<bool>  seen(nr_nodes(), false);
+        std::vector<bool>  seen(nr_nodes() - first, false);
 
-        for (size_t i = 0; i < nr_scc(); ++i) {
+        for (size_t i = _scc_back_forest._nr_sccs; i < nr_scc(); ++i) {
           LIBSEMIGROUPS_ASSERT(queue.empty());
           queue.push(_scc._comps[i][0]);
-          seen[_scc._comps[i][0]] = true;
+          seen[_scc._comps[i][0] - first] = true;
           while (!queue.empty()) {
             size_t x = queue.front();
-            for (size_t j = 0; j < reverse_edges[x].size(); ++j) {
-              size_t y = reverse_edges[x][j];
-              if (!seen[y]) {
+            for (size_t j = 0; j < reverse_edges[x - first].size(); ++j) {
+              size_t y = reverse_edges[x - first][j];
+              if (!seen[y - first]) {
                 queue.push(y);
-                seen[y] = true;
-                _scc_back_forest._forest.set(y, x, reverse_labels[x][j]);
+                seen[y - first] = true;
+                _scc_back_forest._forest.set(
+                    y, x, reverse_labels[x - first][j]);
               }
             }
             queue.pop();
           }
         }
+        _scc_back_forest._nr_sccs = nr_scc();
         _scc_back_forest._defined = true;
       }
       return _scc_back_forest._forest;
     }
 
+    ////////////////////////////////////////////////////////////////////////
+    // ActionDigraph - compressed edges - public
+    ////////////////////////////////////////////////////////////////////////
+
+    //! Defined in ``digraph.hpp``.
+    //!
+    //! This is the type of an immutable view of the edges of an
+    //! ActionDigraph in compressed sparse row form. The edges incident to
+    //! every node are stored contiguously, and the undefined edges are not
+    //! stored at all, and so an ActionDigraph with few edges, or many nodes
+    //! with no edges, uses less memory in this form. Every edge is
+    //! represented by its label, and the node at the other end of the edge.
+    //!
+    //! \sa compressed_out_edges and compressed_in_edges.
+    class CompressedEdges final {
+     public:
+      //! The type of an iterator pointing to the nodes or labels of the edges
+      //! incident to a node.
+      using const_iterator = typename std::vector<T>::const_iterator;
+
+      //! Constructs a CompressedEdges with no nodes and no edges.
+      CompressedEdges() : _labels(), _nodes(), _offsets(1, 0) {}
+
+      //! Default copy constructor.
+      CompressedEdges(CompressedEdges const&) = default;
+
+      //! Default move constructor.
+      CompressedEdges(CompressedEdges&&) = default;
+
+      //! Default copy assignment operator.
+      CompressedEdges& operator=(CompressedEdges const&) = default;
+
+      //! Default move assignment operator.
+      CompressedEdges& operator=(CompressedEdges&&) = default;
+
+      ~CompressedEdges() = default;
+
+      //! Returns the number of nodes.
+      //!
+      //! \exceptions
+      //! \noexcept
+      //!
+      //! \complexity
+      //! Constant.
+      size_t nr_nodes() const noexcept {
+        return _offsets.size() - 1;
+      }
+
+      //! Returns the number of edges.
+      //!
+      //! \exceptions
+      //! \noexcept
+      //!
+      //! \complexity
+      //! Constant.
+      size_t nr_edges() const noexcept {
+        return _nodes.size();
+      }
+
+      //! Returns the number of edges incident to the node \p v.
+      //!
+      //! \param v a node.
+      //!
+      //! \throws LibsemigroupsException if \p v is not valid.
+      //!
+      //! \complexity
+      //! Constant.
+      size_t degree(node_type v) const {
+        validate_node(v);
+        return _offsets[v + 1] - _offsets[v];
+      }
+
+      //! Returns an iterator pointing to the node at the other end of the
+      //! first edge incident to the node \p v.
+      //!
+      //! \param v a node.
+      //!
+      //! \throws LibsemigroupsException if \p v is not valid.
+      //!
+      //! \complexity
+      //! Constant.
+      const_iterator cbegin_nodes(node_type v) const {
+        validate_node(v);
+        return _nodes.cbegin() + _offsets[v];
+      }
+
+      //! Returns an iterator pointing one past the node at the other end of
+      //! the last edge incident to the node \p v.
+      //!
+      //! \param v a node.
+      //!
+      //! \throws LibsemigroupsException if \p v is not valid.
+      //!
+      //! \complexity
+      //! Constant.
+      const_iterator cend_nodes(node_type v) const {
+        validate_node(v);
+        return _nodes.cbegin() + _offsets[v + 1];
+      }
+
+      //! Returns an iterator pointing to the label of the first edge incident
+      //! to the node \p v.
+      //!
+      //! \param v a node.
+      //!
+      //! \throws LibsemigroupsException if \p v is not valid.
+      //!
+      //! \complexity
+      //! Constant.
+      const_iterator cbegin_labels(node_type v) const {
+        validate_node(v);
+        return _labels.cbegin() + _offsets[v];
+      }
+
+      //! Returns an iterator pointing one past the label of the last edge
+      //! incident to the node \p v.
+      //!
+      //! \param v a node.
+      //!
+      //! \throws LibsemigroupsException if \p v is not valid.
+      //!
+      //! \complexity
+      //! Constant.
+      const_iterator cend_labels(node_type v) const {
+        validate_node(v);
+        return _labels.cbegin() + _offsets[v + 1];
+      }
+
+     private:
+      friend class ActionDigraph;
+
+      void validate_node(node_type v) const {
+        if (v >= nr_nodes()) {
+          LIBSEMIGROUPS_EXCEPTION("node value out of bounds, expected value "
+                                  "in the range [0, %d), got %d",
+                                  nr_nodes(),
+                                  v);
+        }
+      }
+
+      // The edges incident to the node v are in the positions _offsets[v],
+      // ..., _offsets[v + 1] - 1 of _labels and _nodes.
+      std::vector<T>      _labels;
+      std::vector<T>      _nodes;
+      std::vector<size_t> _offsets;
+    };
+
+    //! Returns the out-edges of \c this in compressed sparse row form.
+    //!
+    //! The nodes in ActionDigraph::CompressedEdges::cbegin_nodes(v) are the
+    //! ranges of the edges with source \c v, in increasing order of their
+    //! labels.
+    //!
+    //! \returns
+    //! A const reference to an ActionDigraph::CompressedEdges.
+    //!
+    //! \exceptions
+    //! \no_libsemigroups_except
+    //!
+    //! \complexity
+    //! \f$O(mn)\f$ where \c m is nr_nodes() and \c n is out_degree(), the
+    //! first time this is called after \c this is modified, and constant
+    //! otherwise.
+    //!
+    //! \par Parameters
+    //! (None)
+    CompressedEdges const& compressed_out_edges() const {
+      if (!_out_edges._defined) {
+        CompressedEdges& c = _out_edges._edges;
+        c._offsets.assign(1, 0);
+        c._labels.clear();
+        c._nodes.clear();
+        c._labels.reserve(nr_edges());
+        c._nodes.reserve(nr_edges());
+        for (node_type v = 0; v < nr_nodes(); ++v) {
+          for (label_type a = 0; a < _degree; ++a) {
+            node_type const u = _dynamic_array_2.get(v, a);
+            if (u != UNDEFINED) {
+              c._labels.push_back(a);
+              c._nodes.push_back(u);
+            }
+          }
+          c._offsets.push_back(c._nodes.size());
+        }
+        _out_edges._defined = true;
+      }
+      return _out_edges._edges;
+    }
+
+    //! Returns the in-edges of \c this in compressed sparse row form.
+    //!
+    //! The nodes in ActionDigraph::CompressedEdges::cbegin_nodes(v) are the
+    //! sources of the edges with range \c v, in increasing order, and the
+    //! edges with the same source are in increasing order of their labels.
+    //!
+    //! \returns
+    //! A const reference to an ActionDigraph::CompressedEdges.
+    //!
+    //! \exceptions
+    //! \no_libsemigroups_except
+    //!
+    //! \complexity
+    //! \f$O(mn)\f$ where \c m is nr_nodes() and \c n is out_degree(), the
+    //! first time this is called after \c this is modified, and constant
+    //! otherwise.
+    //!
+    //! \par Parameters
+    //! (None)
+    CompressedEdges const& compressed_in_edges() const {
+      if (!_in_edges._defined) {
+        CompressedEdges& c = _in_edges._edges;
+        reverse_edges(0, false, c._offsets, c._nodes, c._labels);
+        _in_edges._defined = true;
+      }
+      return _in_edges._edges;
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    // ActionDigraph - subdigraphs and quotients - public
+    ////////////////////////////////////////////////////////////////////////
+
+    //! Returns the subdigraph induced by the nodes in the range [\p first,
+    //! \p last).
+    //!
+    //! The i-th node in the range is the node \c i of the returned
+    //! ActionDigraph, which has the same out-degree as \c this, and an edge
+    //! from \c i to \c j labelled \c a if and only if \c this has an edge
+    //! labelled \c a between the corresponding nodes. The edges of \c this
+    //! with range outside the given nodes are undefined in the returned
+    //! ActionDigraph. For example, the subdigraph induced by the \c i-th
+    //! strongly connected component is
+    //! `induced_subdigraph(cbegin_scc(i), cend_scc(i))`.
+    //!
+    //! \tparam TIterator a forward iterator type whose values are nodes.
+    //!
+    //! \param first iterator pointing to the first node.
+    //! \param last iterator pointing one past the last node.
+    //!
+    //! \returns
+    //! An ActionDigraph.
+    //!
+    //! \throws LibsemigroupsException if any node in the range is not valid,
+    //! or occurs more than once.
+    //!
+    //! \complexity
+    //! \f$O(m + kn)\f$ where \c m is nr_nodes(), \c k is the number of nodes
+    //! in the range, and \c n is out_degree().
+    template <typename TIterator>
+    ActionDigraph induced_subdigraph(TIterator first, TIterator last) const {
+      std::vector<T> pos(nr_nodes(), T(UNDEFINED));
+      T              m = 0;
+      for (auto it = first; it != last; ++it) {
+        validate_node(*it);
+        if (pos[*it] != UNDEFINED) {
+          LIBSEMIGROUPS_EXCEPTION("node %d occurs more than once", *it);
+        }
+        pos[*it] = m++;
+      }
+      ActionDigraph result(m, _degree);
+      T             v = 0;
+      for (auto it = first; it != last; ++it, ++v) {
+        for (label_type a = 0; a < _degree; ++a) {
+          node_type const u = _dynamic_array_2.get(*it, a);
+          if (u != UNDEFINED && pos[u] != UNDEFINED) {
+            result._dynamic_array_2.set(v, a, pos[u]);
+            result._nr_edges++;
+          }
+        }
+      }
+      return result;
+    }
+
+    //! Returns the quotient of \c this by a partition of its nodes.
+    //!
+    //! The partition is given by \p part, which has one entry for every node
+    //! of \c this, the index of the class of the partition containing the
+    //! node. The nodes of the returned ActionDigraph are the indices of the
+    //! classes, and there is an edge labelled \c a from \c x to \c y if and
+    //! only if \c this has an edge labelled \c a from a node in class \c x to
+    //! a node in class \c y. This must define at most one edge with every
+    //! source and label, i.e. the partition must be compatible with the
+    //! edges of \c this.
+    //!
+    //! \param part the indices of the classes of the nodes.
+    //!
+    //! \returns
+    //! An ActionDigraph with `max(part) + 1` nodes, and the same out-degree as
+    //! \c this.
+    //!
+    //! \throws LibsemigroupsException if the length of \p part is not
+    //! nr_nodes(), if any entry of \p part is UNDEFINED, or if the partition
+    //! is not compatible with the edges of \c this.
+    //!
+    //! \complexity
+    //! \f$O(mn)\f$ where \c m is nr_nodes() and \c n is out_degree().
+    ActionDigraph quotient(std::vector<node_type> const& part) const {
+      if (part.size() != nr_nodes()) {
+        LIBSEMIGROUPS_EXCEPTION("expected a vector of length %d, got %d",
+                                nr_nodes(),
+                                part.size());
+      }
+      T m = 0;
+      for (node_type x : part) {
+        if (x == UNDEFINED) {
+          LIBSEMIGROUPS_EXCEPTION("the class indices must not be UNDEFINED");
+        }
+        m = std::max(m, T(x + 1));
+      }
+      ActionDigraph result(m, _degree);
+      for (node_type v = 0; v < nr_nodes(); ++v) {
+        for (label_type a = 0; a < _degree; ++a) {
+          node_type const u = _dynamic_array_2.get(v, a);
+          if (u == UNDEFINED) {
+            continue;
+          }
+          node_type const y = result._dynamic_array_2.get(part[v], a);
+          if (y == UNDEFINED) {
+            result._dynamic_array_2.set(part[v], a, part[u]);
+            result._nr_edges++;
+          } else if (y != part[u]) {
+            LIBSEMIGROUPS_EXCEPTION("the partition is not compatible with the "
+                                    "edges, the edges labelled %d with source "
+                                    "in class %d have ranges in classes %d "
+                                    "and %d",
+                                    a,
+                                    part[v],
+                                    y,
+                                    part[u]);
+          }
+        }
+      }
+      return result;
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    // ActionDigraph - paths - public
+    ////////////////////////////////////////////////////////////////////////
+
+    //! Defined in ``digraph.hpp``.
+    //!
+    //! This is the type of a forward iterator pointing to the words labelling
+    //! the paths in an ActionDigraph with a given source (and, optionally, a
+    //! given target), whose lengths are in a given range, in short-lex
+    //! order. The paths are found one at a time by a depth-first search,
+    //! which only enters nodes from which the target can be reached using
+    //! the required number of edges, and the word labelling the current path
+    //! is stored in the iterator, and so no memory is allocated for each
+    //! path.
+    //!
+    //! An iterator of this type is only valid while the ActionDigraph it
+    //! points into is not modified.
+    //!
+    //! \sa cbegin_pislo and cbegin_pstislo.
+    class const_iterator_pstislo final {
+     public:
+      //! The type of the difference of two iterators.
+      using difference_type = std::ptrdiff_t;
+      //! The type of the words pointed to.
+      using value_type = word_type;
+      //! The type of a const reference to a word.
+      using reference = word_type const&;
+      //! The type of a const pointer to a word.
+      using pointer = word_type const*;
+      //! The iterator category.
+      using iterator_category = std::forward_iterator_tag;
+
+      //! Constructs an iterator equal to every end iterator.
+      const_iterator_pstislo()
+          : _digraph(nullptr),
+            _length(UNDEFINED),
+            _max(0),
+            _nodes(),
+            _reach(),
+            _target(UNDEFINED),
+            _word() {}
+
+      //! Default copy constructor.
+      const_iterator_pstislo(const_iterator_pstislo const&) = default;
+
+      //! Default move constructor.
+      const_iterator_pstislo(const_iterator_pstislo&&) = default;
+
+      //! Default copy assignment operator.
+      const_iterator_pstislo& operator=(const_iterator_pstislo const&)
+          = default;
+
+      //! Default move assignment operator.
+      const_iterator_pstislo& operator=(const_iterator_pstislo&&) = default;
+
+      ~const_iterator_pstislo() = default;
+
+      //! Returns \c true if \c this and \p that point to the same word, or
+      //! are both end iterators.
+      bool operator==(const_iterator_pstislo const& that) const noexcept {
+        return _length == that._length && _word == that._word;
+      }
+
+      //! Returns \c true if \c this and \p that are not equal.
+      bool operator!=(const_iterator_pstislo const& that) const noexcept {
+        return !(*this == that);
+      }
+
+      //! Returns a const reference to the word labelling the current path.
+      reference operator*() const noexcept {
+        return _word;
+      }
+
+      //! Returns a const pointer to the word labelling the current path.
+      pointer operator->() const noexcept {
+        return &_word;
+      }
+
+      //! Advances the iterator to the next path.
+      const_iterator_pstislo& operator++() {
+        if (_word.empty()) {
+          next_length();
+        } else {
+          label_type const a = _word.back() + 1;
+          _word.pop_back();
+          _nodes.pop_back();
+          search(a);
+        }
+        return *this;
+      }
+
+      //! Advances the iterator to the next path.
+      const_iterator_pstislo operator++(int) {
+        const_iterator_pstislo copy(*this);
+        ++(*this);
+        return copy;
+      }
+
+     private:
+      friend class ActionDigraph;
+
+      const_iterator_pstislo(ActionDigraph const* digraph,
+                             node_type            source,
+                             node_type            target,
+                             size_t               min,
+                             size_t               max)
+          : _digraph(digraph),
+            _length(min),
+            _max(std::min(max, digraph->max_path_length(source, target))),
+            _nodes({source}),
+            _reach(std::make_shared<std::vector<bool>>()),
+            _target(target),
+            _word() {
+        if (_length >= _max) {
+          end();
+        } else if (!reaches(_length, source)) {
+          next_length();
+        } else {
+          search(0);
+        }
+      }
+
+      void end() noexcept {
+        _length = UNDEFINED;
+        _nodes.clear();
+        _word.clear();
+      }
+
+      // Starts the search for the paths of the next length for which there
+      // is a path.
+      void next_length() {
+        LIBSEMIGROUPS_ASSERT(_word.empty() && _nodes.size() == 1);
+        do {
+          if (++_length >= _max) {
+            end();
+            return;
+          }
+        } while (!reaches(_length, _nodes[0]));
+        search(0);
+      }
+
+      // Finds the next path of length _length, whose first _word.size()
+      // edges are those in _word, and whose next edge has label at least a.
+      void search(label_type a) {
+        T const n = _digraph->out_degree();
+        while (_word.size() != _length) {
+          node_type const v = _nodes.back();
+          node_type       u = UNDEFINED;
+          for (; a < n; ++a) {
+            u = _digraph->_dynamic_array_2.get(v, a);
+            if (u != UNDEFINED && reaches(_length - _word.size() - 1, u)) {
+              break;
+            }
+          }
+          if (a < n) {
+            _word.push_back(a);
+            _nodes.push_back(u);
+            a = 0;
+          } else if (_word.empty()) {
+            next_length();
+            return;
+          } else {
+            a = _word.back() + 1;
+            _word.pop_back();
+            _nodes.pop_back();
+          }
+        }
+      }
+
+      // Returns true if there is a path of length r from v to the target.
+      // The values for every node and every length up to r are computed
+      // when they are first required.
+      bool reaches(size_t r, node_type v) {
+        T const            n     = _digraph->nr_nodes();
+        std::vector<bool>& reach = *_reach;
+        while (reach.size() <= r * n + v) {
+          size_t const s = reach.size() / n;
+          for (node_type x = 0; x < n; ++x) {
+            if (s == 0) {
+              reach.push_back(_target == UNDEFINED || x == _target);
+              continue;
+            }
+            bool found = false;
+            for (label_type a = 0; a < _digraph->out_degree() && !found;
+                 ++a) {
+              node_type const y = _digraph->_dynamic_array_2.get(x, a);
+              found = (y != UNDEFINED && reach[(s - 1) * n + y]);
+            }
+            reach.push_back(found);
+          }
+        }
+        return reach[r * n + v];
+      }
+
+      ActionDigraph const*               _digraph;
+      size_t                             _length;
+      size_t                             _max;
+      std::vector<node_type>             _nodes;
+      std::shared_ptr<std::vector<bool>> _reach;
+      node_type                          _target;
+      word_type                          _word;
+    };
+
+    //! Returns an iterator pointing to the word labelling the first path,
+    //! in short-lex order, with source \p source, and length in the range
+    //! \f$[min, max)\f$.
+    //!
+    //! \param source the first node of the paths.
+    //! \param min the minimum length of a path (default: 0).
+    //! \param max one more than the maximum length of a path (default:
+    //! libsemigroups::POSITIVE_INFINITY).
+    //!
+    //! \returns
+    //! A ActionDigraph::const_iterator_pstislo.
+    //!
+    //! \throws LibsemigroupsException if \p source is not a node.
+    //!
+    //! \complexity
+    //! At most \f$O(mn)\f$ where \c m is nr_nodes() and \c n is out_degree(),
+    //! and then \f$O(mnk)\f$ to find the paths of length \c k, in addition
+    //! to the time it takes to find the paths themselves.
+    const_iterator_pstislo cbegin_pislo(node_type source,
+                                        size_t    min = 0,
+                                        size_t    max
+                                        = POSITIVE_INFINITY) const {
+      return cbegin_pstislo(source, UNDEFINED, min, max);
+    }
+
+    //! Returns an iterator pointing one past the last path returned by
+    //! cbegin_pislo().
+    //!
+    //! \returns
+    //! A ActionDigraph::const_iterator_pstislo.
+    //!
+    //! \exceptions
+    //! \no_libsemigroups_except
+    //!
+    //! \par Parameters
+    //! (None)
+    const_iterator_pstislo cend_pislo() const {
+      return const_iterator_pstislo();
+    }
+
+    //! Returns an iterator pointing to the word labelling the first path,
+    //! in short-lex order, with source \p source, target \p target, and
+    //! length in the range \f$[min, max)\f$.
+    //!
+    //! \param source the first node of the paths.
+    //! \param target the last node of the paths, or libsemigroups::UNDEFINED
+    //! for paths with any last node.
+    //! \param min the minimum length of a path (default: 0).
+    //! \param max one more than the maximum length of a path (default:
+    //! libsemigroups::POSITIVE_INFINITY).
+    //!
+    //! \returns
+    //! A ActionDigraph::const_iterator_pstislo.
+    //!
+    //! \throws LibsemigroupsException if \p source or \p target is not a
+    //! node.
+    //!
+    //! \complexity
+    //! At most \f$O(mn)\f$ where \c m is nr_nodes() and \c n is out_degree(),
+    //! and then \f$O(mnk)\f$ to find the paths of length \c k, in addition
+    //! to the time it takes to find the paths themselves.
+    const_iterator_pstislo cbegin_pstislo(node_type source,
+                                          node_type target,
+                                          size_t    min = 0,
+                                          size_t    max
+                                          = POSITIVE_INFINITY) const {
+      validate_node(source);
+      if (target != UNDEFINED) {
+        validate_node(target);
+      }
+      return const_iterator_pstislo(this, source, target, min, max);
+    }
+
+    //! Returns an iterator pointing one past the last path returned by
+    //! cbegin_pstislo().
+    //!
+    //! \returns
+    //! A ActionDigraph::const_iterator_pstislo.
+    //!
+    //! \exceptions
+    //! \no_libsemigroups_except
+    //!
+    //! \par Parameters
+    //! (None)
+    const_iterator_pstislo cend_pstislo() const {
+      return const_iterator_pstislo();
+    }
+
+    //! Returns the number of paths of every length less than \p max with
+    //! source \p source and target \p target.
+    //!
+    //! The value in position \c k of the returned vector is the number of
+    //! paths of length \c k, modulo \p modulus if \p modulus is not \c 0.
+    //! The numbers are found by dynamic programming: the number of paths of
+    //! length \c k + 1 from \p source to every node is found from the numbers
+    //! of paths of length \c k.
+    //!
+    //! \param source the first node of the paths.
+    //! \param target the last node of the paths, or libsemigroups::UNDEFINED
+    //! for paths with any last node.
+    //! \param max one more than the maximum length of a path.
+    //! \param modulus the modulus, or \c 0 for the exact numbers of paths
+    //! (default: \c 0).
+    //!
+    //! \returns
+    //! A `std::vector<uint64_t>`.
+    //!
+    //! \throws LibsemigroupsException if \p source or \p target is not a
+    //! node, if \p max is libsemigroups::POSITIVE_INFINITY, or if \p modulus
+    //! is \c 0 and the number of paths of some length is at least \f$2 ^
+    //! {64}\f$.
+    //!
+    //! \complexity
+    //! \f$O(mnk)\f$ where \c m is nr_nodes(), \c n is out_degree(), and \c k
+    //! is \p max.
+    std::vector<uint64_t> number_of_paths_by_length(node_type source,
+                                                    node_type target,
+                                                    size_t    max,
+                                                    uint64_t  modulus
+                                                    = 0) const {
+      validate_node(source);
+      if (target != UNDEFINED) {
+        validate_node(target);
+      }
+      if (max == POSITIVE_INFINITY) {
+        LIBSEMIGROUPS_EXCEPTION("the maximum length must not be infinite");
+      }
+      std::vector<uint64_t> result;
+      result.reserve(max);
+      std::vector<uint64_t> current(nr_nodes(), 0), next(nr_nodes(), 0);
+      current[source] = (modulus == 1 ? 0 : 1);
+      for (size_t k = 0; k < max; ++k) {
+        if (target != UNDEFINED) {
+          result.push_back(current[target]);
+        } else {
+          uint64_t total = 0;
+          for (uint64_t x : current) {
+            total = add_paths(total, x, modulus);
+          }
+          result.push_back(total);
+        }
+        if (k + 1 == max) {
+          break;
+        }
+        std::fill(next.begin(), next.end(), 0);
+        for (node_type v = 0; v < nr_nodes(); ++v) {
+          if (current[v] != 0) {
+            for (label_type a = 0; a < out_degree(); ++a) {
+              node_type const u = _dynamic_array_2.get(v, a);
+              if (u != UNDEFINED) {
+                next[u] = add_paths(next[u], current[v], modulus);
+              }
+            }
+          }
+        }
+        std::swap(current, next);
+      }
+      return result;
+    }
+
+    //! Returns the number of paths with source \p source, target \p target,
+    //! and length in the range \f$[min, max)\f$.
+    //!
+    //! \param source the first node of the paths.
+    //! \param target the last node of the paths, or libsemigroups::UNDEFINED
+    //! for paths with any last node.
+    //! \param min the minimum length of a path (default: 0).
+    //! \param max one more than the maximum length of a path (default:
+    //! libsemigroups::POSITIVE_INFINITY).
+    //!
+    //! \returns
+    //! A value of type `uint64_t`, which is libsemigroups::POSITIVE_INFINITY
+    //! if there are infinitely many such paths.
+    //!
+    //! \throws LibsemigroupsException if \p source or \p target is not a
+    //! node, or if the number of paths is finite but at least \f$2 ^
+    //! {64}\f$.
+    //!
+    //! \complexity
+    //! \f$O(mnk)\f$ where \c m is nr_nodes(), \c n is out_degree(), and \c k
+    //! is the least of \p max and the length of the longest path from \p
+    //! source to \p target, if this is finite.
+    uint64_t number_of_paths(node_type source,
+                             node_type target,
+                             size_t    min = 0,
+                             size_t    max = POSITIVE_INFINITY) const {
+      validate_node(source);
+      if (target != UNDEFINED) {
+        validate_node(target);
+      }
+      size_t const longest = max_path_length(source, target);
+      if (max == POSITIVE_INFINITY && longest == POSITIVE_INFINITY) {
+        return POSITIVE_INFINITY;
+      }
+      max = std::min(max, longest);
+      if (min >= max) {
+        return 0;
+      }
+      auto const counts = number_of_paths_by_length(source, target, max);
+      uint64_t   result = 0;
+      for (size_t k = min; k < max; ++k) {
+        result = add_paths(result, counts[k], 0);
+      }
+      return result;
+    }
+
    private:
+    ////////////////////////////////////////////////////////////////////////
+    // ActionDigraph - paths - private
+    ////////////////////////////////////////////////////////////////////////
+
+    // Returns x + y modulo modulus (where x and y are less than modulus) if
+    // modulus is not 0, and x + y otherwise.
+    static uint64_t add_paths(uint64_t x, uint64_t y, uint64_t modulus) {
+      uint64_t const z = x + y;
+      if (modulus == 0) {
+        if (z < x) {
+          LIBSEMIGROUPS_EXCEPTION("the number of paths is at least 2 ^ 64");
+        }
+        return z;
+      }
+      return (z < x || z >= modulus ? z - modulus : z);
+    }
+
+    // Returns one more than the length of the longest path from source to
+    // target (or to any node if target is UNDEFINED), 0 if there are no
+    // such paths, and POSITIVE_INFINITY if there are such paths of every
+    // length, i.e. if some node on such a path belongs to a cycle.
+    size_t max_path_length(node_type source, node_type target) const {
+      T const n = nr_nodes();
+      // The nodes on paths from source to target are those reachable from
+      // source, from which target is reachable.
+      std::vector<bool>      useful(n, false);
+      std::vector<node_type> stack = {source};
+      useful[source]               = true;
+      while (!stack.empty()) {
+        node_type const v = stack.back();
+        stack.pop_back();
+        for (label_type a = 0; a < _degree; ++a) {
+          node_type const u = _dynamic_array_2.get(v, a);
+          if (u != UNDEFINED && !useful[u]) {
+            useful[u] = true;
+            stack.push_back(u);
+          }
+        }
+      }
+      if (target != UNDEFINED) {
+        if (!useful[target]) {
+          return 0;
+        }
+        std::vector<size_t> start;
+        std::vector<T>      source_of, label;
+        reverse_edges(0, false, start, source_of, label);
+        std::vector<bool> back(n, false);
+        back[target] = true;
+        stack.push_back(target);
+        while (!stack.empty()) {
+          node_type const y = stack.back();
+          stack.pop_back();
+          for (size_t e = start[y]; e < start[y + 1]; ++e) {
+            if (!back[source_of[e]]) {
+              back[source_of[e]] = true;
+              stack.push_back(source_of[e]);
+            }
+          }
+        }
+        for (node_type v = 0; v < n; ++v) {
+          useful[v] = useful[v] && back[v];
+        }
+      }
+
+      // Kahn's algorithm, on the subdigraph induced by the useful nodes, in
+      // which every node is reachable from source.
+      std::vector<size_t> in_degree(n, 0);
+      size_t              nr_useful = 0;
+      for (node_type v = 0; v < n; ++v) {
+        if (useful[v]) {
+          ++nr_useful;
+          for (label_type a = 0; a < _degree; ++a) {
+            node_type const u = _dynamic_array_2.get(v, a);
+            if (u != UNDEFINED && useful[u]) {
+              ++in_degree[u];
+            }
+          }
+        }
+      }
+      if (in_degree[source] != 0) {
+        return POSITIVE_INFINITY;
+      }
+      std::vector<size_t> length(n, 0);
+      size_t              nr_sorted = 0;
+      size_t              longest   = 0;
+      stack.push_back(source);
+      while (!stack.empty()) {
+        node_type const v = stack.back();
+        stack.pop_back();
+        ++nr_sorted;
+        longest = std::max(longest, length[v]);
+        for (label_type a = 0; a < _degree; ++a) {
+          node_type const u = _dynamic_array_2.get(v, a);
+          if (u != UNDEFINED && useful[u]) {
+            length[u] = std::max(length[u], length[v] + 1);
+            if (--in_degree[u] == 0) {
+              stack.push_back(u);
+            }
+          }
+        }
+      }
+      if (nr_sorted != nr_useful) {
+        return POSITIVE_INFINITY;
+      }
+      return (target == UNDEFINED ? longest : length[target]) + 1;
+    }
+
     ////////////////////////////////////////////////////////////////////////
     // ActionDigraph - validation - private
     ////////////////////////////////////////////////////////////////////////
@@ -838,6 +1786,24 @@ namespace libsemigroups {
     ////////////////////////////////////////////////////////////////////////
 
     void reset() noexcept {
+      _in_edges._defined        = false;
+      _out_edges._defined       = false;
+      _scc_back_forest._defined = false;
+      _scc._defined             = false;
+      _scc_forest._defined      = false;
+      _scc_back_forest._nr_sccs = 0;
+      _scc._nr_nodes            = 0;
+      _scc_forest._nr_sccs      = 0;
+    }
+
+    // Called after adding nodes, or edges whose source is a node that does
+    // not yet belong to a strongly connected component. Such nodes cannot be
+    // reached from any node in a component, since every such node already
+    // has all of its out-edges, and so the components, and the spanning
+    // forests, that are already known do not change.
+    void reset_appended() noexcept {
+      _in_edges._defined        = false;
+      _out_edges._defined       = false;
       _scc_back_forest._defined = false;
       _scc._defined             = false;
       _scc_forest._defined      = false;
@@ -847,66 +1813,127 @@ namespace libsemigroups {
     // ActionDigraph - strongly connected components - private
     ////////////////////////////////////////////////////////////////////////
 
+    // Returns true if every node in [first, nr_nodes()) has exactly
+    // out_degree() out-edges.
+    bool validate(node_type first) const noexcept {
+      for (node_type v = first; v < nr_nodes(); ++v) {
+        for (label_type i = 0; i < _degree; ++i) {
+          if (_dynamic_array_2.get(v, i) == UNDEFINED) {
+            return false;
+          }
+        }
+      }
+      return true;
+    }
+
+    // Adds the nodes that are not yet in forest, and returns the least node
+    // in any component whose index is at least nr_sccs, these are the
+    // components that do not yet have spanning trees in forest. If nr_sccs
+    // is 0, then forest is cleared first.
+    T init_forest(Forest& forest, size_t nr_sccs) const {
+      if (nr_sccs == 0) {
+        forest.clear();
+      }
+      T const first = forest.nr_nodes();
+      forest.add_nodes(nr_nodes() - first);
+      return first;
+    }
+
+    // Only the nodes in [_scc._nr_nodes, nr_nodes()) are considered, the
+    // components of the other nodes are already known, see reset_appended.
     void gabow_scc() const {
       if (_scc._defined) {
         return;
-      } else if (!validate()) {
+      }
+      T const first = _scc._nr_nodes;
+      if (!validate(first)) {
         LIBSEMIGROUPS_EXCEPTION("digraph not fully defined, cannot find "
                                 "strongly connected components");
+      } else if (_max_threads > 1) {
+        parallel_scc(first);
+        return;
+      }
+
+      if (first == 0) {
+        _scc._comps.clear();
       }
+      _scc._id.resize(first);
+      _scc._id.resize(nr_nodes(), UNDEFINED);
+
+      gabow(
+          first,
+          [](T) { return false; },
+          [this](std::vector<T> const& comp) {
+            for (T x : comp) {
+              _scc._id[x] = _scc._comps.size();
+            }
+            _scc._comps.push_back(comp);
+          });
+      _scc._nr_nodes = nr_nodes();
+      _scc._defined  = true;
+    }
 
+    // Gabow's algorithm for the subdigraph induced by the nodes v in [first,
+    // nr_nodes()) such that done(v) is false. The function found is called
+    // with the nodes of every component of this subdigraph, in the order
+    // that the components are found.
+    template <typename TDone, typename TFound>
+    void gabow(T first, TDone&& done, TFound&& found) const {
       static std::stack<T>               stack1;
       static std::stack<T>               stack2;
       static std::stack<std::pair<T, T>> frame;
+      // The preorder of the node v is in position v - first
       static std::vector<T>              preorder;
-      preorder.assign(nr_nodes(), UNDEFINED);
+      static std::vector<bool>           assigned;
+      static std::vector<T>              comp;
+      preorder.assign(nr_nodes() - first, UNDEFINED);
+      assigned.assign(nr_nodes() - first, false);
       LIBSEMIGROUPS_ASSERT(stack1.empty());
       LIBSEMIGROUPS_ASSERT(stack2.empty());
       LIBSEMIGROUPS_ASSERT(frame.empty());
 
-      _scc._comps.clear();
-      _scc._id.assign(nr_nodes(), UNDEFINED);
+      T C = 0;
 
-      T C     = 0;
-      T index = 0;
-
-      for (T w = 0; w < nr_nodes(); ++w) {
-        if (_scc._id[w] == UNDEFINED) {
+      for (T w = first; w < nr_nodes(); ++w) {
+        if (preorder[w - first] == UNDEFINED && !done(w)) {
           frame.emplace(w, 0);
         dfs_start:
           LIBSEMIGROUPS_ASSERT(!frame.empty());
           T v = frame.top().first;
           T i = frame.top().second;
 
-          preorder[v] = C++;
+          preorder[v - first] = C++;
           stack1.push(v);
           stack2.push(v);
           for (; i < _degree; ++i) {
           dfs_end:
             LIBSEMIGROUPS_ASSERT(v < nr_nodes() && i < _degree);
             T u = _dynamic_array_2.get(v, i);
-            if (preorder[u] == UNDEFINED) {
+            if (u < first || done(u)) {
+              // u belongs to a component that was found previously
+              continue;
+            } else if (preorder[u - first] == UNDEFINED) {
               frame.top().second = i;
               frame.emplace(u, 0);
               goto dfs_start;
-            } else if (_scc._id[u] == UNDEFINED) {
+            } else if (!assigned[u - first]) {
               LIBSEMIGROUPS_ASSERT(!stack2.empty());
-              while (preorder[stack2.top()] > preorder[u]) {
+              while (preorder[stack2.top() - first] > preorder[u - first]) {
                 stack2.pop();
               }
             }
           }
           if (v == stack2.top()) {
-            _scc._comps.emplace_back();
+            comp.clear();
             T x;
             do {
               LIBSEMIGROUPS_ASSERT(!stack1.empty());
-              x           = stack1.top();
-              _scc._id[x] = index;
-              _scc._comps[index].push_back(x);
+              x                   = stack1.top();
+              assigned[x - first] = true;
+              comp.push_back(x);
               stack1.pop();
             } while (x != v);
-            ++index;
+            found(comp);
             LIBSEMIGROUPS_ASSERT(!stack2.empty());
             stack2.pop();
           }
@@ -919,7 +1946,433 @@ namespace libsemigroups {
           }
         }
       }
-      _scc._defined = true;
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    // ActionDigraph - parallel strongly connected components - private
+    ////////////////////////////////////////////////////////////////////////
+
+    // Returns the number of blocks of the nodes in [0, n) used by
+    // parallel_for, when the blocks have to be known in advance.
+    size_t nr_blocks(size_t n) const noexcept {
+      return std::max(size_t(1), std::min(_max_threads, n / 1024));
+    }
+
+    // Finds the edges x -> y with x and y in [first, nr_nodes()), and (if
+    // same_scc is true, in which case every edge must be defined) in the
+    // same component. The sources of the edges with
+    // range y are source[start[y - first]], ..., source[start[y - first + 1]
+    // - 1], sorted by the source and then the label, and the labels of these
+    // edges are in the same positions in label.
+    void reverse_edges(T                    first,
+                       bool                 same_scc,
+                       std::vector<size_t>& start,
+                       std::vector<T>&      source,
+                       std::vector<T>&      label) const {
+      start.assign(nr_nodes() - first + 1, 0);
+      for (T x = first; x < nr_nodes(); ++x) {
+        for (T j = 0; j < _degree; ++j) {
+          T const y = _dynamic_array_2.get(x, j);
+          if (same_scc ? _scc._id[x] == _scc._id[y]
+                       : y != UNDEFINED && y >= first) {
+            start[y - first + 1]++;
+          }
+        }
+      }
+      for (size_t i = 1; i < start.size(); ++i) {
+        start[i] += start[i - 1];
+      }
+      source.resize(start.back());
+      label.resize(start.back());
+      std::vector<size_t> next(start.cbegin(), start.cend() - 1);
+      for (T x = first; x < nr_nodes(); ++x) {
+        for (T j = 0; j < _degree; ++j) {
+          T const y = _dynamic_array_2.get(x, j);
+          if (same_scc ? _scc._id[x] == _scc._id[y]
+                       : y != UNDEFINED && y >= first) {
+            source[next[y - first]]  = x;
+            label[next[y - first]++] = j;
+          }
+        }
+      }
+    }
+
+    // Removes every node of active with no in-neighbours, or no
+    // out-neighbours, in active other than itself, until there are no such
+    // nodes. Every such node is a component on its own, and is its own root.
+    // The vectors in and out are indexed by the node minus first, and are
+    // used to store the in- and out-degrees of the nodes in active.
+    void trim_scc(T                          first,
+                  std::vector<size_t> const& start,
+                  std::vector<T> const&      source,
+                  std::vector<T>&            root,
+                  std::vector<T>&            active,
+                  std::vector<size_t>&       in,
+                  std::vector<size_t>&       out) const {
+      auto is_active = [&root, first](T v) {
+        return v >= first && root[v - first] == UNDEFINED;
+      };
+      detail::parallel_for(
+          active.size(),
+          _max_threads,
+          1024,
+          [this, &active, &in, &is_active, &out, &source, &start, first](
+              size_t i, size_t last) {
+            for (; i < last; ++i) {
+              T const v = active[i];
+              out[v - first] = 0;
+              for (T j = 0; j < _degree; ++j) {
+                T const u = _dynamic_array_2.get(v, j);
+                if (u != v && is_active(u)) {
+                  out[v - first]++;
+                }
+              }
+              in[v - first] = 0;
+              for (size_t e = start[v - first]; e < start[v - first + 1];
+                   ++e) {
+                T const x = source[e];
+                if (x != v && is_active(x)) {
+                  in[v - first]++;
+                }
+              }
+            }
+          });
+      std::vector<T> stack;
+      for (T v : active) {
+        if (in[v - first] == 0 || out[v - first] == 0) {
+          root[v - first] = v;
+          stack.push_back(v);
+        }
+      }
+      // A chain of nodes is removed one node at a time, but every node and
+      // edge is only considered once.
+      while (!stack.empty()) {
+        T const v = stack.back();
+        stack.pop_back();
+        for (T j = 0; j < _degree; ++j) {
+          T const u = _dynamic_array_2.get(v, j);
+          if (u != v && is_active(u) && --in[u - first] == 0) {
+            root[u - first] = u;
+            stack.push_back(u);
+          }
+        }
+        for (size_t e = start[v - first]; e < start[v - first + 1]; ++e) {
+          T const x = source[e];
+          if (x != v && is_active(x) && --out[x - first] == 0) {
+            root[x - first] = x;
+            stack.push_back(x);
+          }
+        }
+      }
+      active.erase(std::remove_if(active.begin(),
+                                  active.end(),
+                                  [&root, first](T v) {
+                                    return root[v - first] != UNDEFINED;
+                                  }),
+                   active.end());
+    }
+
+    // This is the colouring algorithm of Orzan. Every node not yet in a
+    // component is given its own value as its colour, and then the colours
+    // are repeatedly replaced by the least colour of an in-neighbour until
+    // nothing changes. The least node c of every colour is the only node
+    // with colour c, that has c as its original colour, and the nodes of
+    // colour c that can reach c form the component of c. The nodes in these
+    // components are then removed, and the process is repeated. Every step
+    // is done in parallel. Before every round, the nodes that are obviously
+    // components on their own are removed by trim_scc, since otherwise a
+    // long path would be removed one node per round.
+    //
+    // A round of colouring can still remove very few nodes (for example, if
+    // the digraph is a long path of small components), or the colours can
+    // take many iterations to settle, and so if the number of nodes
+    // considered exceeds a fixed multiple of the number of nodes, then the
+    // components of the remaining nodes are found using Gabow's algorithm.
+    //
+    // Only the nodes in [first, nr_nodes()) are considered, the components
+    // of the other nodes are already known, see reset_appended. The vectors
+    // colour and root are indexed by the node minus first.
+    void parallel_scc(T first) const {
+      T const             n = nr_nodes();
+      std::vector<size_t> start;
+      std::vector<T>      source, label;
+      reverse_edges(first, false, start, source, label);
+
+      std::vector<std::atomic<T>> colour(n - first);
+      std::vector<T>              root(n - first, T(UNDEFINED));
+      std::vector<T>              active(n - first);
+      std::iota(active.begin(), active.end(), first);
+      std::vector<size_t> in(n - first), out(n - first);
+
+      size_t const max_work = 64 * size_t(n - first);
+      size_t       work     = 0;
+
+      while (true) {
+        work += active.size();
+        trim_scc(first, start, source, root, active, in, out);
+        if (active.empty()) {
+          break;
+        } else if (work > max_work) {
+          gabow(
+              first,
+              [&root, first](T v) { return root[v - first] != UNDEFINED; },
+              [&root, first](std::vector<T> const& comp) {
+                T const r = *std::min_element(comp.cbegin(), comp.cend());
+                for (T x : comp) {
+                  root[x - first] = r;
+                }
+              });
+          break;
+        }
+        detail::parallel_for(
+            active.size(),
+            _max_threads,
+            1024,
+            [&colour, &active, first](size_t i, size_t last) {
+              for (; i < last; ++i) {
+                colour[active[i] - first].store(active[i],
+                                                std::memory_order_relaxed);
+              }
+            });
+        std::atomic<bool> changed(true);
+        while (changed && work <= max_work) {
+          work += active.size();
+          changed = false;
+          detail::parallel_for(
+              active.size(),
+              _max_threads,
+              1024,
+              [this, &active, &changed, &colour, &root, first](size_t i,
+                                                               size_t last) {
+                bool local_changed = false;
+                for (; i < last; ++i) {
+                  T const v = active[i];
+                  T const c
+                      = colour[v - first].load(std::memory_order_relaxed);
+                  for (T j = 0; j < _degree; ++j) {
+                    T const u = _dynamic_array_2.get(v, j);
+                    if (u < first || root[u - first] != UNDEFINED) {
+                      continue;
+                    }
+                    std::atomic<T>& cu = colour[u - first];
+                    T               d  = cu.load(std::memory_order_relaxed);
+                    while (c < d
+                           && !cu.compare_exchange_weak(
+                               d, c, std::memory_order_relaxed)) {
+                    }
+                    local_changed |= (c < d);
+                  }
+                }
+                if (local_changed) {
+                  changed = true;
+                }
+              });
+        }
+        if (changed) {
+          // The colours did not settle within the budget.
+          continue;
+        }
+        std::vector<T> roots;
+        for (T v : active) {
+          if (colour[v - first] == v) {
+            roots.push_back(v);
+          }
+        }
+        // Every node belongs to at most one of the searches, the one for
+        // its colour, and so they can be done at the same time.
+        detail::parallel_for(
+            roots.size(),
+            _max_threads,
+            1,
+            [&colour, &root, &roots, &source, &start, first](size_t i,
+                                                             size_t last) {
+              std::vector<T> stack;
+              for (; i < last; ++i) {
+                T const c       = roots[i];
+                root[c - first] = c;
+                stack.push_back(c);
+                while (!stack.empty()) {
+                  T const y = stack.back();
+                  stack.pop_back();
+                  for (size_t e = start[y - first]; e < start[y - first + 1];
+                       ++e) {
+                    T const x = source[e];
+                    if (colour[x - first] == c
+                        && root[x - first] == UNDEFINED) {
+                      root[x - first] = c;
+                      stack.push_back(x);
+                    }
+                  }
+                }
+              }
+            });
+        active.erase(std::remove_if(active.begin(),
+                                    active.end(),
+                                    [&root, first](T v) {
+                                      return root[v - first] != UNDEFINED;
+                                    }),
+                     active.end());
+      }
+
+      // The root of every component is its least node, and so the components
+      // are created in the order of their roots.
+      if (first == 0) {
+        _scc._comps.clear();
+      }
+      _scc._id.resize(first);
+      _scc._id.resize(n, UNDEFINED);
+      for (T v = first; v < n; ++v) {
+        T const r = root[v - first];
+        if (r == v) {
+          _scc._id[v] = _scc._comps.size();
+          _scc._comps.emplace_back();
+        } else {
+          _scc._id[v] = _scc._id[r];
+        }
+        _scc._comps[_scc._id[v]].push_back(v);
+      }
+      _scc._nr_nodes = n;
+      _scc._defined  = true;
+    }
+
+    // The out-edges of the node x, in the same component as x, in the
+    // order they are considered in spanning_forest.
+    struct ForwardEdges {
+      template <typename TFunc>
+      void operator()(size_t p, T x, TFunc&& func) const {
+        for (T j = 0; j < _graph->_degree; ++j) {
+          T const y = _graph->_dynamic_array_2.get(x, j);
+          if (_graph->_scc._id[y] == _graph->_scc._id[x]) {
+            func(y, uint64_t(p) * _graph->_degree + j, j);
+          }
+        }
+      }
+      ActionDigraph const* _graph;
+    };
+
+    // The in-edges of the node x, in the same component as x, in the order
+    // they are considered in reverse_spanning_forest. An in-neighbour of x
+    // with several edges to x is only included once, with the least label.
+    struct ReverseEdges {
+      template <typename TFunc>
+      void operator()(size_t p, T x, TFunc&& func) const {
+        size_t const lo = (*_start)[x - _first];
+        size_t const hi = (*_start)[x - _first + 1];
+        for (size_t e = lo; e < hi; ++e) {
+          if (e == lo || (*_source)[e - 1] != (*_source)[e]) {
+            func((*_source)[e], uint64_t(p), (*_label)[e]);
+          }
+        }
+      }
+      T                          _first;
+      std::vector<T> const*      _label;
+      std::vector<T> const*      _source;
+      std::vector<size_t> const* _start;
+    };
+
+    // The nodes at distance d + 1 from the roots of the components with
+    // index at least nr_sccs (whose nodes are at least first) are found
+    // from those at distance d (in frontier) at the same time. The parent of
+    // every new node is the first node in frontier adjacent to it, and the
+    // new nodes are ordered by their parents, and then by the order of the
+    // edges from their parents. This is the same forest as that found by
+    // the breadth-first searches in spanning_forest and
+    // reverse_spanning_forest.
+    //
+    // The function edges(p, x, func), where x is in position p of frontier,
+    // calls func(y, key, lbl) for the edges from x to nodes y in the same
+    // component, in the order described above, where lbl is the label of
+    // the edge, and key is increasing in p, and in the edges of x if the
+    // same node can be adjacent to x more than once.
+    template <typename TEdges>
+    void parallel_bfs(Forest&       forest,
+                      T             first,
+                      size_t        nr_sccs,
+                      TEdges const& edges) const {
+      std::vector<T> frontier;
+      for (size_t i = nr_sccs; i < nr_scc(); ++i) {
+        frontier.push_back(_scc._comps[i][0]);
+      }
+      std::vector<uint8_t> seen(nr_nodes() - first, false);
+      for (T x : frontier) {
+        seen[x - first] = true;
+      }
+      std::vector<std::atomic<uint64_t>> best(nr_nodes() - first);
+      detail::parallel_for(best.size(),
+                           _max_threads,
+                           1024,
+                           [&best](size_t i, size_t last) {
+                             for (; i < last; ++i) {
+                               best[i].store(UINT64_MAX,
+                                             std::memory_order_relaxed);
+                             }
+                           });
+
+      std::vector<std::vector<T>> next;
+      while (!frontier.empty()) {
+        size_t const nr = nr_blocks(frontier.size());
+        next.assign(nr, std::vector<T>());
+        // Find the least key of an edge to every new node
+        detail::parallel_for(nr, nr, 1, [&](size_t b, size_t) {
+          size_t const lo = frontier.size() * b / nr;
+          size_t const hi = frontier.size() * (b + 1) / nr;
+          for (size_t p = lo; p < hi; ++p) {
+            edges(p, frontier[p], [&](T y, uint64_t key, T) {
+              if (!seen[y - first]) {
+                uint64_t k = best[y - first].load(std::memory_order_relaxed);
+                while (key < k
+                       && !best[y - first].compare_exchange_weak(
+                           k, key, std::memory_order_relaxed)) {
+                }
+              }
+            });
+          }
+        });
+        // Set the parent of every new node, the new nodes found in the b-th
+        // block of frontier are put in next[b].
+        detail::parallel_for(nr, nr, 1, [&](size_t b, size_t) {
+          size_t const lo = frontier.size() * b / nr;
+          size_t const hi = frontier.size() * (b + 1) / nr;
+          for (size_t p = lo; p < hi; ++p) {
+            T const x = frontier[p];
+            edges(p, x, [&](T y, uint64_t key, T lbl) {
+              if (!seen[y - first]
+                  && best[y - first].load(std::memory_order_relaxed) == key) {
+                forest.set(y, x, lbl);
+                next[b].push_back(y);
+              }
+            });
+          }
+        });
+        frontier.clear();
+        for (auto const& block : next) {
+          for (T y : block) {
+            seen[y - first] = true;
+            frontier.push_back(y);
+          }
+        }
+      }
+    }
+
+    void parallel_spanning_forest(T first) const {
+      parallel_bfs(_scc_forest._forest,
+                   first,
+                   _scc_forest._nr_sccs,
+                   ForwardEdges{this});
+      _scc_forest._nr_sccs = nr_scc();
+      _scc_forest._defined = true;
+    }
+
+    void parallel_reverse_spanning_forest(T first) const {
+      std::vector<size_t> start;
+      std::vector<T>      source, label;
+      reverse_edges(first, true, start, source, label);
+      parallel_bfs(_scc_back_forest._forest,
+                   first,
+                   _scc_back_forest._nr_sccs,
+                   ReverseEdges{first, &label, &source, &start});
+      _scc_back_forest._nr_sccs = nr_scc();
+      _scc_back_forest._defined = true;
     }
 
     ////////////////////////////////////////////////////////////////////////
@@ -927,6 +2380,8 @@ namespace libsemigroups {
     ////////////////////////////////////////////////////////////////////////
 
     T                                _degree;
+    size_t                           _max_threads;
+    size_t                           _nr_edges;
     T                                _nr_nodes;
     mutable detail::DynamicArray2<T> _dynamic_array_2;
 
@@ -935,20 +2390,31 @@ namespace libsemigroups {
       bool _defined;
     };
 
+    mutable struct CompressedEdgesAttr : public Attr {
+      CompressedEdgesAttr() : Attr(), _edges() {}
+      CompressedEdges _edges;
+    } _in_edges, _out_edges;
+
+    // In both forests, _nr_sccs is the number of components whose spanning
+    // trees are in _forest.
     mutable struct SCCBackForest : public Attr {
-      SCCBackForest() : Attr(), _forest() {}
+      SCCBackForest() : Attr(), _forest(), _nr_sccs(0) {}
       Forest _forest;
+      size_t _nr_sccs;
     } _scc_back_forest;
 
     mutable struct SCCForwardForest : public Attr {
-      SCCForwardForest() : Attr(), _forest() {}
+      SCCForwardForest() : Attr(), _forest(), _nr_sccs(0) {}
       Forest _forest;
+      size_t _nr_sccs;
     } _scc_forest;
 
+    // The nodes in [0, _nr_nodes) belong to the components in _comps.
     mutable struct SCC : public Attr {
-      SCC() : Attr(), _comps(), _id() {}
+      SCC() : Attr(), _comps(), _id(), _nr_nodes(0) {}
       std::vector<std::vector<size_t>> _comps;
       std::vector<T>                   _id;
+      T                                _nr_nodes;
     } _scc;
   };
 
@@ -1161,10 +1161,9 @@ namespace libsemigroups {
     //! function asserts that the degrees of \p x, \p y, and \c this, are all
     //! equal, and that neither \p x nor  \p y equals \c this.
     //!
-    //! The parameter \p thread_id is required since some temporary storage is
-    //! required to find the product of \p x and \p y.  Note that if different
-    //! threads call this member function with the same value of \p thread_id
-    //! then bad things will happen.
+    //! Some temporary storage is required to find the product of \p x and
+    //! \p y, which is local to the calling thread, and so the third parameter
+    //! is ignored.
     void redefine(Element const&, Element const&, size_t) override;
 
     //! Returns the number of transverse blocks.
@@ -1249,8 +1248,8 @@ namespace libsemigroups {
     uint32_t fuseit(std::vector<uint32_t>& fuse, uint32_t pos);
     void     init_trans_blocks_lookup();
 
-    static std::vector<std::vector<uint32_t>> _fuse;
-    static std::vector<std::vector<uint32_t>> _lookup;
+    static thread_local std::vector<uint32_t> _fuse;
+    static thread_local std::vector<uint32_t> _lookup;
 
     size_t            _nr_blocks;
     size_t            _nr_left_blocks;
@@ -1821,10 +1820,9 @@ namespace libsemigroups {
     //! that the degrees of \p x, \p y, and \c this, are all equal, and that
     //! neither \p x nor  \p y equals \c this.
     //!
-    //! The parameter \p thread_id is required since some temporary storage is
-    //! required to find the product of \p x and \p y.  Note that if different
-    //! threads call this member function with the same value of \p thread_id
-    //! then bad things will happen.
+    //! Some temporary storage is required to find the product of \p x and
+    //! \p y, which is local to the calling thread, and so the third parameter
+    //! is ignored.
     void redefine(Element const&, Element const&, size_t) override;
 
     //! Insertion operator
@@ -1869,10 +1867,10 @@ namespace libsemigroups {
                PBR const* const,
                size_t const&);
 
-    static std::vector<std::vector<bool>>           _x_seen;
-    static std::vector<std::vector<bool>>           _y_seen;
-    static std::vector<detail::DynamicArray2<bool>> _out;
-    static std::vector<detail::DynamicArray2<bool>> _tmp;
+    static thread_local std::vector<bool>           _x_seen;
+    static thread_local std::vector<bool>           _y_seen;
+    static thread_local detail::DynamicArray2<bool> _out;
+    static thread_local detail::DynamicArray2<bool> _tmp;
   };
 
   // Specialization of templates from adapters.hpp for classes derived from
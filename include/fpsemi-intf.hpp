@@ -240,6 +240,147 @@ namespace libsemigroups {
       return equal_to(word_type(u), word_type(v));
     }
 
+    //! Returns the normal forms of a collection of strings.
+    //!
+    //! The item in position \c i of the returned vector is equal to
+    //! \c normal_form(words[i]). Every word in \p words is validated
+    //! before any normal forms are computed, and the normal forms may be
+    //! computed using up to max_threads() threads, depending on the
+    //! implementation.
+    //!
+    //! \param words the strings whose normal forms we want to find.
+    //!
+    //! \returns A std::vector of std::string.
+    //!
+    //! \throws LibsemigroupsException if any word in \p words contains a
+    //! letter that is not in alphabet().
+    //!
+    //! \par Complexity
+    //! See warning.
+    //!
+    //! \warning The function for finding the structure of a finitely
+    //! presented semigroup may be non-deterministic, or since the problem is
+    //! undecidable in general, this function may never return a result.
+    //!
+    //! \sa normal_form(std::string const&).
+    std::vector<std::string>
+    normal_forms(std::vector<std::string> const& words);
+
+    //! Returns the normal forms of a collection of words.
+    //!
+    //! The item in position \c i of the returned vector is equal to
+    //! \c normal_form(words[i]). Every word in \p words is validated
+    //! before any normal forms are computed, and the normal forms may be
+    //! computed using up to max_threads() threads, depending on the
+    //! implementation.
+    //!
+    //! \param words the words whose normal forms we want to find.
+    //!
+    //! \returns A std::vector of libsemigroups::word_type.
+    //!
+    //! \throws LibsemigroupsException if any word in \p words contains a
+    //! letter that is out of bounds.
+    //!
+    //! \par Complexity
+    //! See warning.
+    //!
+    //! \warning The function for finding the structure of a finitely
+    //! presented semigroup may be non-deterministic, or since the problem is
+    //! undecidable in general, this function may never return a result.
+    //!
+    //! \sa normal_form(word_type const&).
+    std::vector<word_type> normal_forms(std::vector<word_type> const& words);
+
+    //! Check if each of a collection of pairs of strings represent the same
+    //! element.
+    //!
+    //! The item in position \c i of the returned vector is equal to
+    //! \c equal_to(pairs[i].first, pairs[i].second).
+    //!
+    //! \param pairs the pairs of strings to compare.
+    //!
+    //! \returns A std::vector of \c bool.
+    //!
+    //! \throws LibsemigroupsException if any word in \p pairs contains a
+    //! letter that is not in alphabet().
+    //!
+    //! \par Complexity
+    //! See warning.
+    //!
+    //! \warning The problem of determining the return value of this function
+    //! is undecidable in general, and this function may never terminate.
+    //!
+    //! \sa normal_forms(std::vector<std::string> const&).
+    std::vector<bool> equal_to(std::vector<rule_type> const& pairs);
+
+    //! Check if each of a collection of pairs of words represent the same
+    //! element.
+    //!
+    //! The item in position \c i of the returned vector is equal to
+    //! \c equal_to(pairs[i].first, pairs[i].second).
+    //!
+    //! \param pairs the pairs of words to compare.
+    //!
+    //! \returns A std::vector of \c bool.
+    //!
+    //! \throws LibsemigroupsException if any word in \p pairs contains a
+    //! letter that is out of bounds.
+    //!
+    //! \par Complexity
+    //! See warning.
+    //!
+    //! \warning The problem of determining the return value of this function
+    //! is undecidable in general, and this function may never terminate.
+    //!
+    //! \sa normal_forms(std::vector<word_type> const&).
+    std::vector<bool> equal_to(std::vector<relation_type> const& pairs);
+
+    //! Set the maximum number of threads.
+    //!
+    //! This member function sets the maximum number of threads to be used by
+    //! normal_forms() and the overloads of equal_to() for collections of
+    //! pairs. The number of threads is limited to the maximum of 1 and \p
+    //! nr_threads.
+    //!
+    //! The default value is **std::thread::hardware_concurrency()**.
+    //!
+    //! \param nr_threads the maximum number of threads to use.
+    //!
+    //! \returns A reference to \c this.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    //!
+    //! \sa
+    //! max_threads().
+    FpSemigroupInterface& max_threads(size_t nr_threads) noexcept {
+      _max_threads = (nr_threads == 0 ? 1 : nr_threads);
+      return *this;
+    }
+
+    //! Returns the current value of the maximum number of threads.
+    //!
+    //! \returns
+    //! A `size_t`.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    //!
+    //! \sa
+    //! max_threads(size_t).
+    //!
+    //! \par Parameters
+    //! (None)
+    size_t max_threads() const noexcept {
+      return _max_threads;
+    }
+
     //! Convert a string to a libsemigroups::word_type representing the same
     //! element of the finitely presented semigroup represented by \c this.
     //!
@@ -825,6 +966,13 @@ namespace libsemigroups {
     virtual void validate_word_impl(word_type const&) const;
     // Returns true if we should add rules for the identity and false if not.
     virtual bool validate_identity_impl(std::string const&) const;
+    // Override normal_forms_impl to compute many normal forms at once, for
+    // example, in parallel. The words passed to these functions have already
+    // been validated. The defaults just call normal_form repeatedly.
+    virtual std::vector<std::string>
+    normal_forms_impl(std::vector<std::string> const&);
+    virtual std::vector<word_type>
+    normal_forms_impl(std::vector<word_type> const&);
 
     //////////////////////////////////////////////////////////////////////////////
     // FpSemigroupInterface - non-virtual member functions - private
@@ -845,6 +993,7 @@ namespace libsemigroups {
     std::string                           _identity;
     std::string                           _inverses;
     std::vector<rule_type>                _rules;
+    size_t                                _max_threads;
 
     //////////////////////////////////////////////////////////////////////////////
     // FpSemigroupInterface - mutable data - private
@@ -25,6 +25,7 @@
 #include <cstddef>  // for size_t
 #include <memory>   // for shared_ptr
 #include <string>   // for string
+#include <vector>   // for vector
 
 #include "fpsemi-intf.hpp"   // for FpSemigroupInterface
 #include "knuth-bendix.hpp"  // for KnuthBendix
@@ -251,6 +252,10 @@ namespace libsemigroups {
     bool                             is_obviously_infinite_impl() override;
 
     void run_impl() override {
+      if (memory_limit() != POSITIVE_INFINITY || cpu_time_limit() != FOREVER) {
+        // The budget of this applies to each of its runners separately.
+        _race.budget(memory_limit(), cpu_time_limit());
+      }
       _race.winner();
     }
 
@@ -265,6 +270,10 @@ namespace libsemigroups {
     void set_alphabet_impl(std::string const&) override;
     void set_alphabet_impl(size_t) override;
     bool is_obviously_finite_impl() override;
+    std::vector<std::string>
+    normal_forms_impl(std::vector<std::string> const&) override;
+    std::vector<word_type>
+    normal_forms_impl(std::vector<word_type> const&) override;
 
     //////////////////////////////////////////////////////////////////////////
     // FpSemigroup - data - private
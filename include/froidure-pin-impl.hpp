@@ -22,6 +22,8 @@
 #include "libsemigroups-debug.hpp"      // for LIBSEMIGROUPS_ASSERT
 #include "libsemigroups-exception.hpp"  // for LIBSEMIGROUPS_EXCEPTION
 #include "report.hpp"                   // for REPORT
+#include "runner.hpp"                   // for detail::CancellationToken
+#include "thread-pool.hpp"              // for detail::TaskGroup
 #include "timer.hpp"                    // for detail::Timer
 
 #ifndef LIBSEMIGROUPS_INCLUDE_FROIDURE_PIN_IMPL_HPP_
@@ -1377,8 +1379,7 @@ namespace libsemigroups {
       std::vector<enumerate_index_type> last(N, _nr);
       std::vector<std::vector<internal_idempotent_pair>> tmp(
           N, std::vector<internal_idempotent_pair>());
-      std::vector<std::thread> threads;
-      THREAD_ID_MANAGER.reset();
+      detail::TaskGroup tg;
 
       for (size_t i = 0; i < N - 1; i++) {
         size_t thread_load = 0;
@@ -1398,25 +1399,20 @@ namespace libsemigroups {
         REPORT_DEFAULT("thread %d has load %d\n", i + 1, thread_load);
         first[i + 1] = last[i];
 
-        threads.emplace_back(&FroidurePin::idempotents,
-                             this,
-                             first[i],
-                             last[i],
-                             threshold_index,
-                             std::ref(tmp[i]));
+        enumerate_index_type const f = first[i], l = last[i];
+        auto* out = &tmp[i];
+        tg.run([this, f, l, threshold_index, out]() {
+          idempotents(f, l, threshold_index, *out);
+        });
       }
 
       REPORT_DEFAULT("thread %d has load %d\n", N, total_load);
-      threads.emplace_back(&FroidurePin::idempotents,
-                           this,
-                           first[N - 1],
-                           last[N - 1],
-                           threshold_index,
-                           std::ref(tmp[N - 1]));
+      // The calling thread does the final block
+      idempotents(first[N - 1], last[N - 1], threshold_index, tmp[N - 1]);
+      tg.wait();
 
       size_t nr_idempotents = 0;
       for (size_t i = 0; i < N; i++) {
-        threads[i].join();
         nr_idempotents += tmp[i].size();
       }
       _idempotents.reserve(nr_idempotents);
@@ -1425,6 +1421,12 @@ namespace libsemigroups {
             tmp[i].begin(), tmp[i].end(), std::back_inserter(_idempotents));
       }
     }
+    if (dead()) {
+      // The loops in idempotents stop early if this is killed, and so what
+      // we found is incomplete.
+      _idempotents.clear();
+      _idempotents_found = false;
+    }
     REPORT_TIME(timer);
   }
 
@@ -1442,9 +1444,10 @@ namespace libsemigroups {
         "first = %d, last = %d, diff = %d\n", first, last, last - first);
     detail::Timer timer;
 
-    enumerate_index_type pos = first;
+    enumerate_index_type      pos = first;
+    detail::CancellationToken cancelled(*this);
 
-    for (; pos < std::min(threshold, last); pos++) {
+    for (; pos < std::min(threshold, last) && !cancelled(); pos++) {
       element_index_type k = _enumerate_order[pos];
       if (!_is_idempotent[k]) {
         // The following is product_by_reduction, don't have to consider
@@ -1464,7 +1467,7 @@ namespace libsemigroups {
       }
     }
 
-    if (pos >= last) {
+    if (pos >= last || cancelled()) {
       REPORT_TIME(timer);
       return;
     }
@@ -1472,8 +1475,11 @@ namespace libsemigroups {
     // Cannot use _tmp_product itself since there are multiple threads here!
     internal_element_type tmp_product = this->internal_copy(_tmp_product);
     size_t tid = THREAD_ID_MANAGER.tid(std::this_thread::get_id());
+    // Products can be much more expensive than tracing paths in the Cayley
+    // graph, and so we check more often here.
+    detail::CancellationToken cancelled_product(*this, 64);
 
-    for (; pos < last; pos++) {
+    for (; pos < last && !cancelled_product(); pos++) {
       element_index_type k = _enumerate_order[pos];
       if (!_is_idempotent[k]) {
         Product()(this->to_external(tmp_product),
@@ -170,10 +170,10 @@ namespace libsemigroups {
       // \p x and \p y. This member function asserts that \p x and \p y have the
       // same rewriting system.
       //
-      // The parameter \p thread_id is required since some temporary storage is
-      // required to find the product of \p x and \p y.  Note that if different
-      // threads call this member function with the same value of \p thread_id
-      // then bad things will happen.
+      // The product is found in-place in the storage of \c this (which is
+      // typically a temporary element that is reused for every product), and
+      // so no memory is allocated once this storage is large enough. The
+      // parameter \p thread_id is not used.
       void redefine(Element const&, Element const&, size_t = 0) override;
 
       // #ifdef LIBSEMIGROUPS_DENSEHASHMAP
@@ -183,6 +183,12 @@ namespace libsemigroups {
       operator word_type() const;
       operator std::string() const;
 
+      // KBE's are allocated from a pool of fixed size blocks, rather than one
+      // at a time, since FroidurePin<KBE> allocates a KBE for every element it
+      // stores.
+      static void* operator new(size_t);
+      static void  operator delete(void*) noexcept;
+
      private:
       KnuthBendix*         _kb;
       internal_string_type _kb_word;
@@ -26,7 +26,7 @@
 #define LIBSEMIGROUPS_INCLUDE_KNUTH_BENDIX_HPP_
 
 #include <cstddef>  // for size_t
-#include <iosfwd>   // for string, ostream
+#include <iosfwd>   // for string, ostream, istream
 #include <memory>   // for unique_ptr
 #include <vector>   // for vector
 
@@ -99,6 +99,47 @@ namespace libsemigroups {
           //! \f$d(AB, BC) = max(|AB|, |BC|)\f$
           MAX_AB_BC = 2
         };
+
+        //! The values in this enum determine the reduction ordering used by
+        //! a KnuthBendix instance to orient its rules.
+        //!
+        //! \sa KnuthBendix::order(policy::order)
+        enum class order {
+          //! The short-lex ordering.
+          shortlex = 0,
+          //! The short-lex ordering where the length of a word is replaced by
+          //! the sum of the weights of its letters, and words of equal weight
+          //! are compared using the short-lex ordering.
+          //!
+          //! \sa KnuthBendix::weights(std::vector<size_t> const&)
+          weighted_shortlex = 1,
+          //! The recursive path ordering, this is the wreath product ordering
+          //! where every letter has its own level.
+          //!
+          //! \sa recursive_path_compare
+          recursive = 2
+        };
+
+        //! The values in this enum determine what a KnuthBendix instance does
+        //! when the memory used by its rules exceeds the value set by
+        //! KnuthBendix::max_memory.
+        //!
+        //! In either case, the inactive rules, which are only kept so that
+        //! they can be reused, are freed first.
+        //!
+        //! \sa KnuthBendix::prune_policy(policy::prune)
+        enum class prune {
+          //! Discard the active rules with the longest left hand sides. After
+          //! any rules are discarded, the system is not confluent until
+          //! KnuthBendix::knuth_bendix is run again (and completes), when the
+          //! defining rules are added again.
+          longest_rules = 0,
+          //! Postpone the overlaps longer than the overlap that most recently
+          //! produced a new rule (as measured by KnuthBendix::overlap_policy),
+          //! until the next time KnuthBendix::knuth_bendix is run. No rules
+          //! are discarded.
+          overlap_length = 1
+        };
       };
 
       //////////////////////////////////////////////////////////////////////////
@@ -229,6 +270,53 @@ namespace libsemigroups {
         return *this;
       }
 
+      //! Set the (approximate) maximum number of bytes used by the rules.
+      //!
+      //! If the number of bytes used by the active rules, the inactive rules,
+      //! and the rules waiting to be processed exceeds this value, in a call
+      //! to KnuthBendix::knuth_bendix, then the pruning policy set by
+      //! KnuthBendix::prune_policy is applied, and the system may not be
+      //! confluent when KnuthBendix::knuth_bendix returns.
+      //!
+      //! The memory used is estimated periodically, and so it can exceed
+      //! this value for a short time.
+      //!
+      //! By default this value is libsemigroups::POSITIVE_INFINITY.
+      //!
+      //! \param val the maximum number of bytes.
+      //!
+      //! \returns
+      //! A reference to \c *this.
+      //!
+      //! \complexity
+      //! Constant.
+      //!
+      //! \sa KnuthBendix::memory_used and KnuthBendix::nr_discarded_rules.
+      KnuthBendix& max_memory(size_t val) {
+        _settings._max_memory = val;
+        return *this;
+      }
+
+      //! Set the pruning policy.
+      //!
+      //! This function can be used to determine what happens when the memory
+      //! used by the rules exceeds the value set by KnuthBendix::max_memory.
+      //! The default is policy::prune::longest_rules.
+      //!
+      //! \param val the pruning policy.
+      //!
+      //! \returns
+      //! A reference to \c *this.
+      //!
+      //! \complexity
+      //! Constant.
+      //!
+      //! \sa KnuthBendix::policy::prune.
+      KnuthBendix& prune_policy(policy::prune val) {
+        _settings._prune_policy = val;
+        return *this;
+      }
+
       //! Set the overlap policy.
       //!
       //! This function can be used to determine the way that the length
@@ -245,6 +333,78 @@ namespace libsemigroups {
       //! \sa KnuthBendix::policy::overlap.
       KnuthBendix& overlap_policy(policy::overlap val);
 
+      //! Set the reduction ordering.
+      //!
+      //! This function can be used to set the reduction ordering used to
+      //! orient the rules of the system. The default is
+      //! policy::order::shortlex. If the reduction ordering is
+      //! policy::order::weighted_shortlex, then the weights of the letters are
+      //! those set by KnuthBendix::weights, and every letter has weight \c 1
+      //! by default.
+      //!
+      //! \param val the reduction ordering.
+      //!
+      //! \returns
+      //! A reference to \c *this.
+      //!
+      //! \throws LibsemigroupsException if any rules have been added to \c
+      //! this.
+      //!
+      //! \complexity
+      //! Constant.
+      //!
+      //! \sa KnuthBendix::policy::order.
+      KnuthBendix& order(policy::order val);
+
+      //! Returns the reduction ordering.
+      //!
+      //! \returns
+      //! A value of type policy::order.
+      //!
+      //! \exceptions
+      //! \noexcept
+      //!
+      //! \par Parameters
+      //! (None)
+      policy::order order() const noexcept {
+        return _settings._order;
+      }
+
+      //! Set the weights of the letters.
+      //!
+      //! The weight of the letter \c alphabet()[i] is set to \c val[i]. The
+      //! weights are only used if the reduction ordering is
+      //! policy::order::weighted_shortlex.
+      //!
+      //! \param val the weights.
+      //!
+      //! \returns
+      //! A reference to \c *this.
+      //!
+      //! \throws LibsemigroupsException if the alphabet has not been set, if
+      //! \c val.size() is not the size of the alphabet, if any value in \p val
+      //! is \c 0, or if any rules have been added to \c this.
+      //!
+      //! \complexity
+      //! Linear in \c val.size().
+      //!
+      //! \sa KnuthBendix::order(policy::order).
+      KnuthBendix& weights(std::vector<size_t> const& val);
+
+      //! Returns the weights of the letters.
+      //!
+      //! \returns
+      //! A const reference to a \c std::vector<size_t>.
+      //!
+      //! \exceptions
+      //! \noexcept
+      //!
+      //! \par Parameters
+      //! (None)
+      std::vector<size_t> const& weights() const noexcept {
+        return _settings._weights;
+      }
+
       //////////////////////////////////////////////////////////////////////////
       // KnuthBendix - member functions for rules and rewriting - public
       //////////////////////////////////////////////////////////////////////////
@@ -265,14 +425,47 @@ namespace libsemigroups {
       //! (None)
       size_t nr_active_rules() const noexcept;
 
+      //! Returns the total number of rules discarded because the memory
+      //! used exceeded KnuthBendix::max_memory.
+      //!
+      //! \returns
+      //! A value of type `size_t`.
+      //!
+      //! \exceptions
+      //! \noexcept
+      //!
+      //! \complexity
+      //! Constant.
+      //!
+      //! \par Parameters
+      //! (None)
+      //!
+      //! \sa KnuthBendix::policy::prune::longest_rules.
+      size_t nr_discarded_rules() const noexcept;
+
+      //! Returns an estimate of the number of bytes used by the rules.
+      //!
+      //! This is the value compared with KnuthBendix::max_memory and
+      //! Runner::memory_limit, and includes the active rules, the inactive
+      //! rules, and the rules waiting to be processed.
+      //!
+      //! \returns
+      //! A value of type `size_t`.
+      //!
+      //! \complexity
+      //! Linear in the number of rules.
+      //!
+      //! \par Parameters
+      //! (None)
+      size_t memory_used() const override;
+
       //! Returns a copy of the active rules of the KnuthBendix instance.
       //!
       //! This member function returns a vector consisting of the pairs of
       //! strings which represent the rules of the KnuthBendix instance. The \c
       //! first entry in every such pair is greater than the \c second according
       //! to the reduction ordering of the KnuthBendix instance. The rules are
-      //! sorted according to the reduction ordering used by the rewriting
-      //! system, on the first entry.
+      //! sorted according to the short-lex ordering on the first entry.
       //!
       //! \returns
       //! A copy of the currently active rules, a value of type
@@ -323,6 +516,58 @@ namespace libsemigroups {
       //! the system are represented in the output.
       friend std::ostream& operator<<(std::ostream&, KnuthBendix const&);
 
+      //! Write \c this to a stream in a compact binary format.
+      //!
+      //! The alphabet, the settings (including the overlap policy and the
+      //! reduction ordering), and the active rules of \c this are written to
+      //! \p os, so that they can later be read back by load(). The defining
+      //! rules of \c this are not written.
+      //!
+      //! \param os the stream to write to.
+      //!
+      //! \returns
+      //! (None)
+      //!
+      //! \throws LibsemigroupsException if \c this is not confluent, or
+      //! writing to \p os fails.
+      //!
+      //! \complexity
+      //! \f$O(n)\f$ where \f$n\f$ is the sum of the lengths of the words
+      //! in the active rules (assuming that confluent() is already known).
+      //!
+      //! \sa load().
+      void save(std::ostream& os) const;
+
+      //! Read a KnuthBendix previously written by save().
+      //!
+      //! This function sets the alphabet and settings of \c this, and sets
+      //! the active rules of \c this to be the rules read from \p is. The
+      //! rules are added directly to the active rules, without running the
+      //! Knuth-Bendix procedure, and \c this is marked as confluent. The
+      //! defining rules of \c this are not modified.
+      //!
+      //! \param is the stream to read from.
+      //!
+      //! \returns
+      //! (None)
+      //!
+      //! \throws LibsemigroupsException if the alphabet of \c this has
+      //! already been set, or \p is does not contain valid data written by
+      //! save(), for example, if the rules read are not reduced. In this
+      //! case \c this is not modified.
+      //!
+      //! \complexity
+      //! \f$O(n\log m)\f$ where \f$n\f$ is the sum of the lengths of the
+      //! words in the rules read, and \f$m\f$ is the number of such rules.
+      //!
+      //! \warning The rules read from \p is are assumed to be the active
+      //! rules of a confluent KnuthBendix, as written by save(). It is
+      //! verified that the rules are reduced, but not that they are
+      //! confluent.
+      //!
+      //! \sa save().
+      void load(std::istream& is);
+
       //////////////////////////////////////////////////////////////////////////
       // KnuthBendix - main member functions - public
       //////////////////////////////////////////////////////////////////////////
@@ -435,16 +680,25 @@ namespace libsemigroups {
 
       bool validate_identity_impl(std::string const&) const override;
 
+      std::vector<std::string>
+      normal_forms_impl(std::vector<std::string> const&) override;
+      std::vector<word_type>
+      normal_forms_impl(std::vector<word_type> const&) override;
+
       //////////////////////////////////////////////////////////////////////////
       // KnuthBendix - data - private
       //////////////////////////////////////////////////////////////////////////
 
       struct Settings {
         Settings();
-        size_t          _check_confluence_interval;
-        size_t          _max_overlap;
-        size_t          _max_rules;
-        policy::overlap _overlap_policy;
+        size_t              _check_confluence_interval;
+        size_t              _max_memory;
+        size_t              _max_overlap;
+        size_t              _max_rules;
+        policy::order       _order;
+        policy::overlap     _overlap_policy;
+        policy::prune       _prune_policy;
+        std::vector<size_t> _weights;
       } _settings;
 
       class KnuthBendixImpl;  // Forward declaration
@@ -571,10 +825,23 @@ namespace libsemigroups {
       fpsemigroup::KnuthBendix& knuth_bendix() const {
         return *_kb;
       }
+
+      //! Returns fpsemigroup::KnuthBendix::memory_used for the underlying
+      //! fpsemigroup::KnuthBendix.
+      //!
+      //! \complexity
+      //! Linear in the number of rules.
+      //!
+      //! \par Parameters
+      //! (None)
+      size_t memory_used() const override {
+        return _kb->memory_used();
+      }
       ////////////////////////////////////////////////////////////////////////////
       // CongruenceInterface - non-pure virtual member functions - public
       ////////////////////////////////////////////////////////////////////////////
 
+      using CongruenceInterface::contains;
       tril const_contains(word_type const&, word_type const&) const override;
       bool contains(word_type const&, word_type const&) override;
 
@@ -0,0 +1,94 @@
+//
+// libsemigroups - C++ library for semigroups and monoids
+// Copyright (C) 2019 James D. Mitchell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// This file contains a helper function for applying a function to disjoint
+// blocks of a range of indices in parallel, using the threads in
+// detail::thread_pool().
+
+#ifndef LIBSEMIGROUPS_INCLUDE_PARALLEL_HPP_
+#define LIBSEMIGROUPS_INCLUDE_PARALLEL_HPP_
+
+#include <algorithm>  // for min
+#include <cstddef>    // for size_t
+#include <exception>  // for exception_ptr, current_exception, rethrow_exception
+#include <vector>     // for vector
+
+#include "libsemigroups-debug.hpp"  // for LIBSEMIGROUPS_ASSERT
+#include "thread-pool.hpp"          // for TaskGroup
+
+namespace libsemigroups {
+  namespace detail {
+    // Calls func(first, last) for disjoint blocks [first, last) covering
+    // [0, n) using at most max_threads blocks, such that every block has
+    // length at least min_block (unless n < min_block, in which case there is
+    // one block). The calling thread processes the last block, and the others
+    // are tasks on detail::thread_pool(). The blocks have (almost) equal size,
+    // and func must be safe to call concurrently on disjoint blocks. If func
+    // throws for any block, then the exception thrown for the left-most such
+    // block is rethrown in the calling thread after all the blocks have been
+    // processed.
+    template <typename TFunc>
+    void parallel_for(size_t  n,
+                      size_t  max_threads,
+                      size_t  min_block,
+                      TFunc&& func) {
+      if (n == 0) {
+        return;
+      }
+      size_t nr_threads = n / std::max(size_t(1), min_block);
+      nr_threads = std::max(size_t(1), std::min(nr_threads, max_threads));
+      if (nr_threads == 1) {
+        func(size_t(0), n);
+        return;
+      }
+      std::vector<std::exception_ptr> errors(nr_threads, nullptr);
+      auto thread_func = [&func, &errors](size_t i, size_t first, size_t last) {
+        try {
+          func(first, last);
+        } catch (...) {
+          errors[i] = std::current_exception();
+        }
+      };
+
+      size_t const block = n / nr_threads;
+      size_t const extra = n % nr_threads;
+      TaskGroup    tg;
+      size_t       first = 0;
+      for (size_t i = 0; i < nr_threads; ++i) {
+        size_t last = first + block + (i < extra ? 1 : 0);
+        if (i == nr_threads - 1) {
+          LIBSEMIGROUPS_ASSERT(last == n);
+          // The calling thread does the final block
+          thread_func(i, first, last);
+        } else {
+          tg.run([&thread_func, i, first, last]() {
+            thread_func(i, first, last);
+          });
+        }
+        first = last;
+      }
+      tg.wait();
+      for (auto const& e : errors) {
+        if (e != nullptr) {
+          std::rethrow_exception(e);
+        }
+      }
+    }
+  }  // namespace detail
+}  // namespace libsemigroups
+#endif  // LIBSEMIGROUPS_INCLUDE_PARALLEL_HPP_
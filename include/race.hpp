@@ -27,18 +27,21 @@
 #ifndef LIBSEMIGROUPS_INCLUDE_RACE_HPP_
 #define LIBSEMIGROUPS_INCLUDE_RACE_HPP_
 
-#include <chrono>   // for nanoseconds
-#include <cstddef>  // for size_t
-#include <memory>   // for std::shared_ptr
-#include <thread>   // for mutex
-#include <vector>   // for vector
+#include <chrono>         // for nanoseconds
+#include <cstddef>        // for size_t
+#include <memory>         // for std::shared_ptr
+#include <mutex>          // for mutex
+#include <string>         // for string
+#include <thread>         // for mutex
+#include <unordered_map>  // for unordered_map
+#include <vector>         // for vector
 
+#include "blackboard.hpp"               // for Blackboard
+#include "constants.hpp"                // for UNDEFINED
 #include "libsemigroups-debug.hpp"      // for LIBSEMIGROUPS_ASSERT
 #include "libsemigroups-exception.hpp"  // for LIBSEMIGROUPS_EXCEPTION
-#include "report.hpp"                   // for REPORT_DEFAULT, REPORT_TIME
 #include "runner.hpp"                   // for Runner
 #include "stl.hpp"                      // for IsCallable
-#include "timer.hpp"                    // for Timer
 
 namespace libsemigroups {
   namespace detail {
@@ -49,9 +52,18 @@ namespace libsemigroups {
       Race();
       Race(Race const& other) : Race() {
         // Can't use = default because std::mutex is non-copyable.
-        _runners     = other._runners;
-        _max_threads = other._max_threads;
-        _winner      = other._winner;
+        _runners         = other._runners;
+        _max_threads     = other._max_threads;
+        _winner          = other._winner;
+        _cooperative     = other._cooperative;
+        _blackboard      = other._blackboard;
+        _stop_latency    = other._stop_latency;
+        _order           = other._order;
+        _initial_runners = other._initial_runners;
+        _next_stage      = other._next_stage;
+        _nr_started      = other._nr_started;
+        _stage_interval  = other._stage_interval;
+        _winner_index    = other._winner_index;
       }
 
       Race(Race&&)  = delete;
@@ -71,6 +83,68 @@ namespace libsemigroups {
         return _max_threads;
       }
 
+      // Set whether or not the runners share information. If val is true,
+      // then whenever the race is run in more than one thread, every runner
+      // is given the same Blackboard, on which they can publish the pairs of
+      // words they discover are equal, and from which they can consume the
+      // pairs discovered by the others. The default is false.
+      Race& cooperative(bool val) noexcept {
+        _cooperative = val;
+        return *this;
+      }
+
+      bool cooperative() const noexcept {
+        return _cooperative;
+      }
+
+      // Set the order in which the runners are started when the race is run
+      // in more than one thread, val must be a permutation of the indices of
+      // the runners. By default, the runners are started in the order they
+      // were added. Throws if val is not a permutation, or the race has
+      // already started some runners.
+      Race& start_order(std::vector<size_t> const& val);
+
+      // Set the number of runners that are started at first, when the race is
+      // run in more than one thread. If none of these finishes within the
+      // stage interval, then the next runner (in the start order) is
+      // started, and so on, until at most max_threads() runners have been
+      // started. The default is to start max_threads() runners at once.
+      Race& initial_runners(size_t val) noexcept {
+        LIBSEMIGROUPS_ASSERT(val != 0);
+        _initial_runners = val;
+        return *this;
+      }
+
+      size_t initial_runners() const noexcept {
+        return _initial_runners;
+      }
+
+      // Set the time after which a further runner is started, if
+      // initial_runners() is less than max_threads() and no runner has
+      // finished.
+      Race& stage_interval(std::chrono::nanoseconds val) noexcept {
+        _stage_interval = val;
+        return *this;
+      }
+
+      std::chrono::nanoseconds stage_interval() const noexcept {
+        return _stage_interval;
+      }
+
+      // Set the memory limit and the CPU time limit of every runner (see
+      // Runner::memory_limit and Runner::cpu_time_limit). A runner that
+      // exceeds either is dropped from the race, and the others carry on. If
+      // every runner is dropped, then run throws.
+      Race& budget(size_t                   memory_limit,
+                   std::chrono::nanoseconds cpu_time_limit);
+
+      // Returns the Blackboard shared by the runners, or nullptr if the race
+      // is not cooperative, has not been run in more than one thread, or is
+      // over.
+      std::shared_ptr<Blackboard> const& blackboard() const noexcept {
+        return _blackboard;
+      }
+
       // Runs the method Runner::run on every Runner in the Race, and returns
       // the one that finishes first. The losers are deleted.
       std::shared_ptr<Runner> winner() {
@@ -82,6 +156,22 @@ namespace libsemigroups {
         return _winner != nullptr;
       }
 
+      // Returns the index of the winner among the runners, in the order they
+      // were added, or UNDEFINED if the race is not over.
+      size_t winner_index() const noexcept {
+        return _winner_index;
+      }
+
+      // Returns the longest time between the winner finishing and one of the
+      // losers that was running at that moment returning from Runner::run_for,
+      // the last time that the race was run in more than one thread. Since
+      // the race waits for the losers before returning, this is how long a
+      // winning race is delayed by losers that do not notice promptly that
+      // they have been killed.
+      std::chrono::nanoseconds stop_latency() const noexcept {
+        return _stop_latency;
+      }
+
       // Adds a Runner to the race, throws if the race is already over.
       void add_runner(std::shared_ptr<Runner>);
 
@@ -171,105 +261,75 @@ namespace libsemigroups {
       }
 
      private:
-      // Runs the callable object \p func on every Runner in parallel.
-      template <typename TCallable>
-      void run_func(TCallable const& func) {
-        static_assert(std::is_same<typename std::result_of<TCallable(
-                                       std::shared_ptr<Runner>)>::type,
-                                   void>::value,
-                      "the template parameter TCallable must be void");
-        LIBSEMIGROUPS_ASSERT(!empty());
-        if (_winner == nullptr) {
-          size_t nr_threads = std::min(_runners.size(), _max_threads);
-          if (nr_threads == 1) {
-            REPORT_DEFAULT("using 0 additional threads\n");
-            detail::Timer tmr;
-            func(_runners.at(0));
-            _winner = _runners.at(0);
-            REPORT_TIME(tmr);
-            return;
-          }
-          for (size_t i = 0; i < _runners.size(); ++i) {
-            if (_runners[i]->finished()) {
-              REPORT_DEFAULT("using 0 additional threads\n");
-              _winner = _runners[i];
-              REPORT_DEFAULT("#%d is already finished!\n", i);
-              return;
-            }
-          }
+      // Runs every Runner for (approximately) the specified amount of time,
+      // or until one of them finishes if this is FOREVER. If the race uses
+      // more than one thread, then every Runner is run for a sequence of time
+      // slices, each of which is a task on the thread_pool(), so that there
+      // can be more runners than threads in the pool.
+      void run_func(std::chrono::nanoseconds);
 
-          std::vector<std::thread::id> tids(_runners.size(),
-                                            std::this_thread::get_id());
-
-          REPORT_DEFAULT("using %d / %d additional threads\n",
-                         nr_threads,
-                         std::thread::hardware_concurrency());
-          detail::Timer tmr;
-          LIBSEMIGROUPS_ASSERT(nr_threads != 0);
-
-          auto thread_func = [this, &func, &tids](size_t pos) {
-            tids[pos] = std::this_thread::get_id();
-            try {
-              func(_runners.at(pos));
-            } catch (std::exception const& e) {
-              size_t tid = THREAD_ID_MANAGER.tid(tids[pos]);
-              REPORT_DEFAULT("exception thrown by #%d:\n%s\n", tid, e.what());
-              return;
-            }
-            // Stop two Runner* objects from killing each other
-            {
-              std::lock_guard<std::mutex> lg(_mtx);
-              if (_runners.at(pos)->finished()) {
-                for (auto it = _runners.begin(); it < _runners.begin() + pos;
-                     it++) {
-                  (*it)->kill();
-                }
-                for (auto it = _runners.begin() + pos + 1; it < _runners.end();
-                     it++) {
-                  (*it)->kill();
-                }
-              }
-            }
-          };
-
-          THREAD_ID_MANAGER.reset();
-
-          std::vector<std::thread> t;
-          for (size_t i = 0; i < nr_threads; ++i) {
-            t.push_back(std::thread(thread_func, i));
-          }
-          for (size_t i = 0; i < nr_threads; ++i) {
-            t.at(i).join();
-          }
-          REPORT_TIME(tmr);
-          for (auto method = _runners.begin(); method < _runners.end();
-               ++method) {
-            if ((*method)->finished()) {
-              LIBSEMIGROUPS_ASSERT(_winner == nullptr);
-              _winner = *method;
-              size_t tid
-                  = THREAD_ID_MANAGER.tid(tids.at(method - _runners.begin()));
-              REPORT_DEFAULT("#%d is the winner!\n", tid);
-              break;
-            }
-          }
-          if (_winner != nullptr) {
-            for (auto rnnr : _runners) {
-              if (rnnr != _winner) {
-                rnnr.reset();
-              }
-            }
-            _runners.clear();
-            _runners.push_back(_winner);
-          }
-        }
-      }
+      std::shared_ptr<Blackboard>                    _blackboard;
+      bool                                           _cooperative;
+      size_t                                         _initial_runners;
+      std::vector<std::shared_ptr<Runner>>           _runners;
+      size_t                                         _max_threads;
+      std::mutex                                     _mtx;
+      std::chrono::high_resolution_clock::time_point _next_stage;
+      size_t                                         _nr_started;
+      std::vector<size_t>                            _order;
+      std::chrono::nanoseconds                       _stage_interval;
+      std::chrono::nanoseconds                       _stop_latency;
+      std::shared_ptr<Runner>                        _winner;
+      size_t                                         _winner_index;
+    };
 
-      std::vector<std::shared_ptr<Runner>> _runners;
-      size_t                               _max_threads;
-      std::mutex                           _mtx;
-      std::shared_ptr<Runner>              _winner;
+    // A RaceHistory records, for each of a number of keys describing some
+    // features of a problem, how often each runner won a race to solve a
+    // problem with those features. The runners are identified by their
+    // index in the race, and so the key should determine which runners were
+    // in the race. This is used to start the runners that are most likely to
+    // win first (see Race::start_order and Race::initial_runners).
+    //
+    // All of the member functions are thread-safe.
+    class RaceHistory final {
+     public:
+      RaceHistory() : _mtx(), _wins() {}
+
+      RaceHistory(RaceHistory const&) = delete;
+      RaceHistory(RaceHistory&&)      = delete;
+      RaceHistory& operator=(RaceHistory const&) = delete;
+      RaceHistory& operator=(RaceHistory&&) = delete;
+
+      ~RaceHistory() = default;
+
+      // Records that the runner with index i won a race for key.
+      void add_win(std::string const& key, size_t i);
+
+      // Returns the number of wins of the runner with index i for key.
+      size_t nr_wins(std::string const& key, size_t i) const;
+
+      // Returns the number of distinct runners that have won for key.
+      size_t nr_winners(std::string const& key) const;
+
+      // Returns the indices 0, ..., nr_runners - 1 sorted by decreasing
+      // number of wins for key, runners with the same number of wins are in
+      // increasing order of index.
+      std::vector<size_t> order(std::string const& key,
+                                size_t             nr_runners) const;
+
+      // Returns the number of keys with at least one win.
+      size_t size() const;
+
+      void clear();
+
+     private:
+      mutable std::mutex                                   _mtx;
+      std::unordered_map<std::string, std::vector<size_t>> _wins;
     };
+
+    // Returns the RaceHistory shared by every object in libsemigroups that
+    // starts its runners adaptively.
+    RaceHistory& race_history();
   }  // namespace detail
 }  // namespace libsemigroups
 
@@ -74,44 +74,32 @@ namespace libsemigroups {
 
   namespace detail {
 
+    // The thread id of the main thread is 0, and the i-th worker of
+    // thread_pool() always has thread id i + 1, so that the ids of the threads
+    // in the pool never change, even when several computations are running
+    // in the pool at once. Any other thread is given the least unused id,
+    // which is returned to the manager when the thread exits.
     class ThreadIdManager final {
      public:
-      ThreadIdManager() : _mtx(), _next_tid(0), _thread_map() {
-        tid(std::this_thread::get_id());
-      }
+      ThreadIdManager()
+          : _free_tids(),
+            _mtx(),
+            _next_tid(0),
+            _thread_map({{std::this_thread::get_id(), 0}}) {}
 
       ThreadIdManager(ThreadIdManager const&) = delete;
       ThreadIdManager(ThreadIdManager&&)      = delete;
       ThreadIdManager& operator=(ThreadIdManager const&) = delete;
       ThreadIdManager& operator=(ThreadIdManager&&) = delete;
 
-      void reset() {
-        // Only do this from the main thread
-        LIBSEMIGROUPS_ASSERT(tid(std::this_thread::get_id()) == 0);
-        // Delete all thread_ids
-        _thread_map.clear();
-        _next_tid = 0;
-        // Reinsert the main thread's id
-        tid(std::this_thread::get_id());
-      }
+      size_t tid(std::thread::id t);
 
-      size_t tid(std::thread::id t) {
-        std::lock_guard<std::mutex> lg(_mtx);
-        auto                        it = _thread_map.find(t);
-        if (it != _thread_map.end()) {
-          return (*it).second;
-        } else {
-          // Don't check the assert below because on a single thread machine
-          // (such as those used by appveyor), for an fp-semigroup more than 1
-          // thread will be used, and this assertion will fail.
-          // LIBSEMIGROUPS_ASSERT(_next_tid <=
-          // std::thread::hardware_concurrency());
-          _thread_map.emplace(t, _next_tid++);
-          return _next_tid - 1;
-        }
-      }
+      // Called when the thread with id t, which is not a worker of
+      // thread_pool(), exits.
+      void release(std::thread::id t);
 
      private:
+      std::vector<size_t>                         _free_tids;
       std::mutex                                  _mtx;
       size_t                                      _next_tid;
       std::unordered_map<std::thread::id, size_t> _thread_map;
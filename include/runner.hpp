@@ -25,10 +25,17 @@
 
 #include <atomic>       // for atomic
 #include <chrono>       // for nanoseconds, high_resolution_clock
+#include <cstddef>      // for size_t
+#include <memory>       // for shared_ptr
+#include <thread>       // for thread::id
 #include <type_traits>  // for forward
+#include <vector>       // for vector
 
+#include "blackboard.hpp"               // for Blackboard
+#include "constants.hpp"                // for POSITIVE_INFINITY
 #include "function-ref.hpp"             // for FunctionRef
 #include "libsemigroups-exception.hpp"  // for LibsemigroupsException
+#include "types.hpp"                    // for word_type, relation_type
 
 namespace libsemigroups {
   //! A pseudonym for std::chrono::nanoseconds::max().
@@ -50,6 +57,8 @@ namespace libsemigroups {
   //! Runner::stopped for any reason?
   //! * permit the Runner::run implementation to be killed from another thread
   //! (Runner::kill).
+  //! * stopping if the memory used, or the CPU time used, exceeds a limit
+  //! (Runner::memory_limit and Runner::cpu_time_limit).
   //!
   //! The implementation of the ``run_impl`` member function in a derived class
   //! must periodically check whether or not it has stopped for this to work.
@@ -61,9 +70,11 @@ namespace libsemigroups {
       running_for          = 2,
       running_until        = 3,
       timed_out            = 4,
-      stopped_by_predicate = 6,
-      not_running          = 7,
-      dead                 = 8
+      over_memory_limit    = 5,
+      over_cpu_time_limit  = 6,
+      stopped_by_predicate = 7,
+      not_running          = 8,
+      dead                 = 9
     };
 
    public:
@@ -90,12 +101,18 @@ namespace libsemigroups {
     //!
     //! \param copy the Runner to copy.
     Runner(Runner const& other) : Runner() {
-      _state = other._state.load();
+      _cpu_time       = other._cpu_time.load();
+      _cpu_time_limit = other._cpu_time_limit;
+      _memory_limit   = other._memory_limit;
+      _state          = other._state.load();
     }
 
     //!
     Runner(Runner&& other) : Runner() {
-      _state = other._state.load();
+      _cpu_time       = other._cpu_time.load();
+      _cpu_time_limit = other._cpu_time_limit;
+      _memory_limit   = other._memory_limit;
+      _state          = other._state.load();
     }
 
     //! Deleted.
@@ -121,12 +138,13 @@ namespace libsemigroups {
     //!
     //! \par Parameters
     //! (None)
-    // At the end of this either finished, or dead.
+    // At the end of this either finished, dead, or over budget.
     void run() {
       if (!finished() && !dead()) {
         before_run();
         set_state(state::running_to_finish);
         try {
+          BudgetGuard bg(*this);
           run_impl();
         } catch (LibsemigroupsException const& e) {
           if (!dead()) {
@@ -135,7 +153,11 @@ namespace libsemigroups {
           throw;
         }
         if (!dead()) {
-          set_state(state::not_running);
+          state stt = over_budget_state(state::not_running);
+          if (stt != state::not_running && finished_impl()) {
+            stt = state::not_running;
+          }
+          set_state(stt);
         }
       }
     }
@@ -202,7 +224,8 @@ namespace libsemigroups {
     //!
     //! \returns
     //! (None)
-    // At the end of this either finished, dead, or stopped_by_predicate.
+    // At the end of this either finished, dead, over budget, or
+    // stopped_by_predicate.
     template <typename T>
     void run_until(T&& func) {
       if (!finished() && !dead()) {
@@ -210,10 +233,19 @@ namespace libsemigroups {
         _stopper = std::forward<T>(func);
         if (!_stopper()) {
           set_state(state::running_until);
-          run_impl();
+          try {
+            BudgetGuard bg(*this);
+            run_impl();
+          } catch (LibsemigroupsException const& e) {
+            if (!dead()) {
+              set_state(state::not_running);
+            }
+            _stopper.invalidate();
+            throw;
+          }
           if (!finished()) {
             if (!dead()) {
-              set_state(state::stopped_by_predicate);
+              set_state(over_budget_state(state::stopped_by_predicate));
             }
           } else {
             set_state(state::not_running);
@@ -274,7 +306,8 @@ namespace libsemigroups {
     //! Report why Runner::run stopped.
     //!
     //! Reports whether Runner::run was stopped because it is Runner::finished,
-    //! Runner::timed_out, or Runner::dead.
+    //! Runner::timed_out, Runner::dead, Runner::over_memory_limit, or
+    //! Runner::over_cpu_time_limit.
     //!
     //! \par Parameters
     //! (None)
@@ -385,7 +418,8 @@ namespace libsemigroups {
     //!
     //! This function can be used to check whether or not Runner::run has been
     //! stopped for whatever reason. In other words, it checks if
-    //! Runner::timed_out, Runner::finished, or Runner::dead.
+    //! Runner::timed_out, Runner::finished, Runner::dead,
+    //! Runner::over_memory_limit, or Runner::over_cpu_time_limit.
     //!
     //! \returns
     //! A ``bool``.
@@ -393,8 +427,9 @@ namespace libsemigroups {
     //! \par Parameters
     //! (None)
     bool stopped() const {
-      return (running() ? (timed_out() || stopped_by_predicate())
-                        : get_state() > state::running_until);
+      return (running()
+                  ? (timed_out() || stopped_by_predicate() || over_budget())
+                  : get_state() > state::running_until);
     }
 
     //! Check if the runner was, or should, stop because the nullary predicate
@@ -426,6 +461,213 @@ namespace libsemigroups {
       }
     }
 
+    //! Set the memory limit.
+    //!
+    //! If Runner::memory_used exceeds \p val while \c this is running, then
+    //! \c this stops, and Runner::over_memory_limit returns \c true. This is
+    //! a soft limit: the memory used is only estimated periodically, and so
+    //! it can exceed \p val for a short time.
+    //!
+    //! By default this value is libsemigroups::POSITIVE_INFINITY.
+    //!
+    //! \param val the maximum number of bytes.
+    //!
+    //! \returns
+    //! (None)
+    //!
+    //! \exceptions
+    //! \noexcept
+    void memory_limit(size_t val) noexcept {
+      _memory_limit = val;
+    }
+
+    //! Returns the memory limit.
+    //!
+    //! \returns
+    //! A value of type \c size_t.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \par Parameters
+    //! (None)
+    //!
+    //! \sa Runner::memory_limit(size_t)
+    size_t memory_limit() const noexcept {
+      return _memory_limit;
+    }
+
+    //! Set the CPU time limit.
+    //!
+    //! If Runner::cpu_time exceeds \p val while \c this is running, then
+    //! \c this stops, and Runner::over_cpu_time_limit returns \c true. The
+    //! CPU time is only checked occasionally, and it can include the CPU time
+    //! used by other tasks (see Runner::cpu_time), and so the limit is
+    //! approximate.
+    //!
+    //! By default this value is libsemigroups::FOREVER.
+    //!
+    //! \param val the maximum CPU time.
+    //!
+    //! \returns
+    //! (None)
+    //!
+    //! \exceptions
+    //! \noexcept
+    void cpu_time_limit(std::chrono::nanoseconds val) noexcept {
+      _cpu_time_limit = val;
+    }
+
+    //! Returns the CPU time limit.
+    //!
+    //! \returns
+    //! A value of type \c std::chrono::nanoseconds.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \par Parameters
+    //! (None)
+    //!
+    //! \sa Runner::cpu_time_limit(std::chrono::nanoseconds)
+    std::chrono::nanoseconds cpu_time_limit() const noexcept {
+      return _cpu_time_limit;
+    }
+
+    //! Returns the CPU time used so far.
+    //!
+    //! This is the total CPU time used by the threads that called
+    //! Runner::run, Runner::run_for, and Runner::run_until, while they were
+    //! running \c this. The CPU time used by any other threads started by
+    //! \c this is not included. If \c this is running, and this function is
+    //! called by a thread other than the one running \c this, then the CPU
+    //! time used since \c this last started running is not included.
+    //!
+    //! A thread running \c this that waits for tasks in the thread pool used
+    //! by libsemigroups to finish might run other tasks, which need not
+    //! belong to \c this, while it waits, and the CPU time used by these
+    //! tasks is included. Hence this value, and the CPU time limit, are only
+    //! approximate if \c this runs tasks in parallel, or if it is run by a
+    //! Race.
+    //!
+    //! \returns
+    //! A value of type \c std::chrono::nanoseconds.
+    //!
+    //! \par Parameters
+    //! (None)
+    std::chrono::nanoseconds cpu_time() const;
+
+    //! Returns an estimate of the number of bytes used by \c this.
+    //!
+    //! This is the value compared with Runner::memory_limit. A derived class
+    //! of Runner that can estimate the memory used by its data structures
+    //! should override this function, the default implementation returns 0.
+    //! This function is only called periodically while \c this is running,
+    //! and so it does not have to be constant time.
+    //!
+    //! \returns
+    //! A value of type \c size_t.
+    //!
+    //! \par Parameters
+    //! (None)
+    virtual size_t memory_used() const {
+      return 0;
+    }
+
+    //! Check if the runner was, or should, stop because it used too much
+    //! memory.
+    //!
+    //! \returns
+    //! \c true if \c this is running and Runner::memory_used exceeded
+    //! Runner::memory_limit, or if \c this is not running and was stopped
+    //! for this reason the last time it was running.
+    //!
+    //! \par Parameters
+    //! (None)
+    bool over_memory_limit() const {
+      return (running() ? over_budget() && _over_memory_limit
+                        : get_state() == state::over_memory_limit);
+    }
+
+    //! Check if the runner was, or should, stop because it used too much CPU
+    //! time.
+    //!
+    //! \returns
+    //! \c true if \c this is running and Runner::cpu_time exceeded
+    //! Runner::cpu_time_limit, or if \c this is not running and was stopped
+    //! for this reason the last time it was running.
+    //!
+    //! \par Parameters
+    //! (None)
+    bool over_cpu_time_limit() const {
+      return (running() ? over_budget() && _over_cpu_time_limit
+                        : get_state() == state::over_cpu_time_limit);
+    }
+
+    //! Set the blackboard used to share information with other runners.
+    //!
+    //! This function is used by a cooperative race to give every one of its
+    //! runners the same blackboard. A derived class of Runner can publish the
+    //! pairs of words that it knows to be equal on the blackboard (using
+    //! Runner::publish_pair), and consume those published by the other
+    //! runners (using Runner::consume_pairs). If \p bb is \c nullptr, then
+    //! nothing is shared.
+    //!
+    //! \param bb the blackboard.
+    //!
+    //! \returns
+    //! (None)
+    //!
+    //! \exceptions
+    //! \noexcept
+    void blackboard(std::shared_ptr<detail::Blackboard> bb) noexcept {
+      if (bb != _blackboard) {
+        _blackboard     = std::move(bb);
+        _blackboard_pos = 0;
+      }
+    }
+
+    //! Returns the blackboard used to share information with other runners.
+    //!
+    //! \returns
+    //! A ``std::shared_ptr<detail::Blackboard>``, which is \c nullptr if no
+    //! blackboard has been set.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \par Parameters
+    //! (None)
+    std::shared_ptr<detail::Blackboard> const& blackboard() const noexcept {
+      return _blackboard;
+    }
+
+   protected:
+    ////////////////////////////////////////////////////////////////////////
+    // Runner - member functions for sharing - protected
+    ////////////////////////////////////////////////////////////////////////
+
+    // Returns true if there is a blackboard, and it is not full, i.e. if it
+    // is worth computing something to publish.
+    bool can_publish() const noexcept {
+      return _blackboard != nullptr && !_blackboard->full();
+    }
+
+    // Publishes the pair (u, v), which must hold in whatever object all of
+    // the runners sharing the blackboard are computing.
+    void publish_pair(word_type const& u, word_type const& v) {
+      if (_blackboard != nullptr) {
+        _blackboard->publish(this, u, v);
+      }
+    }
+
+    // Appends to out the pairs published by the other runners since the last
+    // call to this function, and returns true if there were any.
+    bool consume_pairs(std::vector<relation_type>& out) {
+      return _blackboard != nullptr
+             && _blackboard->consume(this, _blackboard_pos, out);
+    }
+
    private:
     bool running_for() const noexcept {
       return _state == state::running_for;
@@ -439,6 +681,51 @@ namespace libsemigroups {
     virtual bool finished_impl() const = 0;
     virtual void before_run() {}
 
+    // Returns true if this has exceeded its memory or CPU time limit. This
+    // is called by stopped, and so it must be cheap, the limits are only
+    // checked occasionally (see runner.cpp).
+    bool over_budget() const {
+      return (_over_memory_limit || _over_cpu_time_limit)
+             || ((_memory_limit != POSITIVE_INFINITY
+                  || _cpu_time_limit != FOREVER)
+                 && check_budget());
+    }
+
+    bool check_budget() const;
+    void start_budget();
+    void stop_budget();
+
+    // Starts the budget of a Runner when constructed, and stops it when
+    // destroyed, so that the CPU time used is recorded even if run_impl
+    // throws.
+    class BudgetGuard final {
+     public:
+      explicit BudgetGuard(Runner& runner) : _runner(runner) {
+        _runner.start_budget();
+      }
+
+      BudgetGuard(BudgetGuard const&) = delete;
+      BudgetGuard& operator=(BudgetGuard const&) = delete;
+
+      ~BudgetGuard() {
+        _runner.stop_budget();
+      }
+
+     private:
+      Runner& _runner;
+    };
+
+    // Returns the state that this should be in after run_impl returns
+    // without finishing: stt, unless this exceeded its budget.
+    state over_budget_state(state stt) const noexcept {
+      if (_over_memory_limit) {
+        return state::over_memory_limit;
+      } else if (_over_cpu_time_limit) {
+        return state::over_cpu_time_limit;
+      }
+      return stt;
+    }
+
     state get_state() const noexcept {
       return _state;
     }
@@ -456,12 +743,86 @@ namespace libsemigroups {
     // Runner - data - private
     ////////////////////////////////////////////////////////////////////////
 
+    std::shared_ptr<detail::Blackboard>   _blackboard;
+    size_t                                _blackboard_pos;
+    std::chrono::nanoseconds              _cpu_start;
+    std::atomic<std::thread::id>          _cpu_thread;
+    std::atomic<std::chrono::nanoseconds> _cpu_time;
+    std::chrono::nanoseconds              _cpu_time_limit;
     mutable std::chrono::high_resolution_clock::time_point _last_report;
+    size_t                                                 _memory_limit;
+    mutable std::atomic<std::chrono::high_resolution_clock::time_point>
+                                                   _next_budget_check;
+    mutable std::atomic<bool>                      _over_cpu_time_limit;
+    mutable std::atomic<bool>                      _over_memory_limit;
     std::chrono::nanoseconds                       _report_time_interval;
     std::chrono::nanoseconds                       _run_for;
     std::chrono::high_resolution_clock::time_point _start_time;
     mutable std::atomic<state>                     _state;
     detail::FunctionRef<bool(void)>                _stopper;
   };
+
+  namespace detail {
+    // A CancellationToken is used in a long loop to check whether the
+    // Runner that the loop belongs to has been cancelled, i.e. killed, for
+    // example because it lost a Race. The Runner is only consulted every
+    // interval calls, so that calling the token in every iteration of the
+    // loop is cheap, and the loop stops within interval iterations of the
+    // Runner being killed. Once a token reports that the Runner has been
+    // cancelled, it keeps doing so.
+    //
+    // Calling the token only checks Runner::dead, and so, unlike
+    // Runner::stopped, it can be used in any thread, and in loops that run
+    // when the Runner is not running (such as those that compute something
+    // from the output of Runner::run). The member function
+    // CancellationToken::stopped also checks Runner::stopped while the
+    // Runner is running, and must only be called by the thread running it.
+    //
+    // Every loop (and every thread) should have its own token.
+    class CancellationToken final {
+     public:
+      explicit CancellationToken(Runner const& runner,
+                                 size_t        interval = 1024) noexcept
+          : _cancelled(false),
+            _count(0),
+            _interval(interval == 0 ? 1 : interval),
+            _runner(runner) {}
+
+      // Returns true if the Runner has been killed.
+      bool operator()() noexcept {
+        if (!_cancelled && poll()) {
+          _cancelled = _runner.dead();
+        }
+        return _cancelled;
+      }
+
+      // Returns true if the Runner has been killed, or if it is running and
+      // Runner::stopped returns true.
+      bool stopped() {
+        if (!_cancelled && poll()) {
+          _cancelled = _runner.dead()
+                       || (_runner.running() && _runner.stopped());
+        }
+        return _cancelled;
+      }
+
+     private:
+      // Returns true if the Runner should be consulted, this is the case on
+      // the first call, and then every _interval calls.
+      bool poll() noexcept {
+        if (_count == 0) {
+          _count = _interval - 1;
+          return true;
+        }
+        --_count;
+        return false;
+      }
+
+      bool          _cancelled;
+      size_t        _count;
+      size_t const  _interval;
+      Runner const& _runner;
+    };
+  }  // namespace detail
 }  // namespace libsemigroups
 #endif  // LIBSEMIGROUPS_INCLUDE_RUNNER_HPP_
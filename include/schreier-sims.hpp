@@ -27,7 +27,13 @@
 //
 // https://github.com/gap-packages/Digraphs/blob/master/src/schreier-sims.c
 //
-// by Wilf A. Wilson.
+// by Wilf A. Wilson. The randomised version is Algorithm RANDOMSCHREIER in
+// Section 4.4.5 of the Handbook, and the random elements it uses are produced
+// by the product replacement algorithm of:
+//
+// F. Celler, C. R. Leedham-Green, S. H. Murray, A. C. Niemeyer, and E. A.
+// O'Brien, Generating random elements of a finite group, Comm. Algebra 23
+// (1995), 4931--4948.
 
 // TODO(later)
 //
@@ -42,23 +48,29 @@
 //    * internal_const_reference []
 // 1. iterator to the elements (Finn requires this)
 // 2. stabilizer member func
-// 3. change base
-// 4. random version
-// 5. try it with Digraphs
-// 6. only member functions that cause mathematical changes should be non-const
+// 3. try it with Digraphs
+// 4. only member functions that cause mathematical changes should be non-const
 
 // THIS FILE CAN BE USED AS HEADER ONLY
 
 #ifndef LIBSEMIGROUPS_INCLUDE_SCHREIER_SIMS_HPP_
 #define LIBSEMIGROUPS_INCLUDE_SCHREIER_SIMS_HPP_
 
+#include <algorithm>      // for max
 #include <array>          // for array
 #include <cstddef>        // for size_t
+#include <cstdint>        // for uint32_t
+#include <exception>      // for exception_ptr, current_exception
+#include <iterator>       // for distance
+#include <random>         // for mt19937, uniform_int_distribution
 #include <string>         // for operator+, basic_string
+#include <thread>         // for thread
 #include <unordered_set>  // for unordered_set
+#include <vector>         // for vector
 
 #include "adapters.hpp"                 // for action, degree, inverse
 #include "bruidhinn-traits.hpp"         // for detail::BruidhinnTraits
+#include "constants.hpp"                // for UNDEFINED
 #include "containers.hpp"               // for Array2, StaticVector2
 #include "int-range.hpp"                // for IntegralRange
 #include "libsemigroups-config.hpp"     // for LIBSEMIGROUPS_HPCOMBI
@@ -123,8 +135,30 @@ namespace libsemigroups {
 
   //! Defined in ``schreier-sims.hpp``.
   //!
-  //! This class implements a deterministic version of the Schreier-Sims
-  //! algorithm acting on a relatively small number of points (< 1000).
+  //! This class implements the Schreier-Sims algorithm acting on a
+  //! relatively small number of points (< 1000).
+  //!
+  //! By default the deterministic version of the algorithm is used, which
+  //! sifts every Schreier generator. If randomised() is set to \c true, then
+  //! random elements of the group are sifted instead, until confidence()
+  //! consecutive random elements sift to the identity, which is much faster
+  //! for groups of large degree. The stabiliser chain obtained in this way is
+  //! only correct with high probability, and if verify() is set to \c true,
+  //! then it is checked (and, if necessary, completed) by the deterministic
+  //! version afterwards.
+  //!
+  //! By default the elements of the transversals of the stabiliser chain are
+  //! stored explicitly, which uses memory quadratic in \c N for every
+  //! depth. If schreier_vectors() is set to \c true, then only the Schreier
+  //! vectors (the index of a strong generator, and a point, for every point
+  //! in every orbit) are stored, and the elements of the transversals are
+  //! computed when required, and kept in a small cache.
+  //!
+  //! Once the stabiliser chain is known, the base can be changed using
+  //! transpose_base_points or change_base, which modify the stabiliser chain
+  //! rather than computing it again, and many elements can be tested for
+  //! membership at once, using several threads, by contains(TIterator,
+  //! TIterator).
   //!
   //! \tparam N the largest point not fixed by the permutations in the
   //! permutation group to be represented by this.
@@ -209,6 +243,24 @@ namespace libsemigroups {
       }
     };
 
+    // An entry of the cache of elements of the transversals used when
+    // _schreier_vectors is true, _depth is UNDEFINED if the entry is empty.
+    struct CachedTransversal {
+      index_type            _depth;
+      bool                  _inversal_defined;
+      point_type            _pt;
+      internal_element_type _transversal;
+      internal_element_type _inversal;
+    };
+
+    static constexpr size_t transversal_cache_size = 64;
+
+    // The type of the labels in the Schreier vectors, i.e. of the indices of
+    // the strong generators at a depth. There is no fixed bound on the number
+    // of strong generators at a depth, in particular when randomised() is
+    // true.
+    using label_type = uint32_t;
+
    public:
     //! Construct a SchreierSims object representing the trivial group.
     //!
@@ -220,24 +272,41 @@ namespace libsemigroups {
     SchreierSims()
         : _base(),
           _base_size(0),
+          _confidence(20),
           _domain(),
           _finished(false),
+          _max_threads(1),
+          _mt(),
           _one(this->to_internal(One()(N))),
           _orbits(),
+          _orbits_label(),
           _orbits_lookup(),
+          _orbits_parent(),
+          _path(),
+          _random_elements(),
+          _randomised(false),
+          _schreier_vectors(false),
           _strong_gens(),
           _tmp_element1(this->internal_copy(_one)),
           _tmp_element2(this->internal_copy(_one)),
+          _tmp_element3(this->internal_copy(_one)),
           _transversal(),
-          _inversal() {
+          _transversal_cache(),
+          _inversal(),
+          _verify(false) {
       init();
     }
 
     ~SchreierSims() {
       clear();
+      for (auto& entry : _transversal_cache) {
+        this->internal_free(entry._transversal);
+        this->internal_free(entry._inversal);
+      }
       this->internal_free(_one);
       this->internal_free(_tmp_element1);
       this->internal_free(_tmp_element2);
+      this->internal_free(_tmp_element3);
     }
 
     //! Default move constructor.
@@ -252,6 +321,223 @@ namespace libsemigroups {
     //! Deleted.
     SchreierSims& operator=(SchreierSims&&) = delete;
 
+    //! Use the randomised, or deterministic, version of the algorithm.
+    //!
+    //! \param val use the randomised version if \c true, and the
+    //! deterministic version if \c false (the default).
+    //!
+    //! \returns
+    //! A reference to \c this.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    //!
+    //! \note
+    //! This setting only affects the stabiliser chain computed after it is
+    //! changed, i.e. it should be set before finished() returns \c true.
+    SchreierSims& randomised(bool val) noexcept {
+      _randomised = val;
+      return *this;
+    }
+
+    //! Check if the randomised version of the algorithm is used.
+    //!
+    //! \returns
+    //! A \c bool.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    //!
+    //! \par Parameters
+    //! (None)
+    bool randomised() const noexcept {
+      return _randomised;
+    }
+
+    //! Set the number of consecutive random elements that must sift to the
+    //! identity before the randomised version of the algorithm stops.
+    //!
+    //! If the stabiliser chain is not complete, then at most half of the
+    //! elements of the group sift to the identity, and so the probability
+    //! that the randomised version stops with an incomplete stabiliser chain
+    //! is roughly \f$2 ^ {-c}\f$ where \f$c\f$ is \p val.
+    //!
+    //! \param val the number of random elements (default: 20).
+    //!
+    //! \returns
+    //! A reference to \c this.
+    //!
+    //! \throws LibsemigroupsException if \p val is \c 0.
+    //!
+    //! \complexity
+    //! Constant.
+    SchreierSims& confidence(size_t val) {
+      if (val == 0) {
+        LIBSEMIGROUPS_EXCEPTION("the confidence must be positive, got 0");
+      }
+      _confidence = val;
+      return *this;
+    }
+
+    //! Get the number of consecutive random elements that must sift to the
+    //! identity before the randomised version of the algorithm stops.
+    //!
+    //! \returns
+    //! A \c size_t.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    //!
+    //! \par Parameters
+    //! (None)
+    size_t confidence() const noexcept {
+      return _confidence;
+    }
+
+    //! Verify the stabiliser chain found by the randomised version of the
+    //! algorithm or not.
+    //!
+    //! If \p val is \c true, then the stabiliser chain found by the
+    //! randomised version of the algorithm is checked by the deterministic
+    //! version, which adds any missing strong generators, and so the
+    //! stabiliser chain is always correct. This is usually much faster than
+    //! using the deterministic version from the start, since most Schreier
+    //! generators sift to the identity.
+    //!
+    //! \param val verify if \c true, and do not verify if \c false (the
+    //! default).
+    //!
+    //! \returns
+    //! A reference to \c this.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    SchreierSims& verify(bool val) noexcept {
+      _verify = val;
+      return *this;
+    }
+
+    //! Check if the stabiliser chain found by the randomised version of the
+    //! algorithm is verified.
+    //!
+    //! \returns
+    //! A \c bool.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    //!
+    //! \par Parameters
+    //! (None)
+    bool verify() const noexcept {
+      return _verify;
+    }
+
+    //! Store the transversals of the stabiliser chain as Schreier vectors,
+    //! or explicitly.
+    //!
+    //! If \p val is \c true, then only the Schreier vectors are stored, and
+    //! the elements of the transversals are computed from the strong
+    //! generators when they are required, which uses much less memory, but
+    //! more time. The most recently computed elements are cached.
+    //!
+    //! \param val use Schreier vectors if \c true, and store the
+    //! transversals explicitly if \c false (the default).
+    //!
+    //! \returns
+    //! A reference to \c this.
+    //!
+    //! \throws LibsemigroupsException if \p val is not schreier_vectors(),
+    //! and base_size() is not \c 0.
+    //!
+    //! \complexity
+    //! Constant.
+    SchreierSims& schreier_vectors(bool val) {
+      if (val != _schreier_vectors && _base_size != 0) {
+        LIBSEMIGROUPS_EXCEPTION("cannot change the representation of the "
+                                "transversals when there are base points");
+      }
+      _schreier_vectors = val;
+      if (val && _transversal_cache.empty()) {
+        _transversal_cache.resize(transversal_cache_size);
+        for (auto& entry : _transversal_cache) {
+          entry._depth       = UNDEFINED;
+          entry._transversal = this->internal_copy(_one);
+          entry._inversal    = this->internal_copy(_one);
+        }
+      }
+      return *this;
+    }
+
+    //! Check if the transversals of the stabiliser chain are stored as
+    //! Schreier vectors.
+    //!
+    //! \returns
+    //! A \c bool.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    //!
+    //! \par Parameters
+    //! (None)
+    bool schreier_vectors() const noexcept {
+      return _schreier_vectors;
+    }
+
+    //! Set the maximum number of threads used by contains(TIterator,
+    //! TIterator).
+    //!
+    //! \param nr_threads the maximum number of threads to use, a value of \c
+    //! 0 is treated as \c 1 (default: \c 1).
+    //!
+    //! \returns
+    //! A reference to \c this.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    SchreierSims& max_threads(size_t nr_threads) noexcept {
+      _max_threads = (nr_threads == 0 ? 1 : nr_threads);
+      return *this;
+    }
+
+    //! Returns the maximum number of threads used by contains(TIterator,
+    //! TIterator).
+    //!
+    //! \returns
+    //! A \c size_t.
+    //!
+    //! \exceptions
+    //! \noexcept
+    //!
+    //! \complexity
+    //! Constant.
+    //!
+    //! \par Parameters
+    //! (None)
+    size_t max_threads() const noexcept {
+      return _max_threads;
+    }
+
     //! Add a generator to this.
     //!
     //! \param x a const reference to the generator to add.
@@ -270,7 +556,7 @@ namespace libsemigroups {
             "generator degree incorrect, expected %d, got %d", N, Degree()(x));
       } else if (!contains(x)) {
         _finished = false;
-        _strong_gens.push_back(0, this->internal_copy(_tmp_element2));
+        _strong_gens[0].push_back(this->internal_copy(_tmp_element2));
       }
     }
 
@@ -324,7 +610,7 @@ namespace libsemigroups {
     //! (None)
     // TODO(later) shouldn't this throw if depth is out of bounds??
     size_t nr_strong_generators(index_type const depth) const noexcept {
-      return _strong_gens.size(depth);
+      return _strong_gens[depth].size();
     }
 
     //! Get a strong generator.
@@ -343,13 +629,13 @@ namespace libsemigroups {
     // TODO(later) shouldn't this throw if depth is out of bounds??
     const_element_reference strong_generator(index_type const depth,
                                              index_type const index) const {
-      if (index >= _strong_gens.size(depth)) {
+      if (index >= _strong_gens[depth].size()) {
         LIBSEMIGROUPS_EXCEPTION(
             "index out of bounds, expected value in range (0, %d], got %d",
-            _strong_gens.size(depth),
+            _strong_gens[depth].size(),
             index);
       }
-      return this->to_external_const(_strong_gens.at(depth, index));
+      return this->to_external_const(_strong_gens[depth][index]);
     }
 
     //! Check if any generators have been added so far.
@@ -361,9 +647,9 @@ namespace libsemigroups {
     //!
     //! \complexity
     //! Constant.
-    // Not noexcept because StaticVector2::size isn't
+    // Not noexcept because std::array::operator[] isn't
     bool empty() {
-      return _strong_gens.size(0) == 0;
+      return _strong_gens[0].size() == 0;
     }
 
     //! Returns the size of the group represented by this.
@@ -426,6 +712,124 @@ namespace libsemigroups {
       return InternalEqualTo()(_tmp_element2, _one);
     }
 
+    //! Check which of the elements in a range belong to the group.
+    //!
+    //! The elements are sifted through the stabiliser chain using up to
+    //! max_threads() threads, each of which sifts a contiguous block of the
+    //! range. The threads are started by this member function, rather than
+    //! taken from the thread pool used by the rest of libsemigroups, so that
+    //! this file can be used as header only.
+    //!
+    //! \tparam TIterator a random access iterator type whose values are of
+    //! type SchreierSims::element_type.
+    //!
+    //! \param first iterator pointing to the first element.
+    //! \param last iterator pointing one past the last element.
+    //!
+    //! \returns
+    //! A `std::vector<bool>` whose \c i-th entry is \c true if and only if
+    //! the \c i-th element of the range belongs to the group. As for
+    //! contains(const_element_reference), the entry for an element whose
+    //! degree is not \c N is \c false.
+    //!
+    //! \note
+    //! If max_threads() is greater than \c 1, then the SchreierSims::Product
+    //! and SchreierSims::Action adapters must be safe to call from several
+    //! threads at once, as they are for the default element types.
+    template <typename TIterator>
+    std::vector<bool> contains(TIterator first, TIterator last) {
+      schreier_sims();
+      size_t const n = std::distance(first, last);
+      // If the transversals are not stored, then the elements are sifted by
+      // following the Schreier trees, which uses the inverses of the strong
+      // generators.
+      std::vector<std::vector<internal_element_type>> inverses;
+      auto free_inverses = [this, &inverses]() {
+        for (auto& v : inverses) {
+          for (auto x : v) {
+            this->internal_free(x);
+          }
+        }
+      };
+      std::vector<char> result(n, false);
+      auto sift_range = [this, &first, &inverses, &result](size_t lo,
+                                                           size_t hi) {
+        internal_element_type x   = this->internal_copy(_one);
+        internal_element_type tmp = this->internal_copy(_one);
+        try {
+          for (size_t i = lo; i < hi; ++i) {
+            auto const& y = *(first + i);
+            if (has_valid_degree(y)) {
+              element_type cpy = this->external_copy(y);
+              Swap()(cpy, this->to_external(x));
+              this->external_free(cpy);
+              result[i] = const_sift(x, tmp, inverses);
+            }
+          }
+        } catch (...) {
+          this->internal_free(x);
+          this->internal_free(tmp);
+          throw;
+        }
+        this->internal_free(x);
+        this->internal_free(tmp);
+      };
+
+      try {
+        if (_schreier_vectors) {
+          inverses.resize(_base_size);
+          for (index_type depth = 0; depth < _base_size; ++depth) {
+            for (index_type j = 0; j < _strong_gens[depth].size(); ++j) {
+              inverses[depth].push_back(this->to_internal(Inverse()(
+                  this->to_external_const(_strong_gens[depth][j]))));
+            }
+          }
+        }
+        size_t const nr_threads
+            = std::max(size_t(1), std::min(_max_threads, n / 64));
+        if (nr_threads == 1) {
+          sift_range(0, n);
+        } else {
+          std::vector<std::exception_ptr> errors(nr_threads, nullptr);
+          std::vector<std::thread>        threads;
+          size_t const                    block = n / nr_threads;
+          try {
+            for (size_t t = 0; t < nr_threads; ++t) {
+              size_t const lo = t * block;
+              size_t const hi = (t == nr_threads - 1 ? n : lo + block);
+              threads.emplace_back([&errors, &sift_range, t, lo, hi]() {
+                try {
+                  sift_range(lo, hi);
+                } catch (...) {
+                  errors[t] = std::current_exception();
+                }
+              });
+            }
+          } catch (...) {
+            // A thread could not be started, the threads that were started
+            // must be joined before they are destroyed.
+            for (auto& t : threads) {
+              t.join();
+            }
+            throw;
+          }
+          for (auto& t : threads) {
+            t.join();
+          }
+          for (auto const& e : errors) {
+            if (e != nullptr) {
+              std::rethrow_exception(e);
+            }
+          }
+        }
+      } catch (...) {
+        free_inverses();
+        throw;
+      }
+      free_inverses();
+      return std::vector<bool>(result.cbegin(), result.cend());
+    }
+
     //! Returns a const reference to the identity element of the group
     //! represented by \c this.
     //!
@@ -451,25 +855,33 @@ namespace libsemigroups {
     //! \par Parameters
     //! (None)
     void clear() {
-      for (size_t depth = 0; depth < N; ++depth) {
-        for (size_t index = 0; index < N; ++index) {
-          if (_orbits_lookup[depth][index]) {
-            this->internal_free(_transversal[depth][index]);
-            this->internal_free(_inversal[depth][index]);
+      if (!_schreier_vectors) {
+        for (size_t depth = 0; depth < N; ++depth) {
+          for (size_t index = 0; index < N; ++index) {
+            if (_orbits_lookup[depth][index]) {
+              this->internal_free(_transversal[depth][index]);
+              this->internal_free(_inversal[depth][index]);
+            }
           }
         }
       }
+      for (auto& entry : _transversal_cache) {
+        entry._depth = UNDEFINED;
+      }
       std::unordered_set<internal_element_type> deleted;
       for (size_t depth = 0; depth < N; ++depth) {
-        for (size_t index = 0; index < _strong_gens.size(depth); ++index) {
-          if (deleted.find(_strong_gens.at(depth, index)) == deleted.end()) {
-            this->internal_free(_strong_gens.at(depth, index));
-            deleted.insert(_strong_gens.at(depth, index));
+        for (size_t index = 0; index < _strong_gens[depth].size(); ++index) {
+          if (deleted.find(_strong_gens[depth][index]) == deleted.end()) {
+            this->internal_free(_strong_gens[depth][index]);
+            deleted.insert(_strong_gens[depth][index]);
           }
         }
       }
-      _strong_gens.clear();
+      for (auto& gens : _strong_gens) {
+        gens.clear();
+      }
       _orbits.clear();
+      free_random_elements();
       init();
     }
 
@@ -557,6 +969,84 @@ namespace libsemigroups {
       return _base_size;
     }
 
+    //! Interchange two consecutive base points.
+    //!
+    //! The base points with indices \p index and `index + 1` are
+    //! interchanged, and the stabiliser chain is changed accordingly. Only
+    //! the strong generators and orbits at depths \p index and `index + 1`
+    //! are modified, the new strong generators at depth `index + 1` are
+    //! found using the deterministic algorithm in Section 4.4.7 of the
+    //! Handbook of computational group theory.
+    //!
+    //! \param index the index of the first base point.
+    //!
+    //! \returns
+    //! (None)
+    //!
+    //! \throws LibsemigroupsException if `index + 1` is not less than
+    //! base_size().
+    //!
+    //! \note
+    //! The stabiliser chain is computed first, if necessary.
+    void transpose_base_points(index_type const index) {
+      schreier_sims();
+      if (index + 1 >= _base_size) {
+        LIBSEMIGROUPS_EXCEPTION(
+            "index out of bounds, expected value in range [0, %d), got %d",
+            _base_size == 0 ? 0 : _base_size - 1,
+            index);
+      }
+      internal_transpose_base_points(index);
+    }
+
+    //! Change the base so that it starts with the given points.
+    //!
+    //! The base is changed so that its first points are the points in \p
+    //! prefix, in the same order, by repeatedly interchanging consecutive base
+    //! points, see transpose_base_points. Any point in \p prefix that is not
+    //! already a base point is added as a base point first. Afterwards,
+    //! the strong generators at depth \c i generate the pointwise stabiliser
+    //! of the first \c i points of \p prefix.
+    //!
+    //! \param prefix the new initial base points.
+    //!
+    //! \returns
+    //! (None)
+    //!
+    //! \throws LibsemigroupsException if any point in \p prefix is out of
+    //! range, or occurs more than once.
+    //!
+    //! \note
+    //! The stabiliser chain is computed first, if necessary.
+    void change_base(std::vector<point_type> const& prefix) {
+      std::vector<bool> seen(N, false);
+      for (point_type const pt : prefix) {
+        if (pt >= N) {
+          LIBSEMIGROUPS_EXCEPTION(
+              "base point out of range, expected value in [0, %d), got %d",
+              N,
+              size_t(pt));
+        } else if (seen[pt]) {
+          LIBSEMIGROUPS_EXCEPTION("duplicate base point, %d occurs twice",
+                                  size_t(pt));
+        }
+        seen[pt] = true;
+      }
+      schreier_sims();
+      for (index_type j = 0; j < prefix.size(); ++j) {
+        index_type k = j;
+        while (k < _base_size && _base[k] != prefix[j]) {
+          ++k;
+        }
+        if (k == _base_size) {
+          internal_add_base_point(prefix[j]);
+        }
+        for (; k > j; --k) {
+          internal_transpose_base_points(k - 1);
+        }
+      }
+    }
+
    private:
     void init() {
       _base_size = 0;
@@ -574,51 +1064,287 @@ namespace libsemigroups {
 
     void internal_add_base_point(point_type const pt) {
       LIBSEMIGROUPS_ASSERT(_base_size < N);
-      _base[_base_size] = pt;
-      _orbits.push_back(_base_size, pt);
-      _orbits_lookup[_base_size][pt] = true;
-      _transversal[_base_size][pt]   = this->internal_copy(_one);
-      _inversal[_base_size][pt]      = this->internal_copy(_one);
+      init_orbit(_base_size, pt);
       _base_size++;
     }
 
+    // Makes pt the base point at depth, and {pt} the orbit at depth, which
+    // must be empty.
+    void init_orbit(index_type const depth, point_type const pt) {
+      LIBSEMIGROUPS_ASSERT(_orbits.size(depth) == 0);
+      _base[depth] = pt;
+      _orbits.push_back(depth, pt);
+      _orbits_lookup[depth][pt] = true;
+      _orbits_parent[depth][pt] = pt;
+      if (!_schreier_vectors) {
+        _transversal[depth][pt] = this->internal_copy(_one);
+        _inversal[depth][pt]    = this->internal_copy(_one);
+      }
+    }
+
+    // Removes every point from the orbit at depth.
+    void clear_orbit(index_type const depth) {
+      for (auto it = _orbits.cbegin(depth); it < _orbits.cend(depth); ++it) {
+        if (!_schreier_vectors) {
+          this->internal_free(_transversal[depth][*it]);
+          this->internal_free(_inversal[depth][*it]);
+        }
+        _orbits_lookup[depth][*it] = false;
+      }
+      _orbits.clear(depth);
+      for (auto& entry : _transversal_cache) {
+        if (entry._depth == depth) {
+          entry._depth = UNDEFINED;
+        }
+      }
+    }
+
+    // Returns the orbit of pt under the elements of gens.
+    std::vector<point_type>
+    point_orbit(point_type const                           pt,
+                std::vector<internal_element_type> const& gens) const {
+      std::vector<point_type> orb  = {pt};
+      std::vector<bool>       seen(N, false);
+      seen[pt] = true;
+      for (size_t i = 0; i < orb.size(); ++i) {
+        for (auto x : gens) {
+          point_type const img = Action()(orb[i], this->to_external_const(x));
+          if (!seen[img]) {
+            seen[img] = true;
+            orb.push_back(img);
+          }
+        }
+      }
+      return orb;
+    }
+
+    // Interchanges the base points at depths i and i + 1. The group at depth
+    // i, and its strong generators, do not change, and so the new orbit at
+    // depth i is just the orbit of the old base point at depth i + 1. The new
+    // group H at depth i + 1 is the stabiliser of this point in the group at
+    // depth i, which contains the group at depth i + 2, and the size of its
+    // orbit is known. The generators of H are found by starting with the
+    // strong generators at depth i + 2, and adding elements of H mapping
+    // the new base point at depth i + 1 outside its current orbit, until the
+    // orbit has the right size. Such elements are products of elements of
+    // the old transversals at depths i + 1 and i.
+    void internal_transpose_base_points(index_type const i) {
+      LIBSEMIGROUPS_ASSERT(i + 1 < _base_size);
+      point_type const b0 = _base[i];
+      point_type const b1 = _base[i + 1];
+
+      std::vector<internal_element_type> gens(_strong_gens[i]);
+      size_t const target = _orbits.size(i) * _orbits.size(i + 1)
+                            / point_orbit(b1, gens).size();
+      gens.clear();
+      if (i + 2 < N) {
+        gens = _strong_gens[i + 2];
+      }
+      std::vector<point_type> gamma = point_orbit(b0, gens);
+      std::vector<bool>       todo(N, false);
+      for (auto it = _orbits.cbegin(i); it < _orbits.cend(i); ++it) {
+        todo[*it] = true;
+      }
+      for (point_type const pt : gamma) {
+        todo[pt] = false;
+      }
+      for (auto it = _orbits.cbegin(i);
+           it < _orbits.cend(i) && gamma.size() < target;
+           ++it) {
+        point_type const gam = *it;
+        if (!todo[gam]) {
+          continue;
+        }
+        // y = transversal(i, gam) maps b0 to gam, and if x maps b1 to
+        // b1 ^ (y ^ -1) and fixes b0, then x * y belongs to H.
+        point_type const pt
+            = Action()(b1, this->to_external_const(inversal(i, gam)));
+        if (_orbits_lookup[i + 1][pt]) {
+          Product()(this->to_external(_tmp_element2),
+                    this->to_external_const(transversal(i + 1, pt)),
+                    this->to_external_const(_one));
+          Product()(this->to_external(_tmp_element1),
+                    this->to_external_const(_tmp_element2),
+                    this->to_external_const(transversal(i, gam)));
+          gens.push_back(this->internal_copy(_tmp_element1));
+          gamma = point_orbit(b0, gens);
+          for (point_type const q : gamma) {
+            todo[q] = false;
+          }
+        } else {
+          for (point_type const q : point_orbit(gam, gens)) {
+            todo[q] = false;
+          }
+        }
+      }
+
+      // Free the old strong generators at depth i + 1 that are not strong
+      // generators at any other depth.
+      std::unordered_set<internal_element_type> keep;
+      for (size_t depth = 0; depth < N; ++depth) {
+        if (depth != i + 1) {
+          keep.insert(_strong_gens[depth].cbegin(),
+                      _strong_gens[depth].cend());
+        }
+      }
+      for (auto x : _strong_gens[i + 1]) {
+        if (keep.insert(x).second) {
+          this->internal_free(x);
+        }
+      }
+      _strong_gens[i + 1].clear();
+      for (auto x : gens) {
+        _strong_gens[i + 1].push_back(x);
+      }
+
+      clear_orbit(i);
+      init_orbit(i, b1);
+      orbit_enumerate(i);
+      clear_orbit(i + 1);
+      init_orbit(i + 1, b0);
+      orbit_enumerate(i + 1);
+    }
+
     void orbit_enumerate(index_type const depth, index_type first = 0) {
       LIBSEMIGROUPS_ASSERT(depth < _base_size);
       for (index_type i = first; i < _orbits.size(depth); i++) {
-        for (auto it = _strong_gens.cbegin(depth);
-             it < _strong_gens.cend(depth);
-             ++it) {
-          orbit_add_point(depth, *it, _orbits.at(depth, i));
+        for (index_type j = 0; j < _strong_gens[depth].size(); ++j) {
+          orbit_add_point(depth, j, _orbits.at(depth, i));
         }
       }
     }
 
-    void orbit_add_gen(index_type const depth, internal_element_type gen) {
+    // Applies the last strong generator at depth, which was just added, to
+    // the existing points in _orbits[depth].
+    void orbit_add_gen(index_type const depth) {
       LIBSEMIGROUPS_ASSERT(depth < _base_size);
-      // Apply the new generator to existing points in orbits[depth].
-      index_type old_size_orbit = _orbits.size(depth);
+      index_type const j              = _strong_gens[depth].size() - 1;
+      index_type       old_size_orbit = _orbits.size(depth);
       for (index_type i = 0; i < old_size_orbit; i++) {
-        orbit_add_point(depth, gen, _orbits.at(depth, i));
+        orbit_add_point(depth, j, _orbits.at(depth, i));
       }
       orbit_enumerate(depth, old_size_orbit);
     }
 
-    void orbit_add_point(index_type const      depth,
-                         internal_element_type x,
-                         point_type const      pt) {
+    // Applies the strong generator with index j at depth to pt.
+    void orbit_add_point(index_type const depth,
+                         index_type const j,
+                         point_type const pt) {
+      internal_const_element_type x = _strong_gens[depth][j];
       point_type img = Action()(pt, this->to_external_const(x));
       if (!_orbits_lookup[depth][img]) {
         _orbits.push_back(depth, img);
         _orbits_lookup[depth][img] = true;
-        _transversal[depth][img]   = this->internal_copy(_one);
-        Product()(this->to_external(_transversal[depth][img]),
-                  this->to_external_const(_transversal[depth][pt]),
-                  this->to_external_const(x));
-        _inversal[depth][img] = this->to_internal(
-            Inverse()(this->to_external_const(_transversal[depth][img])));
+        _orbits_label[depth][img]  = j;
+        _orbits_parent[depth][img] = pt;
+        if (!_schreier_vectors) {
+          _transversal[depth][img] = this->internal_copy(_one);
+          Product()(this->to_external(_transversal[depth][img]),
+                    this->to_external_const(_transversal[depth][pt]),
+                    this->to_external_const(x));
+          _inversal[depth][img] = this->to_internal(
+              Inverse()(this->to_external_const(_transversal[depth][img])));
+        }
       }
     }
 
+    // Returns the element of the transversal at depth mapping _base[depth]
+    // to pt. If _schreier_vectors is true, then the returned element belongs
+    // to _transversal_cache, and is only valid until the next call to this
+    // function or inversal.
+    internal_const_element_type transversal(index_type const depth,
+                                            point_type const pt) {
+      LIBSEMIGROUPS_ASSERT(_orbits_lookup[depth][pt]);
+      if (!_schreier_vectors) {
+        return _transversal[depth][pt];
+      }
+      return cached_transversal(depth, pt)._transversal;
+    }
+
+    // Returns the inverse of transversal(depth, pt), which is valid for as
+    // long as transversal(depth, pt) is.
+    internal_const_element_type inversal(index_type const depth,
+                                         point_type const pt) {
+      LIBSEMIGROUPS_ASSERT(_orbits_lookup[depth][pt]);
+      if (!_schreier_vectors) {
+        return _inversal[depth][pt];
+      }
+      CachedTransversal& entry = cached_transversal(depth, pt);
+      if (!entry._inversal_defined) {
+        this->internal_free(entry._inversal);
+        entry._inversal = this->to_internal(
+            Inverse()(this->to_external_const(entry._transversal)));
+        entry._inversal_defined = true;
+      }
+      return entry._inversal;
+    }
+
+    // The cache is direct mapped, i.e. every pair (depth, pt) has only one
+    // entry where it can be stored. The elements of the transversal never
+    // change once they are defined, and so the cache is only invalidated by
+    // clear. If the entry does not contain pt, then the element of the
+    // transversal is the product of the strong generators labelling the
+    // path from _base[depth] to pt in the Schreier tree.
+    CachedTransversal& cached_transversal(index_type const depth,
+                                          point_type const pt) {
+      CachedTransversal& entry
+          = _transversal_cache[(depth * N + pt) % transversal_cache_size];
+      if (entry._depth == depth && entry._pt == pt) {
+        return entry;
+      }
+      _path.clear();
+      for (point_type q = pt; q != _base[depth]; q = _orbits_parent[depth][q]) {
+        _path.push_back(_orbits_label[depth][q]);
+      }
+      Product()(this->to_external(entry._transversal),
+                this->to_external_const(_one),
+                this->to_external_const(_one));
+      for (auto it = _path.crbegin(); it != _path.crend(); ++it) {
+        Product()(this->to_external(_tmp_element3),
+                  this->to_external_const(entry._transversal),
+                  this->to_external_const(_strong_gens[depth][*it]));
+        Swap()(this->to_external(entry._transversal),
+               this->to_external(_tmp_element3));
+      }
+      entry._depth            = depth;
+      entry._pt               = pt;
+      entry._inversal_defined = false;
+      return entry;
+    }
+
+    // Sifts x in-place, using tmp as scratch, and returns true if x sifts to
+    // the identity. Unlike internal_sift, this does not modify this, and so
+    // it can be called by several threads at once. If _schreier_vectors is
+    // true, then inverses[depth][j] must be the inverse of
+    // _strong_gens[depth][j].
+    bool const_sift(
+        internal_element_type&                                 x,
+        internal_element_type&                                 tmp,
+        std::vector<std::vector<internal_element_type>> const& inverses) const {
+      for (index_type depth = 0; depth < _base_size; ++depth) {
+        point_type beta = Action()(_base[depth], this->to_external_const(x));
+        if (!_orbits_lookup[depth][beta]) {
+          return false;
+        }
+        if (!_schreier_vectors) {
+          Product()(this->to_external(tmp),
+                    this->to_external_const(x),
+                    this->to_external_const(_inversal[depth][beta]));
+          Swap()(this->to_external(x), this->to_external(tmp));
+        } else {
+          while (beta != _base[depth]) {
+            Product()(this->to_external(tmp),
+                      this->to_external_const(x),
+                      this->to_external_const(
+                          inverses[depth][_orbits_label[depth][beta]]));
+            Swap()(this->to_external(x), this->to_external(tmp));
+            beta = _orbits_parent[depth][beta];
+          }
+        }
+      }
+      return InternalEqualTo()(x, _one);
+    }
+
     // Changes _tmp_element2 in-place, and returns the depth reached in the
     // sifting.
     index_type internal_sift() {
@@ -630,7 +1356,7 @@ namespace libsemigroups {
         }
         Product()(this->to_external(_tmp_element1),
                   this->to_external_const(_tmp_element2),
-                  this->to_external_const(_inversal[depth][beta]));
+                  this->to_external_const(inversal(depth, beta)));
         Swap()(this->to_external(_tmp_element2),
                this->to_external(_tmp_element1));
       }
@@ -642,8 +1368,8 @@ namespace libsemigroups {
         return;
       }
 
-      for (index_type j = 0; j < _strong_gens.size(0); j++) {
-        internal_const_element_type x = _strong_gens.at(0, j);
+      for (index_type j = 0; j < _strong_gens[0].size(); j++) {
+        internal_const_element_type x = _strong_gens[0][j];
         index_type                  k = 0;
         while (k < _base_size
                && Action()(_base[k], this->to_external_const(x)) == _base[k]) {
@@ -658,35 +1384,42 @@ namespace libsemigroups {
       index_type first = 0;
       for (index_type i = 1; i < _base_size + 1; i++) {
         point_type beta      = _base[i - 1];
-        index_type old_first = _strong_gens.size(i);
+        index_type old_first = _strong_gens[i].size();
         // set up the strong generators
-        for (index_type j = first; j < _strong_gens.size(i - 1); j++) {
-          internal_element_type x = _strong_gens.at(i - 1, j);
+        for (index_type j = first; j < _strong_gens[i - 1].size(); j++) {
+          internal_element_type x = _strong_gens[i - 1][j];
           if (beta == Action()(beta, this->to_external_const(x))) {
-            _strong_gens.push_back(i, x);
+            _strong_gens[i].push_back(x);
           }
         }
         first = old_first;
         // find the orbit of <beta> under strong_gens[i - 1]
         orbit_enumerate(i - 1);
       }
+      if (_randomised && _strong_gens[0].size() != 0) {
+        random_schreier_sims();
+        if (!_verify) {
+          _finished = true;
+          return;
+        }
+      }
       for (int i = _base_size - 1; i >= 0; --i) {
       start:
         for (auto it = _orbits.cbegin(i); it < _orbits.cend(i); ++it) {
           point_type beta = *it;
-          for (index_type m = 0; m < _strong_gens.size(i); m++) {
+          for (index_type m = 0; m < _strong_gens[i].size(); m++) {
             Product()(this->to_external(_tmp_element1),
-                      this->to_external_const(_transversal[i][beta]),
-                      this->to_external_const(_strong_gens.at(i, m)));
+                      this->to_external_const(transversal(i, beta)),
+                      this->to_external_const(_strong_gens[i][m]));
             point_type delta = Action()(
-                beta, this->to_external_const(_strong_gens.at(i, m)));
+                beta, this->to_external_const(_strong_gens[i][m]));
             LIBSEMIGROUPS_ASSERT(
                 delta
                 == Action()(_base[i], this->to_external_const(_tmp_element1)));
-            if (!InternalEqualTo()(_tmp_element1, _transversal[i][delta])) {
+            if (!InternalEqualTo()(_tmp_element1, transversal(i, delta))) {
               Product()(this->to_external(_tmp_element2),
                         this->to_external_const(_tmp_element1),
-                        this->to_external_const(_inversal[i][delta]));
+                        this->to_external_const(inversal(i, delta)));
               LIBSEMIGROUPS_ASSERT(
                   _base[i]
                   == Action()(_base[i],
@@ -702,12 +1435,12 @@ namespace libsemigroups {
               }
               if (propagate) {
                 LIBSEMIGROUPS_ASSERT(i + 1 <= static_cast<int>(depth));
-                _strong_gens.push_back(i + 1,
-                                       this->internal_copy(_tmp_element2));
-                orbit_add_gen(i + 1, _tmp_element2);
+                _strong_gens[i + 1].push_back(
+                    this->internal_copy(_tmp_element2));
+                orbit_add_gen(i + 1);
                 for (index_type l = i + 2; l <= depth; l++) {
-                  _strong_gens.push_back(l, _strong_gens.back(i + 1));
-                  orbit_add_gen(l, _tmp_element2);
+                  _strong_gens[l].push_back(_strong_gens[i + 1].back());
+                  orbit_add_gen(l);
                   // add generator to orbit of base[l]
                 }
                 i = depth;
@@ -720,6 +1453,97 @@ namespace libsemigroups {
       _finished = true;
     }
 
+    // Sifts random elements of the group until _confidence consecutive
+    // random elements sift to the identity. If a random element does not
+    // sift to the identity, then the sifted element is added as a strong
+    // generator at every depth where it fixes all the previous base points,
+    // as in the deterministic version.
+    void random_schreier_sims() {
+      init_random_elements();
+      size_t nr = 0;
+      while (nr < _confidence) {
+        random_element();  // changes _tmp_element2 in-place
+        // internal_sift changes _tmp_element2 in-place
+        index_type depth = internal_sift();
+        if (depth == _base_size && InternalEqualTo()(_tmp_element2, _one)) {
+          ++nr;
+          continue;
+        }
+        // Every random element belongs to the group, and so maps _base[0]
+        // into _orbits[0].
+        LIBSEMIGROUPS_ASSERT(depth > 0);
+        if (depth == _base_size) {
+          internal_add_base_point(*first_non_fixed_point(_tmp_element2));
+        }
+        _strong_gens[1].push_back(this->internal_copy(_tmp_element2));
+        orbit_add_gen(1);
+        for (index_type l = 2; l <= depth; l++) {
+          _strong_gens[l].push_back(_strong_gens[1].back());
+          orbit_add_gen(l);
+        }
+        nr = 0;
+      }
+    }
+
+    // The last element of _random_elements is the accumulator, and the
+    // others are the elements that are multiplied together, at least 10 of
+    // them, as suggested by Celler et al.
+    void init_random_elements() {
+      free_random_elements();
+      size_t const n = _strong_gens[0].size();
+      LIBSEMIGROUPS_ASSERT(n != 0);
+      for (size_t i = 0; i < std::max(size_t(10), n); ++i) {
+        _random_elements.push_back(
+            this->internal_copy(_strong_gens[0][i % n]));
+      }
+      _random_elements.push_back(this->internal_copy(_one));
+      for (size_t i = 0; i < 50; ++i) {
+        random_element();
+      }
+    }
+
+    // Replaces a random element x of _random_elements (not the accumulator)
+    // by its product with another such element y, as x * y or y * x, then
+    // multiplies the accumulator by the new x, and puts a copy of the
+    // accumulator in _tmp_element2.
+    void random_element() {
+      LIBSEMIGROUPS_ASSERT(_random_elements.size() > 2);
+      std::uniform_int_distribution<size_t> dist(0,
+                                                  _random_elements.size() - 2);
+      size_t const i = dist(_mt);
+      size_t       j = dist(_mt);
+      while (j == i) {
+        j = dist(_mt);
+      }
+      internal_element_type& x = _random_elements[i];
+      internal_element_type& y = _random_elements[j];
+      if (_mt() % 2 == 0) {
+        Product()(this->to_external(_tmp_element1),
+                  this->to_external_const(x),
+                  this->to_external_const(y));
+      } else {
+        Product()(this->to_external(_tmp_element1),
+                  this->to_external_const(y),
+                  this->to_external_const(x));
+      }
+      Swap()(this->to_external(x), this->to_external(_tmp_element1));
+      internal_element_type& acc = _random_elements.back();
+      Product()(this->to_external(_tmp_element1),
+                this->to_external_const(acc),
+                this->to_external_const(x));
+      Swap()(this->to_external(acc), this->to_external(_tmp_element1));
+      Product()(this->to_external(_tmp_element2),
+                this->to_external_const(acc),
+                this->to_external_const(_one));
+    }
+
+    void free_random_elements() {
+      for (auto x : _random_elements) {
+        this->internal_free(x);
+      }
+      _random_elements.clear();
+    }
+
     typename domain_type::const_iterator
     first_non_fixed_point(internal_const_element_type x) {
       for (auto it = _domain.cbegin(); it < _domain.cend(); ++it) {
@@ -734,18 +1558,30 @@ namespace libsemigroups {
       return _domain.cend();
     }
 
-    std::array<point_type, N>                       _base;
-    index_type                                      _base_size;
-    domain_type                                     _domain;
-    bool                                            _finished;
-    internal_element_type                           _one;
-    detail::StaticVector2<point_type, N>            _orbits;
-    detail::Array2<bool, N>                         _orbits_lookup;
-    detail::StaticVector2<internal_element_type, N> _strong_gens;
-    internal_element_type                           _tmp_element1;
-    internal_element_type                           _tmp_element2;
-    detail::Array2<internal_element_type, N>        _transversal;
-    detail::Array2<internal_element_type, N>        _inversal;
+    std::array<point_type, N>                         _base;
+    index_type                                        _base_size;
+    size_t                                            _confidence;
+    domain_type                                       _domain;
+    bool                                              _finished;
+    size_t                                            _max_threads;
+    std::mt19937                                      _mt;
+    internal_element_type                             _one;
+    detail::StaticVector2<point_type, N>              _orbits;
+    detail::Array2<label_type, N>                     _orbits_label;
+    detail::Array2<bool, N>                           _orbits_lookup;
+    detail::Array2<point_type, N>                     _orbits_parent;
+    std::vector<label_type>                           _path;
+    std::vector<internal_element_type>                _random_elements;
+    bool                                              _randomised;
+    bool                                              _schreier_vectors;
+    std::array<std::vector<internal_element_type>, N> _strong_gens;
+    internal_element_type                             _tmp_element1;
+    internal_element_type                             _tmp_element2;
+    internal_element_type                             _tmp_element3;
+    detail::Array2<internal_element_type, N>          _transversal;
+    std::vector<CachedTransversal>                    _transversal_cache;
+    detail::Array2<internal_element_type, N>          _inversal;
+    bool                                              _verify;
   };
 }  // namespace libsemigroups
 
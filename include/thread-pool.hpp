@@ -0,0 +1,193 @@
+//
+// libsemigroups - C++ library for semigroups and monoids
+// Copyright (C) 2019 James D. Mitchell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// This file contains the declarations of the classes ThreadPool, a pool of
+// persistent worker threads that steal work from each other, and TaskGroup,
+// for running several tasks on a ThreadPool and waiting for all of them to
+// finish. Every parallel algorithm in libsemigroups runs its tasks on the
+// single ThreadPool returned by thread_pool(), so that threads are not
+// created every time something is run in parallel, and so that the total
+// number of threads used is bounded, even when several objects are run at
+// once.
+
+#ifndef LIBSEMIGROUPS_INCLUDE_THREAD_POOL_HPP_
+#define LIBSEMIGROUPS_INCLUDE_THREAD_POOL_HPP_
+
+#include <atomic>              // for atomic
+#include <condition_variable>  // for condition_variable
+#include <cstddef>             // for size_t
+#include <deque>               // for deque
+#include <exception>           // for exception_ptr
+#include <functional>          // for function
+#include <memory>              // for unique_ptr
+#include <mutex>               // for mutex
+#include <thread>              // for thread
+#include <type_traits>         // for decay
+#include <utility>             // for forward
+#include <vector>              // for vector
+
+namespace libsemigroups {
+  namespace detail {
+    class TaskGroup;
+
+    // Every worker thread has its own deque of tasks. A worker pushes the
+    // tasks it submits onto the back of its own deque, and takes tasks from
+    // the front of its own deque, so that the tasks on one deque run in the
+    // order they were submitted (this matters when a task resubmits itself,
+    // as in Race). When its deque is empty, a worker steals from the deques
+    // of the other workers. Tasks submitted by other threads are distributed
+    // among the deques in a round-robin fashion.
+    //
+    // A task must not throw, use TaskGroup::run to run tasks that might.
+    class ThreadPool final {
+     public:
+      using task_type = std::function<void()>;
+
+      // Constructs a ThreadPool with nr_threads worker threads (or 1 if
+      // nr_threads is 0).
+      explicit ThreadPool(size_t nr_threads);
+
+      ThreadPool(ThreadPool const&) = delete;
+      ThreadPool(ThreadPool&&)      = delete;
+      ThreadPool& operator=(ThreadPool const&) = delete;
+      ThreadPool& operator=(ThreadPool&&) = delete;
+
+      // Joins the worker threads, any tasks not yet started are discarded.
+      ~ThreadPool();
+
+      // Returns the number of worker threads.
+      size_t size() const noexcept {
+        return _threads.size();
+      }
+
+      // Changes the number of worker threads to nr_threads (or 1 if
+      // nr_threads is 0). Throws if any task is queued or running, or if
+      // called from one of the worker threads.
+      void resize(size_t nr_threads);
+
+      // Submits task, which will be run by one of the workers, or by a thread
+      // calling run_pending_task. The TaskGroup that task belongs to, if any,
+      // is group.
+      void submit(task_type task, TaskGroup const* group = nullptr);
+
+      // Runs one queued task belonging to group in the calling thread, if
+      // there is one, and returns true if a task was run. This is used by
+      // threads waiting for the tasks in group to finish, so that they do
+      // something useful while waiting, and so that nested parallelism
+      // cannot deadlock. Tasks belonging to other groups are never run, so
+      // that a task of one group cannot end up nested inside a task of an
+      // unrelated group, which is waiting.
+      bool run_pending_task(TaskGroup const* group);
+
+      // Returns true if the calling thread is one of the workers of this.
+      bool is_worker() const noexcept;
+
+      // Returns the index of the calling thread in this, which must be one of
+      // the workers of this.
+      size_t index() const noexcept;
+
+     private:
+      struct Task {
+        task_type        _func;
+        TaskGroup const* _group;
+      };
+
+      struct Queue {
+        std::mutex       _mtx;
+        std::deque<Task> _tasks;
+      };
+
+      bool pop(size_t, task_type&);
+      bool pop(size_t, TaskGroup const*, task_type&);
+      bool steal(size_t, task_type&);
+      void start(size_t);
+      void stop();
+      void worker(size_t);
+
+      std::condition_variable             _cv;
+      std::mutex                          _mtx;
+      std::atomic<size_t>                 _next_queue;
+      std::atomic<size_t>                 _nr_queued;
+      std::atomic<size_t>                 _nr_running;
+      std::vector<std::unique_ptr<Queue>> _queues;
+      bool                                _stop;
+      std::vector<std::thread>            _threads;
+    };
+
+    // Returns the ThreadPool used by libsemigroups, which initially has
+    // std::thread::hardware_concurrency() worker threads.
+    ThreadPool& thread_pool();
+
+    // A TaskGroup runs tasks on a ThreadPool, and waits for all of them to
+    // finish. A task can run further tasks in the same TaskGroup. The thread
+    // that calls wait runs the queued tasks of this TaskGroup while it waits.
+    class TaskGroup final {
+     public:
+      explicit TaskGroup(ThreadPool& pool = thread_pool())
+          : _cv(), _error(nullptr), _mtx(), _pending(0), _pool(pool) {}
+
+      TaskGroup(TaskGroup const&) = delete;
+      TaskGroup(TaskGroup&&)      = delete;
+      TaskGroup& operator=(TaskGroup const&) = delete;
+      TaskGroup& operator=(TaskGroup&&) = delete;
+
+      // Waits for the tasks to finish, discarding any exception thrown.
+      ~TaskGroup();
+
+      // Submits func to the ThreadPool. If func throws, then the exception is
+      // rethrown by wait (if several tasks throw, only the first exception is
+      // rethrown).
+      template <typename TCallable>
+      void run(TCallable&& func) {
+        ++_pending;
+        typename std::decay<TCallable>::type f(std::forward<TCallable>(func));
+        _pool.submit(
+            [this, f]() mutable {
+              try {
+                f();
+              } catch (...) {
+                done(std::current_exception());
+                return;
+              }
+              done(nullptr);
+            },
+            this);
+      }
+
+      // Waits for every task run in this to finish, and rethrows the first
+      // exception thrown by a task, if any.
+      void wait();
+
+      // Returns the number of tasks that have not yet finished.
+      size_t pending() const noexcept {
+        return _pending;
+      }
+
+     private:
+      void done(std::exception_ptr);
+      void wait_no_throw();
+
+      std::condition_variable _cv;
+      std::exception_ptr      _error;
+      std::mutex              _mtx;
+      std::atomic<size_t>     _pending;
+      ThreadPool&             _pool;
+    };
+  }  // namespace detail
+}  // namespace libsemigroups
+#endif  // LIBSEMIGROUPS_INCLUDE_THREAD_POOL_HPP_
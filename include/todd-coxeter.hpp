@@ -27,6 +27,7 @@
 #include <memory>   // for shared_ptr
 #include <numeric>  // for std::iota
 #include <stack>    // for stack
+#include <string>   // for string
 #include <utility>  // for pair
 #include <vector>   // for vector
 
@@ -363,6 +364,7 @@ namespace libsemigroups {
       ////////////////////////////////////////////////////////////////////////
 
       bool contains(word_type const&, word_type const&) override;
+      std::vector<bool> contains(std::vector<relation_type> const&) override;
 
       ////////////////////////////////////////////////////////////////////////
       // ToddCoxeter - member functions (init + settings) - public
@@ -542,6 +544,17 @@ namespace libsemigroups {
       //! nothing.
       void shrink_to_fit();
 
+      //! Returns an estimate of the number of bytes used by the coset table,
+      //! and the other data structures whose size depends on the number of
+      //! cosets. This is the value compared with Runner::memory_limit.
+      //!
+      //! \complexity
+      //! Constant.
+      //!
+      //! \par Parameters
+      //! (None)
+      size_t memory_used() const override;
+
       ////////////////////////////////////////////////////////////////////////
       // ToddCoxeter - member functions (state) - public
       ////////////////////////////////////////////////////////////////////////
@@ -618,6 +631,10 @@ namespace libsemigroups {
       bool       is_quotient_obviously_finite_impl() override;
       bool       is_quotient_obviously_infinite_impl() override;
       void       set_nr_generators_impl(size_t) override;
+      std::vector<coset_type>
+      words_to_class_indices_impl(std::vector<word_type> const&) override;
+      std::vector<coset_type>
+      parent_class_indices_impl(FroidurePinBase&) override;
 
       ////////////////////////////////////////////////////////////////////////
       // ToddCoxeter - member functions (validation) - private
@@ -649,6 +666,7 @@ namespace libsemigroups {
 
       void make_deductions_dfs(coset_type const);
       void process_deductions();
+      void process_shared_pairs();
 
       inline coset_type tau(coset_type const c, letter_type const a) const
           noexcept {
@@ -669,6 +687,14 @@ namespace libsemigroups {
         return c;
       }
 
+      // Traces words[first], ..., words[last - 1] from the identity coset
+      // (backwards if this is a left congruence), and puts the class indices
+      // into result[first], ..., result[last - 1].
+      void tau_interleaved(std::vector<word_type> const&,
+                           size_t,
+                           size_t,
+                           std::vector<coset_type>&) const;
+
       template <typename TStackDeduct>
       coset_type
       tau_and_define_if_necessary(coset_type                c,
@@ -965,5 +991,17 @@ namespace libsemigroups {
     };
 
   }  // namespace congruence
+
+  // Once a congruence::ToddCoxeter is finished and standardized,
+  // word_to_class_index and class_index_to_word only read the coset table
+  // and tree, and so fpsemigroup::ToddCoxeter can compute normal forms in
+  // parallel.
+  template <>
+  std::vector<std::string>
+  fpsemigroup::ToddCoxeter::normal_forms_impl(std::vector<std::string> const&);
+
+  template <>
+  std::vector<word_type>
+  fpsemigroup::ToddCoxeter::normal_forms_impl(std::vector<word_type> const&);
 }  // namespace libsemigroups
 #endif  // LIBSEMIGROUPS_INCLUDE_TODD_COXETER_HPP_
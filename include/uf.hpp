@@ -24,10 +24,16 @@
 #define LIBSEMIGROUPS_INCLUDE_UF_HPP_
 
 #include <cstddef>  // for size_t
+#include <cstdint>  // for uint8_t
 #include <vector>   // for vector
 
 namespace libsemigroups {
   namespace detail {
+    // The blocks are stored as a forest in which the parent of every entry is
+    // given by the table. Roots are united by rank, and find uses path
+    // halving. The representative of a block, returned by find, is always the
+    // least entry in the block, which is not necessarily the root of the
+    // block.
     class UF final {
      public:
       using table_type  = std::vector<size_t>;
@@ -37,7 +43,8 @@ namespace libsemigroups {
       UF(UF const& copy);
       UF& operator=(UF const& copy) = delete;
 
-      // Constructor by table
+      // Constructor by table, the table must contain the parent of every
+      // entry in a forest.
       explicit UF(table_type const& table);
 
       // Constructor by size
@@ -58,30 +65,35 @@ namespace libsemigroups {
       // get_blocks
       blocks_type* get_blocks();
 
-      // find
+      // find, returns the least entry in the block containing i
       size_t find(size_t i);
 
       // union
       void unite(size_t i, size_t j);
 
-      // flatten
+      // flatten, afterwards the table contains find(i) in position i
       void flatten();
 
       // add_entry
       void add_entry();
 
-      // nr_blocks
+      // nr_blocks, this is constant time
       size_t nr_blocks();
 
       void   reset_next_rep();
       size_t next_rep();
 
      private:
-      size_t       _size;
-      table_type*  _table;
-      blocks_type* _blocks;
-      bool         _haschanged;
-      size_t       _next_rep;
+      size_t root(size_t i);
+
+      size_t               _size;
+      table_type*          _table;
+      blocks_type*         _blocks;
+      bool                 _haschanged;
+      size_t               _next_rep;
+      size_t               _nr_blocks;
+      std::vector<uint8_t> _rank;
+      table_type           _rep;
     };
   }  // namespace detail
 }  // namespace libsemigroups
@@ -18,6 +18,9 @@
 
 #include "cong-intf.hpp"
 
+#include <algorithm>  // for max, min
+#include <thread>     // for thread::hardware_concurrency
+
 #include "constants.hpp"                // for UNDEFINED
 #include "froidure-pin-base.hpp"        // for FroidurePinBase
 #include "libsemigroups-debug.hpp"      // for LIBSEMIGROUPS_ASSERT
@@ -26,6 +29,11 @@
 #include "stl.hpp"                      // for detail::to_string
 
 namespace libsemigroups {
+  namespace {
+    // The number of elements of the parent FroidurePin whose words exist at
+    // any one time in CongruenceInterface::parent_class_indices_impl.
+    constexpr size_t parent_class_indices_batch_size = 16384;
+  }  // namespace
 
   class CongruenceInterface::LazyFroidurePin {
    public:
@@ -72,6 +80,41 @@ namespace libsemigroups {
     mutable std::shared_ptr<FpSemigroupInterface> _fp_semigroup;
   };
 
+  ////////////////////////////////////////////////////////////////////////////
+  // CongruenceInterface::NonTrivialClassIndices - member functions - public
+  ////////////////////////////////////////////////////////////////////////////
+
+  word_type CongruenceInterface::NonTrivialClassIndices::word(size_t i,
+                                                              size_t j) const {
+    if (i >= nr_classes()) {
+      LIBSEMIGROUPS_EXCEPTION("class index out of bounds, expected value in "
+                              "[0, %d), got %d",
+                              nr_classes(),
+                              i);
+    } else if (j >= size(i)) {
+      LIBSEMIGROUPS_EXCEPTION("element index out of bounds, expected value in "
+                              "[0, %d), got %d",
+                              size(i),
+                              j);
+    }
+    return _parent->factorisation(_elements[_first[i] + j]);
+  }
+
+  std::vector<word_type>
+  CongruenceInterface::NonTrivialClassIndices::words(size_t i) const {
+    if (i >= nr_classes()) {
+      LIBSEMIGROUPS_EXCEPTION("class index out of bounds, expected value in "
+                              "[0, %d), got %d",
+                              nr_classes(),
+                              i);
+    }
+    std::vector<word_type> result(size(i));
+    for (size_t j = 0; j < result.size(); ++j) {
+      _parent->factorisation(result[j], _elements[_first[i] + j]);
+    }
+    return result;
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   // CongruenceInterface - constructors + destructor - public
   ////////////////////////////////////////////////////////////////////////////
@@ -80,6 +123,7 @@ namespace libsemigroups {
       : Runner(),
         // Non-mutable
         _gen_pairs(),
+        _max_threads(std::max(1u, std::thread::hardware_concurrency())),
         _nr_gens(UNDEFINED),
         _parent(std::make_shared<LazyFroidurePin>()),
         _type(type),
@@ -88,7 +132,8 @@ namespace libsemigroups {
         _is_obviously_finite(false),
         _is_obviously_infinite(false),
         _quotient(nullptr),
-        _non_trivial_classes() {
+        _non_trivial_classes(),
+        _non_trivial_class_indices() {
     reset();
   }
 
@@ -108,6 +153,33 @@ namespace libsemigroups {
   // CongruenceInterface - non-pure virtual methods - public
   ////////////////////////////////////////////////////////////////////////////
 
+  std::vector<bool>
+  CongruenceInterface::contains(std::vector<relation_type> const& pairs) {
+    for (auto const& p : pairs) {
+      validate_word(p.first);
+      validate_word(p.second);
+    }
+    // Every congruence contains the pairs (u, u), and so the classes are
+    // only computed if there are other pairs.
+    std::vector<bool>      result(pairs.size(), true);
+    std::vector<word_type> words;
+    std::vector<size_t>    pos;
+    for (size_t i = 0; i < pairs.size(); ++i) {
+      if (pairs[i].first != pairs[i].second) {
+        words.push_back(pairs[i].first);
+        words.push_back(pairs[i].second);
+        pos.push_back(i);
+      }
+    }
+    if (!words.empty()) {
+      auto const index = words_to_class_indices_impl(words);
+      for (size_t i = 0; i < pos.size(); ++i) {
+        result[pos[i]] = (index[2 * i] == index[2 * i + 1]);
+      }
+    }
+    return result;
+  }
+
   tril CongruenceInterface::const_contains(word_type const& u,
                                            word_type const& v) const {
     validate_word(u);
@@ -259,6 +331,59 @@ namespace libsemigroups {
     return word_to_class_index_impl(word);
   }
 
+  std::vector<CongruenceInterface::class_index_type>
+  CongruenceInterface::words_to_class_indices(
+      std::vector<word_type> const& words) {
+    for (auto const& w : words) {
+      validate_word(w);
+    }
+    return words_to_class_indices_impl(words);
+  }
+
+  std::shared_ptr<CongruenceInterface::NonTrivialClassIndices const>
+  CongruenceInterface::non_trivial_class_indices() {
+    if (_non_trivial_class_indices != nullptr) {
+      return _non_trivial_class_indices;
+    } else if (!_parent->can_compute_froidure_pin()) {
+      LIBSEMIGROUPS_EXCEPTION("Cannot determine the parent FroidurePin and so "
+                              "cannot compute non-trivial classes!");
+    }
+    // The next line may trigger an infinite computation
+    auto         fp    = _parent->froidure_pin();
+    auto const   index = parent_class_indices_impl(*fp);
+    size_t const n     = nr_classes();
+    LIBSEMIGROUPS_ASSERT(index.size() == fp->size());
+
+    // The classes are stored in the order of their class indices, and the
+    // elements of each class in increasing order, which is the order used
+    // by non_trivial_classes_impl before the classes were stored this way.
+    std::vector<size_t> next(n, 0);
+    for (auto i : index) {
+      LIBSEMIGROUPS_ASSERT(i < n);
+      next[i]++;
+    }
+    auto ntc     = std::make_shared<NonTrivialClassIndices>();
+    ntc->_parent = fp;
+    ntc->_first.push_back(0);
+    for (size_t i = 0; i < n; ++i) {
+      if (next[i] > 1) {
+        size_t const size = next[i];
+        next[i]           = ntc->_first.back();
+        ntc->_first.push_back(next[i] + size);
+      } else {
+        next[i] = UNDEFINED;
+      }
+    }
+    ntc->_elements.resize(ntc->_first.back());
+    for (size_t pos = 0; pos < index.size(); ++pos) {
+      if (next[index[pos]] != UNDEFINED) {
+        ntc->_elements[next[index[pos]]++] = pos;
+      }
+    }
+    _non_trivial_class_indices = ntc;
+    return _non_trivial_class_indices;
+  }
+
   /////////////////////////////////////////////////////////////////////////
   // CongruenceInterface - non-virtual methods - protected
   /////////////////////////////////////////////////////////////////////////
@@ -304,29 +429,47 @@ namespace libsemigroups {
     // do nothing
   }
 
+  std::vector<CongruenceInterface::class_index_type>
+  CongruenceInterface::words_to_class_indices_impl(
+      std::vector<word_type> const& words) {
+    std::vector<class_index_type> result;
+    result.reserve(words.size());
+    for (auto const& w : words) {
+      result.push_back(word_to_class_index_impl(w));
+    }
+    return result;
+  }
+
   std::shared_ptr<CongruenceInterface::non_trivial_classes_type const>
   CongruenceInterface::non_trivial_classes_impl() {
-    if (!_parent->can_compute_froidure_pin()) {
-      LIBSEMIGROUPS_EXCEPTION("Cannot determine the parent FroidurePin and so "
-                              "cannot compute non-trivial classes!");
+    auto ntc    = non_trivial_class_indices();
+    auto result = std::make_shared<non_trivial_classes_type>();
+    result->reserve(ntc->nr_classes());
+    for (size_t i = 0; i < ntc->nr_classes(); ++i) {
+      result->push_back(ntc->words(i));
     }
-    // The next line may trigger an infinite computation
-    auto fp  = _parent->froidure_pin();
-    auto ntc = non_trivial_classes_type(nr_classes(), std::vector<word_type>());
-
-    word_type w;
-    for (size_t pos = 0; pos < fp->size(); ++pos) {
-      fp->factorisation(w, pos);
-      LIBSEMIGROUPS_ASSERT(word_to_class_index(w) < ntc.size());
-      ntc[word_to_class_index(w)].push_back(w);
-    }
-    ntc.erase(std::remove_if(ntc.begin(),
-                             ntc.end(),
-                             [](std::vector<word_type> const& klass) -> bool {
-                               return klass.size() <= 1;
-                             }),
-              ntc.end());
-    return std::make_shared<non_trivial_classes_type>(ntc);
+    return result;
+  }
+
+  std::vector<CongruenceInterface::class_index_type>
+  CongruenceInterface::parent_class_indices_impl(FroidurePinBase& fp) {
+    // The words are found in batches, so that the words for all of the
+    // elements of fp never exist at the same time.
+    std::vector<class_index_type> result;
+    result.reserve(fp.size());
+    std::vector<word_type> words;
+    for (size_t first = 0; first < fp.size();
+         first += parent_class_indices_batch_size) {
+      size_t const last
+          = std::min(first + parent_class_indices_batch_size, fp.size());
+      words.resize(last - first);
+      for (size_t pos = first; pos < last; ++pos) {
+        fp.factorisation(words[pos - first], pos);
+      }
+      auto const index = words_to_class_indices_impl(words);
+      result.insert(result.end(), index.cbegin(), index.cend());
+    }
+    return result;
   }
 
   /////////////////////////////////////////////////////////////////////////
@@ -343,6 +486,7 @@ namespace libsemigroups {
   void CongruenceInterface::reset() noexcept {
     // set_finished(false);
     _non_trivial_classes.reset();
+    _non_trivial_class_indices.reset();
     _init_ntc_done = false;
     _quotient.reset();
     _is_obviously_finite   = false;
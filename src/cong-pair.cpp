@@ -18,6 +18,14 @@
 
 #include "cong-pair.hpp"
 
+#include <memory>  // for shared_ptr, make_shared
+#include <vector>  // for vector
+
+#include "libsemigroups-debug.hpp"      // for LIBSEMIGROUPS_ASSERT
+#include "report.hpp"                   // for REPORT_DEFAULT
+#include "timer.hpp"                    // for Timer
+#include "todd-coxeter.hpp"             // for ToddCoxeter
+
 namespace libsemigroups {
   ////////////////////////////////////////////////////////////////////////
   // KnuthBendixCongruenceByPairs - constructors - public
@@ -76,4 +84,219 @@ namespace libsemigroups {
     this->internal_free(x);
     this->internal_free(y);
   }
+
+  ////////////////////////////////////////////////////////////////////////
+  // CayleyGraphCongruenceByPairs - constructors - public
+  ////////////////////////////////////////////////////////////////////////
+
+  CayleyGraphCongruenceByPairs::CayleyGraphCongruenceByPairs(
+      congruence_type                  type,
+      std::shared_ptr<FroidurePinBase> S) noexcept
+      : CongruenceInterface(type),
+        _class_lookup(),
+        _class_reps(),
+        _init_done(false),
+        _lookup(0),
+        _pairs_to_mult() {
+    set_nr_generators(S->nr_generators());
+    set_parent_froidure_pin(S);
+  }
+
+  ////////////////////////////////////////////////////////////////////////
+  // Runner - pure virtual member functions - private
+  ////////////////////////////////////////////////////////////////////////
+
+  void CayleyGraphCongruenceByPairs::run_impl() {
+    detail::Timer t;
+    auto          S = parent_froidure_pin();
+    if (!S->finished()) {
+      S->run_until([this]() -> bool { return stopped(); });
+      if (!S->finished()) {
+        report_why_we_stopped();
+        return;
+      }
+    }
+    init();
+
+    auto const&  right   = S->right_cayley_graph();
+    auto const&  left    = S->left_cayley_graph();
+    size_t const nr_gens = S->nr_generators();
+    bool const   lft     = (kind() == congruence_type::left
+                      || kind() == congruence_type::twosided);
+    bool const   rght    = (kind() == congruence_type::right
+                       || kind() == congruence_type::twosided);
+
+    while (!_pairs_to_mult.empty() && !stopped()) {
+      element_index_type const x = _pairs_to_mult.back().first;
+      element_index_type const y = _pairs_to_mult.back().second;
+      _pairs_to_mult.pop_back();
+      for (size_t a = 0; a < nr_gens; ++a) {
+        if (lft) {
+          unite(left.get(x, a), left.get(y, a));
+        }
+        if (rght) {
+          unite(right.get(x, a), right.get(y, a));
+        }
+      }
+      if (report()) {
+        REPORT_DEFAULT("%d elements in %d classes, %d pairs on the stack\n",
+                       _lookup.get_size(),
+                       _lookup.nr_blocks(),
+                       _pairs_to_mult.size());
+      }
+    }
+
+    if (_pairs_to_mult.empty()) {
+      // Make a normalised class lookup, the classes are numbered in the
+      // order of their least elements. Since _lookup.find(i) is the least
+      // element in the class of i, _lookup.find(i) <= i.
+      size_t const n = _lookup.get_size();
+      _class_lookup.resize(n);
+      _class_reps.clear();
+      _class_reps.reserve(_lookup.nr_blocks());
+      for (element_index_type i = 0; i < n; ++i) {
+        element_index_type r = _lookup.find(i);
+        if (r == i) {
+          _class_lookup[i] = _class_reps.size();
+          _class_reps.push_back(i);
+        } else {
+          LIBSEMIGROUPS_ASSERT(r < i);
+          _class_lookup[i] = _class_lookup[r];
+        }
+      }
+      std::vector<std::pair<element_index_type, element_index_type>>().swap(
+          _pairs_to_mult);
+    }
+
+    REPORT_DEFAULT("stopping with %d elements in %d classes\n",
+                   _lookup.get_size(),
+                   _lookup.nr_blocks());
+    REPORT_TIME(t);
+    report_why_we_stopped();
+  }
+
+  bool CayleyGraphCongruenceByPairs::finished_impl() const {
+    return _init_done && _pairs_to_mult.empty();
+  }
+
+  ////////////////////////////////////////////////////////////////////////
+  // CongruenceInterface - pure virtual member functions - private
+  ////////////////////////////////////////////////////////////////////////
+
+  word_type
+  CayleyGraphCongruenceByPairs::class_index_to_word_impl(class_index_type i) {
+    run();
+    LIBSEMIGROUPS_ASSERT(i < _class_reps.size());
+    return parent_froidure_pin()->factorisation(_class_reps[i]);
+  }
+
+  size_t CayleyGraphCongruenceByPairs::nr_classes_impl() {
+    run();
+    return _class_reps.size();
+  }
+
+  // The quotient is computed by a ToddCoxeter instance using the Cayley graph
+  // of the parent, so that this can be the winner of the race in a
+  // Congruence, without losing the ability to compute the quotient.
+  std::shared_ptr<FroidurePinBase>
+  CayleyGraphCongruenceByPairs::quotient_impl() {
+    using ToddCoxeter = congruence::ToddCoxeter;
+    ToddCoxeter tc(kind(),
+                   parent_froidure_pin(),
+                   ToddCoxeter::policy::froidure_pin::use_cayley_graph);
+    for (auto it = cbegin_generating_pairs(); it < cend_generating_pairs();
+         ++it) {
+      tc.add_pair(it->first, it->second);
+    }
+    return tc.quotient_froidure_pin();
+  }
+
+  CongruenceInterface::class_index_type
+  CayleyGraphCongruenceByPairs::word_to_class_index_impl(word_type const& w) {
+    run();
+    LIBSEMIGROUPS_ASSERT(finished());
+    return const_word_to_class_index(w);
+  }
+
+  ////////////////////////////////////////////////////////////////////////
+  // CongruenceInterface - non-pure virtual member functions - private
+  ////////////////////////////////////////////////////////////////////////
+
+  CongruenceInterface::class_index_type
+  CayleyGraphCongruenceByPairs::const_word_to_class_index(
+      word_type const& w) const {
+    if (!finished()) {
+      return UNDEFINED;
+    }
+    element_index_type pos = parent_froidure_pin()->word_to_pos(w);
+    LIBSEMIGROUPS_ASSERT(pos < _class_lookup.size());
+    return _class_lookup[pos];
+  }
+
+  std::shared_ptr<CongruenceInterface::non_trivial_classes_type const>
+  CayleyGraphCongruenceByPairs::non_trivial_classes_impl() {
+    run();
+    LIBSEMIGROUPS_ASSERT(finished());
+    // The index of every class of size at least 2 in the output
+    std::vector<size_t> ntc_index(_class_reps.size(), 0);
+    for (auto c : _class_lookup) {
+      ntc_index[c]++;
+    }
+    size_t nr_ntc = 0;
+    for (auto& c : ntc_index) {
+      c = (c > 1 ? nr_ntc++ : UNDEFINED);
+    }
+
+    auto ntc = non_trivial_classes_type(nr_ntc, std::vector<word_type>());
+    auto S   = parent_froidure_pin();
+    for (element_index_type i = 0; i < _class_lookup.size(); ++i) {
+      size_t c = ntc_index[_class_lookup[i]];
+      if (c != UNDEFINED) {
+        ntc[c].push_back(S->factorisation(i));
+      }
+    }
+    return std::make_shared<non_trivial_classes_type>(ntc);
+  }
+
+  bool CayleyGraphCongruenceByPairs::is_quotient_obviously_finite_impl() {
+    return parent_froidure_pin()->finished();
+  }
+
+  ////////////////////////////////////////////////////////////////////////
+  // CayleyGraphCongruenceByPairs - member functions - private
+  ////////////////////////////////////////////////////////////////////////
+
+  void CayleyGraphCongruenceByPairs::init() {
+    if (!_init_done) {
+      auto S = parent_froidure_pin();
+      LIBSEMIGROUPS_ASSERT(S->finished());
+      LIBSEMIGROUPS_ASSERT(_lookup.get_size() == 0);
+      for (size_t i = 0; i < S->size(); ++i) {
+        _lookup.add_entry();
+      }
+      for (auto it = cbegin_generating_pairs(); it < cend_generating_pairs();
+           ++it) {
+        unite(S->word_to_pos(it->first), S->word_to_pos(it->second));
+      }
+      _init_done = true;
+    }
+  }
+
+  // Unites the classes of x and y, and stores the pair (x, y) if they were
+  // not already in the same class. If x and y already belong to the same
+  // class, then every multiple of (x, y) is a consequence of the multiples of
+  // the pairs already stored, and so (x, y) need not be stored. Such pairs
+  // are also the ones worth sharing with the other runners in a cooperative
+  // race.
+  void CayleyGraphCongruenceByPairs::unite(element_index_type x,
+                                           element_index_type y) {
+    if (_lookup.find(x) != _lookup.find(y)) {
+      _lookup.unite(x, y);
+      _pairs_to_mult.emplace_back(x, y);
+      if (can_publish()) {
+        auto S = parent_froidure_pin();
+        publish_pair(S->factorisation(x), S->factorisation(y));
+      }
+    }
+  }
 }  // namespace libsemigroups
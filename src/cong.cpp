@@ -21,14 +21,19 @@
 
 #include "cong.hpp"
 
-#include <memory>  // for shared_ptr
+#include <algorithm>  // for min
+#include <memory>     // for shared_ptr
+#include <string>     // for string, to_string
+#include <typeinfo>   // for typeid
 
-#include "cong-pair.hpp"                // for KnuthBendixCongruenceByPairs
+#include "cong-pair.hpp"                // for CayleyGraphCongruenceByPairs, ...
+#include "constants.hpp"                // for POSITIVE_INFINITY
 #include "fpsemi.hpp"                   // for FpSemigroup
 #include "froidure-pin-base.hpp"        // for FroidurePinBase
 #include "knuth-bendix.hpp"             // for KnuthBendix
 #include "libsemigroups-debug.hpp"      // for LIBSEMIGROUPS_ASSERT
 #include "libsemigroups-exception.hpp"  // for LIBSEMIGROUPS_EXCEPTION
+#include "report.hpp"                   // for REPORT_DEFAULT
 #include "todd-coxeter.hpp"             // for ToddCoxeter
 
 namespace libsemigroups {
@@ -42,7 +47,13 @@ namespace libsemigroups {
   //////////////////////////////////////////////////////////////////////////
 
   Congruence::Congruence(congruence_type type, policy::runners p)
-      : CongruenceInterface(type), _race() {
+      : CongruenceInterface(type),
+        _adaptive(false),
+        _race(),
+        _relations_length(0) {
+    // Every runner computes the same congruence, and so the pairs found by
+    // one of them can be used by the others.
+    _race.cooperative(true);
     if (p == policy::runners::standard) {
       _race.add_runner(std::make_shared<ToddCoxeter>(type));
       if (type == congruence_type::twosided) {
@@ -63,6 +74,14 @@ namespace libsemigroups {
     tc->froidure_pin_policy(
         congruence::ToddCoxeter::policy::froidure_pin::use_cayley_graph);
     _race.add_runner(tc);
+    if (S->finished()) {
+      // If S is already fully enumerated, then enumerating the pairs using
+      // the Cayley graphs of S is linear in the size of S. This runner is
+      // added last, so that the runner used by a race with only one thread,
+      // and hence the numbering of the classes, does not depend on whether S
+      // is finished.
+      _race.add_runner(std::make_shared<CayleyGraphCongruenceByPairs>(type, S));
+    }
     set_nr_generators(S->nr_generators());
     set_parent_froidure_pin(S);
   }
@@ -70,6 +89,9 @@ namespace libsemigroups {
   Congruence::Congruence(congruence_type type, FpSemigroup& S)
       : Congruence(type, policy::runners::none) {
     set_nr_generators(S.alphabet().size());
+    for (auto it = S.cbegin_rules(); it != S.cend_rules(); ++it) {
+      _relations_length += it->first.size() + it->second.size();
+    }
     LIBSEMIGROUPS_ASSERT(!has_parent_froidure_pin());
     set_parent_froidure_pin(S);
     _race.max_threads(POSITIVE_INFINITY);
@@ -92,6 +114,15 @@ namespace libsemigroups {
             S.todd_coxeter()->froidure_pin(),
             congruence::ToddCoxeter::policy::froidure_pin::use_cayley_graph));
 
+        if (S.todd_coxeter()->froidure_pin()->finished()) {
+          // Method 2a: enumerate pairs using the Cayley graphs of S. This is
+          // only added if S.todd_coxeter()->froidure_pin() is already fully
+          // enumerated, since otherwise this and the runner of Method 2
+          // would both enumerate it at the same time.
+          _race.add_runner(std::make_shared<CayleyGraphCongruenceByPairs>(
+              type, S.todd_coxeter()->froidure_pin()));
+        }
+
         // Return here since we know that we can definitely complete at
         // this point.
         return;
@@ -112,6 +143,11 @@ namespace libsemigroups {
               S.knuth_bendix()->froidure_pin(),
               congruence::ToddCoxeter::policy::froidure_pin::use_cayley_graph));
 
+          // Method 3a: enumerate pairs using the Cayley graphs of
+          // S.knuth_bendix().froidure_pin(), similar to Method 2a.
+          _race.add_runner(std::make_shared<CayleyGraphCongruenceByPairs>(
+              type, S.knuth_bendix()->froidure_pin()));
+
           // Method 4: unlike with Method 2, this is not necessarily the same
           // as running Method 1, because the relations in S.knuth_bendix()
           // are likely not the same as those in S.todd_coxeter().
@@ -149,6 +185,77 @@ namespace libsemigroups {
     LIBSEMIGROUPS_ASSERT(!_race.empty());
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  // Runner - pure virtual member functions - private
+  ////////////////////////////////////////////////////////////////////////////
+
+  void Congruence::run_impl() {
+    if (memory_limit() != POSITIVE_INFINITY || cpu_time_limit() != FOREVER) {
+      // The budget of this applies to each of its runners separately.
+      _race.budget(memory_limit(), cpu_time_limit());
+    }
+    if (!_adaptive
+        || std::min(_race.number_runners(), _race.max_threads()) < 2) {
+      // If only one runner is run, then it always wins, and there is
+      // nothing to learn.
+      _race.run();
+      return;
+    }
+    auto&             history = detail::race_history();
+    std::string const key     = features();
+    size_t const      nr_wins = history.nr_winners(key);
+    if (nr_wins != 0) {
+      // Start the runners that have won for the same features, in order of
+      // how often they won, and the others only if those are slow.
+      _race.start_order(history.order(key, _race.number_runners()))
+          .initial_runners(nr_wins);
+      REPORT_DEFAULT("adaptive: starting %d of %d runners\n",
+                     nr_wins,
+                     _race.number_runners());
+    }
+    _race.run();
+    if (_race.finished()) {
+      history.add_win(key, _race.winner_index());
+    }
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  // Congruence - member functions - private
+  ////////////////////////////////////////////////////////////////////////////
+
+  // Returns a string containing some features of this, that are cheap to
+  // compute, and that two congruences must have in common for the runner
+  // that won for one to be considered likely to win for the other.
+  std::string Congruence::features() const {
+    // Sizes are only compared approximately.
+    auto bucket = [](size_t n) -> std::string {
+      size_t b = 0;
+      for (; n != 0; n >>= 1) {
+        ++b;
+      }
+      return std::to_string(b);
+    };
+    size_t length = _relations_length;
+    for (auto it = cbegin_generating_pairs(); it != cend_generating_pairs();
+         ++it) {
+      length += it->first.size() + it->second.size();
+    }
+    size_t size = 0;
+    if (has_parent_froidure_pin() && parent_froidure_pin()->finished()) {
+      size = parent_froidure_pin()->size();
+    }
+    std::string key = congruence_type_to_string(kind());
+    key += "|" + std::to_string(nr_generators());
+    key += "|" + bucket(length);
+    key += "|" + bucket(size);
+    for (auto const& rnnr : _race) {
+      auto& r = *rnnr;
+      key += "|";
+      key += typeid(r).name();
+    }
+    return key;
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   // CongruenceInterface - non-pure virtual member functions - public
   ////////////////////////////////////////////////////////////////////////////
@@ -237,6 +344,16 @@ namespace libsemigroups {
         ->word_to_class_index(word);
   }
 
+  std::vector<class_index_type>
+  Congruence::words_to_class_indices_impl(
+      std::vector<word_type> const& words) {
+    if (_race.winner() == nullptr) {
+      LIBSEMIGROUPS_EXCEPTION("cannot determine the class indices of words");
+    }
+    auto winner = static_cast<CongruenceInterface*>(_race.winner().get());
+    return winner->max_threads(max_threads()).words_to_class_indices(words);
+  }
+
   //////////////////////////////////////////////////////////////////////////
   // CongruenceInterface - non-pure virtual member functions - private
   //////////////////////////////////////////////////////////////////////////
@@ -259,6 +376,17 @@ namespace libsemigroups {
     return winner->non_trivial_classes();
   }
 
+  std::vector<class_index_type>
+  Congruence::parent_class_indices_impl(FroidurePinBase& fp) {
+    run();  // required so that state is correctly set.
+    auto winner = static_cast<CongruenceInterface*>(_race.winner().get());
+    if (winner == nullptr) {
+      // See the comment in non_trivial_classes_impl.
+      LIBSEMIGROUPS_EXCEPTION("cannot determine the non-trivial classes!");
+    }
+    return winner->max_threads(max_threads()).parent_class_indices_impl(fp);
+  }
+
   bool Congruence::is_quotient_obviously_infinite_impl() {
     for (auto runner : _race) {
       if (static_cast<CongruenceInterface*>(runner.get())
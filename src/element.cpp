@@ -31,7 +31,6 @@
 #include "semiring.hpp"  // for BooleanSemiring, Semiring (ptr only)
 
 namespace libsemigroups {
-
   ////////////////////////////////////////////////////////////////////////
   // BooleanMat
   ////////////////////////////////////////////////////////////////////////
@@ -139,10 +138,8 @@ namespace libsemigroups {
     _rank = rank;
   }
 
-  std::vector<std::vector<uint32_t>>
-      Bipartition::_fuse(std::thread::hardware_concurrency() + 1);
-  std::vector<std::vector<uint32_t>>
-      Bipartition::_lookup(std::thread::hardware_concurrency() + 1);
+  thread_local std::vector<uint32_t> Bipartition::_fuse;
+  thread_local std::vector<uint32_t> Bipartition::_lookup;
 
   void Bipartition::validate() const {
     size_t const n = _vector.size();
@@ -194,9 +191,7 @@ namespace libsemigroups {
   }
 
   // multiply x and y into this
-  void Bipartition::redefine(Element const& x,
-                             Element const& y,
-                             size_t         thread_id) {
+  void Bipartition::redefine(Element const& x, Element const& y, size_t) {
     LIBSEMIGROUPS_ASSERT(x.degree() == y.degree());
     LIBSEMIGROUPS_ASSERT(x.degree() == this->degree());
     LIBSEMIGROUPS_ASSERT(&x != this && &y != this);
@@ -212,8 +207,8 @@ namespace libsemigroups {
     uint32_t nrx(xx.const_nr_blocks());
     uint32_t nry(yy.const_nr_blocks());
 
-    std::vector<uint32_t>& fuse(_fuse.at(thread_id));
-    std::vector<uint32_t>& lookup(_lookup.at(thread_id));
+    std::vector<uint32_t>& fuse(_fuse);
+    std::vector<uint32_t>& lookup(_lookup);
 
     fuse.resize(nrx + nry);
     std::iota(fuse.begin(), fuse.end(), 0);
@@ -352,8 +347,7 @@ namespace libsemigroups {
     std::vector<bool>*     blocks_lookup = new std::vector<bool>();
 
     // must reindex the blocks
-    std::vector<uint32_t>& lookup
-        = _lookup[THREAD_ID_MANAGER.tid(std::this_thread::get_id())];
+    std::vector<uint32_t>& lookup = _lookup;
 
     lookup.clear();
     lookup.resize(this->nr_blocks(), UNDEFINED);
@@ -481,15 +475,11 @@ namespace libsemigroups {
   // Partitioned binary relations (PBRs)
   ////////////////////////////////////////////////////////////////////////
 
-  std::vector<std::vector<bool>>
-      PBR::_x_seen(std::thread::hardware_concurrency() + 1);
-  std::vector<std::vector<bool>>
-      PBR::_y_seen(std::thread::hardware_concurrency() + 1);
+  thread_local std::vector<bool> PBR::_x_seen;
+  thread_local std::vector<bool> PBR::_y_seen;
 
-  std::vector<detail::DynamicArray2<bool>>
-      PBR::_out(std::thread::hardware_concurrency() + 1);
-  std::vector<detail::DynamicArray2<bool>>
-      PBR::_tmp(std::thread::hardware_concurrency() + 1);
+  thread_local detail::DynamicArray2<bool> PBR::_out;
+  thread_local detail::DynamicArray2<bool> PBR::_tmp;
 
   PBR::PBR(size_t degree)
       : PBR(std::vector<std::vector<uint32_t>>(degree * 2,
@@ -592,7 +582,7 @@ namespace libsemigroups {
     return PBR(adj);
   }
 
-  void PBR::redefine(Element const& xx, Element const& yy, size_t thread_id) {
+  void PBR::redefine(Element const& xx, Element const& yy, size_t) {
     LIBSEMIGROUPS_ASSERT(xx.degree() == yy.degree());
     LIBSEMIGROUPS_ASSERT(xx.degree() == this->degree());
     LIBSEMIGROUPS_ASSERT(&xx != this && &yy != this);
@@ -602,10 +592,10 @@ namespace libsemigroups {
 
     uint32_t const n = this->degree();
 
-    std::vector<bool>&           x_seen = _x_seen.at(thread_id);
-    std::vector<bool>&           y_seen = _y_seen.at(thread_id);
-    detail::DynamicArray2<bool>& tmp    = _tmp.at(thread_id);
-    detail::DynamicArray2<bool>& out    = _out.at(thread_id);
+    std::vector<bool>&           x_seen = _x_seen;
+    std::vector<bool>&           y_seen = _y_seen;
+    detail::DynamicArray2<bool>& tmp    = _tmp;
+    detail::DynamicArray2<bool>& out    = _out;
 
     if (x_seen.size() != 2 * n) {
       x_seen.clear();
@@ -22,6 +22,7 @@
 
 #include <algorithm>  // for sort
 #include <string>     // for std::string
+#include <thread>     // for thread::hardware_concurrency
 
 #include "froidure-pin-base.hpp"        // for FroidurePinBase
 #include "libsemigroups-config.hpp"     // for LIBSEMIGROUPS_DEBUG
@@ -56,6 +57,7 @@ namespace libsemigroups {
         _identity(),
         _inverses(),
         _rules(),
+        _max_threads(std::max(1u, std::thread::hardware_concurrency())),
         // Mutable
         _froidure_pin(nullptr),
         _is_obviously_finite(false),
@@ -90,6 +92,54 @@ namespace libsemigroups {
   // FpSemigroupInterface - non-virtual member functions - public
   //////////////////////////////////////////////////////////////////////////////
 
+  std::vector<std::string>
+  FpSemigroupInterface::normal_forms(std::vector<std::string> const& words) {
+    for (auto const& w : words) {
+      validate_word(w);
+    }
+    return normal_forms_impl(words);
+  }
+
+  std::vector<word_type>
+  FpSemigroupInterface::normal_forms(std::vector<word_type> const& words) {
+    for (auto const& w : words) {
+      validate_word(w);
+    }
+    return normal_forms_impl(words);
+  }
+
+  std::vector<bool>
+  FpSemigroupInterface::equal_to(std::vector<rule_type> const& pairs) {
+    std::vector<std::string> words;
+    words.reserve(2 * pairs.size());
+    for (auto const& p : pairs) {
+      words.push_back(p.first);
+      words.push_back(p.second);
+    }
+    words = normal_forms(words);
+    std::vector<bool> result(pairs.size(), false);
+    for (size_t i = 0; i < pairs.size(); ++i) {
+      result[i] = (words[2 * i] == words[2 * i + 1]);
+    }
+    return result;
+  }
+
+  std::vector<bool>
+  FpSemigroupInterface::equal_to(std::vector<relation_type> const& pairs) {
+    std::vector<word_type> words;
+    words.reserve(2 * pairs.size());
+    for (auto const& p : pairs) {
+      words.push_back(p.first);
+      words.push_back(p.second);
+    }
+    words = normal_forms(words);
+    std::vector<bool> result(pairs.size(), false);
+    for (size_t i = 0; i < pairs.size(); ++i) {
+      result[i] = (words[2 * i] == words[2 * i + 1]);
+    }
+    return result;
+  }
+
   void FpSemigroupInterface::set_alphabet(std::string const& lphbt) {
     if (!_alphabet.empty()) {
       LIBSEMIGROUPS_EXCEPTION("the alphabet cannot be set more than once");
@@ -404,6 +454,26 @@ namespace libsemigroups {
     return true;
   }
 
+  std::vector<std::string> FpSemigroupInterface::normal_forms_impl(
+      std::vector<std::string> const& words) {
+    std::vector<std::string> result;
+    result.reserve(words.size());
+    for (auto const& w : words) {
+      result.push_back(normal_form(w));
+    }
+    return result;
+  }
+
+  std::vector<word_type>
+  FpSemigroupInterface::normal_forms_impl(std::vector<word_type> const& words) {
+    std::vector<word_type> result;
+    result.reserve(words.size());
+    for (auto const& w : words) {
+      result.push_back(normal_form(w));
+    }
+    return result;
+  }
+
   //////////////////////////////////////////////////////////////////////////////
   // FpSemigroupInterface - non-virtual member functions - private
   //////////////////////////////////////////////////////////////////////////////
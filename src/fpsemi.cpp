@@ -26,6 +26,7 @@
 #include "fpsemi.hpp"
 
 #include <string>  // for string
+#include <vector>  // for vector
 
 #include "froidure-pin-base.hpp"  // for FroidurePinBase
 #include "knuth-bendix.hpp"       // for KnuthBendix
@@ -40,12 +41,14 @@ namespace libsemigroups {
   //////////////////////////////////////////////////////////////////////////
 
   FpSemigroup::FpSemigroup() : FpSemigroupInterface(), _race() {
+    _race.cooperative(true);
     _race.add_runner(std::make_shared<ToddCoxeter>());
     _race.add_runner(std::make_shared<KnuthBendix>());
   }
 
   FpSemigroup::FpSemigroup(std::shared_ptr<FroidurePinBase> S)
       : FpSemigroupInterface(), _race() {
+    _race.cooperative(true);
     set_alphabet(S->nr_generators());
     _race.add_runner(std::make_shared<ToddCoxeter>(S));
     _race.add_runner(std::make_shared<KnuthBendix>(S));
@@ -124,4 +127,17 @@ namespace libsemigroups {
     return false;
   }
 
+  std::vector<std::string>
+  FpSemigroup::normal_forms_impl(std::vector<std::string> const& words) {
+    run();  // required so that the state is correct
+    auto winner = static_cast<FpSemigroupInterface*>(_race.winner().get());
+    return winner->max_threads(max_threads()).normal_forms(words);
+  }
+
+  std::vector<word_type>
+  FpSemigroup::normal_forms_impl(std::vector<word_type> const& words) {
+    run();  // required so that the state is correct
+    auto winner = static_cast<FpSemigroupInterface*>(_race.winner().get());
+    return winner->max_threads(max_threads()).normal_forms(words);
+  }
 }  // namespace libsemigroups
@@ -24,8 +24,81 @@
 #ifndef LIBSEMIGROUPS_SRC_KBE_IMPL_HPP_
 #define LIBSEMIGROUPS_SRC_KBE_IMPL_HPP_
 
+#include <memory>  // for unique_ptr
+#include <mutex>   // for mutex, lock_guard
+#include <vector>  // for vector
+
 namespace libsemigroups {
   namespace detail {
+    namespace {
+      // A thread-safe pool of blocks of memory of size sizeof(KBE). Blocks are
+      // allocated in chunks, and blocks returned to the pool are reused, but
+      // never freed.
+      class KBEPool {
+        union Block {
+          Block* next;
+          alignas(KBE) unsigned char data[sizeof(KBE)];
+        };
+
+        static constexpr size_t CHUNK_SIZE = 1024;
+
+       public:
+        KBEPool() : _chunks(), _free(nullptr), _mtx() {}
+
+        void* allocate() {
+          std::lock_guard<std::mutex> lg(_mtx);
+          if (_free == nullptr) {
+            _chunks.emplace_back(new Block[CHUNK_SIZE]);
+            Block* chunk = _chunks.back().get();
+            // Thread the free list through the new chunk in reverse, so that
+            // consecutive allocations have increasing addresses.
+            for (size_t i = CHUNK_SIZE; i > 0; --i) {
+              chunk[i - 1].next = _free;
+              _free             = &chunk[i - 1];
+            }
+          }
+          Block* b = _free;
+          _free    = b->next;
+          return b;
+        }
+
+        void deallocate(void* p) noexcept {
+          std::lock_guard<std::mutex> lg(_mtx);
+          Block* b = static_cast<Block*>(p);
+          b->next  = _free;
+          _free    = b;
+        }
+
+       private:
+        std::vector<std::unique_ptr<Block[]>> _chunks;
+        Block*                                _free;
+        std::mutex                            _mtx;
+      };
+
+      KBEPool& kbe_pool() {
+        // The pool is deliberately never destroyed, so that it outlives any
+        // static objects containing KBE's.
+        static KBEPool* pool = new KBEPool();
+        return *pool;
+      }
+    }  // namespace
+
+    ////////////////////////////////////////////////////////////////////////
+    // KBE - allocation - public
+    ////////////////////////////////////////////////////////////////////////
+
+    void* KBE::operator new(size_t size) {
+      (void) size;
+      LIBSEMIGROUPS_ASSERT(size == sizeof(KBE));
+      return kbe_pool().allocate();
+    }
+
+    void KBE::operator delete(void* ptr) noexcept {
+      if (ptr != nullptr) {
+        kbe_pool().deallocate(ptr);
+      }
+    }
+
     //////////////////////////////////////////////////////////////////////////////
     // KBE - constructors - private
     //////////////////////////////////////////////////////////////////////////////
@@ -40,8 +40,9 @@
 #include "knuth-bendix.hpp"          // for KnuthBendix, KnuthBendi...
 #include "libsemigroups-config.hpp"  // for LIBSEMIGROUPS_DEBUG
 #include "libsemigroups-debug.hpp"   // for LIBSEMIGROUPS_ASSERT
-#include "order.hpp"                 // for shortlex_compare
+#include "order.hpp"                 // for recursive_path_compare, short...
 #include "report.hpp"                // for REPORT
+#include "runner.hpp"                // for detail::CancellationToken
 #include "string.hpp"                // for detail::is_suffix, maximum_comm...
 #include "timer.hpp"                 // for detail::Timer
 #include "types.hpp"                 // for word_type
@@ -106,12 +107,13 @@ namespace libsemigroups {
           return _rhs;
         }
 
+        template <typename TOrder>
         void rewrite() {
           LIBSEMIGROUPS_ASSERT(_id != 0);
           _kbimpl->internal_rewrite(_lhs);
           _kbimpl->internal_rewrite(_rhs);
           // reorder if necessary
-          if (shortlex_compare(_lhs, _rhs)) {
+          if (TOrder()(_kbimpl, _lhs, _rhs)) {
             std::swap(_lhs, _rhs);
           }
         }
@@ -252,6 +254,36 @@ namespace libsemigroups {
         }
       };
 
+      // Reduction orderings, these are used as template parameters of the
+      // member functions that orient rules, so that the comparison is inlined
+      // there. The reduction ordering of the KnuthBendix is only looked up
+      // once on entry to such a member function.
+      struct ShortLexOrder {
+        bool operator()(KnuthBendixImpl const*,
+                        internal_string_type const* x,
+                        internal_string_type const* y) const {
+          return shortlex_compare(x, y);
+        }
+      };
+
+      struct WeightedShortLexOrder {
+        bool operator()(KnuthBendixImpl const*      kbimpl,
+                        internal_string_type const* x,
+                        internal_string_type const* y) const {
+          size_t const wx = kbimpl->weight(x);
+          size_t const wy = kbimpl->weight(y);
+          return wx < wy || (wx == wy && shortlex_compare(x, y));
+        }
+      };
+
+      struct RecursivePathOrder {
+        bool operator()(KnuthBendixImpl const*,
+                        internal_string_type const* x,
+                        internal_string_type const* y) const {
+          return recursive_path_compare(x, y);
+        }
+      };
+
       //////////////////////////////////////////////////////////////////////////
       // KnuthBendixImpl - friend declarations - private
       //////////////////////////////////////////////////////////////////////////
@@ -271,8 +303,16 @@ namespace libsemigroups {
             _inactive_rules(),
             _internal_is_same_as_external(false),
             _kb(kb),
+            _last_overlap_length(0),
+            _length_reducing(true),
             _min_length_lhs_rule(std::numeric_limits<size_t>::max()),
+            _next_memory_check(0),
+            _nr_discarded_rules(0),
+            _overlap_cap(POSITIVE_INFINITY),
             _overlap_measure(nullptr),
+            _pruned(false),
+            _resume_from(resume_point::none),
+            _resume_rule1(nullptr),
             _stack(),
             _tmp_word1(new internal_string_type()),
             _tmp_word2(new internal_string_type()),
@@ -398,17 +438,30 @@ namespace libsemigroups {
       //////////////////////////////////////////////////////////////////////////
 
       void add_rule(std::string const& p, std::string const& q) {
-        LIBSEMIGROUPS_ASSERT(p != q);
-        auto pp = new external_string_type(p);
-        auto qq = new external_string_type(q);
-        external_to_internal_string(*pp);
-        external_to_internal_string(*qq);
-        add_rule(new_rule(pp, qq));
+        switch (_kb->_settings._order) {
+          case policy::order::weighted_shortlex:
+            add_rule<WeightedShortLexOrder>(p, q);
+            break;
+          case policy::order::recursive:
+            add_rule<RecursivePathOrder>(p, q);
+            break;
+          case policy::order::shortlex:
+            add_rule<ShortLexOrder>(p, q);
+            break;
+        }
       }
 
       void add_rules(KnuthBendixImpl const* impl) {
-        for (Rule const* rule : impl->_active_rules) {
-          add_rule(new_rule(rule));
+        switch (_kb->_settings._order) {
+          case policy::order::weighted_shortlex:
+            add_rules<WeightedShortLexOrder>(impl);
+            break;
+          case policy::order::recursive:
+            add_rules<RecursivePathOrder>(impl);
+            break;
+          case policy::order::shortlex:
+            add_rules<ShortLexOrder>(impl);
+            break;
         }
       }
 
@@ -435,15 +488,123 @@ namespace libsemigroups {
         return rules;
       }
 
+      // Returns true if the external string u is less than v in the reduction
+      // ordering of the KnuthBendix. The letters of u and v must belong to
+      // the alphabet.
+      bool less(external_string_type u, external_string_type v) const {
+        external_to_internal_string(u);
+        external_to_internal_string(v);
+        return less(&u, &v);
+      }
+
       size_t nr_rules() const {
         return _active_rules.size();
       }
 
+      size_t nr_discarded_rules() const {
+        return _nr_discarded_rules;
+      }
+
+      // Returns an estimate of the number of bytes used by the active rules,
+      // the inactive rules, and the rules on the stack.
+      size_t memory_used() const {
+        // Every active rule is in a node of _active_rules and _set_rules.
+        size_t const active_overhead
+            = 3 * sizeof(void*) + 4 * sizeof(void*) + sizeof(RuleLookup);
+        // std::stack does not support iteration, and so the letters of the
+        // rules on the stack are not counted. The stack is empty except
+        // during a call to clear_stack.
+        size_t result = _active_rules.size() * active_overhead
+                        + _inactive_rules.size() * 3 * sizeof(void*)
+                        + _stack.size()
+                              * (sizeof(Rule*) + rule_memory_used(nullptr));
+        for (Rule const* rule : _active_rules) {
+          result += rule_memory_used(rule);
+        }
+        for (Rule const* rule : _inactive_rules) {
+          result += rule_memory_used(rule);
+        }
+        return result;
+      }
+
+      // Adds rules, whose sides must already be oriented with respect to the
+      // reduction ordering, directly to the active rules, without pushing
+      // them on the stack and reducing them. This is only used by
+      // KnuthBendix::load, for the active rules written by
+      // KnuthBendix::save. Returns false if the rules are not reduced, i.e.
+      // if the left hand side of a rule contains that of another rule, or
+      // the right hand side of a rule is not irreducible, in which case some
+      // of the rules may have been added.
+      bool set_reduced_rules(
+          std::vector<std::pair<external_string_type,
+                                external_string_type>> const& rules) {
+        LIBSEMIGROUPS_ASSERT(_active_rules.empty());
+        LIBSEMIGROUPS_ASSERT(_stack.empty());
+        for (auto const& rule : rules) {
+          Rule* r = new_rule(rule.first.cbegin(),
+                             rule.first.cend(),
+                             rule.second.cbegin(),
+                             rule.second.cend());
+          external_to_internal_string(*r->lhs());
+          external_to_internal_string(*r->rhs());
+          if (!_set_rules.emplace(RuleLookup(r)).second) {
+            // The left hand side of r is a suffix of that of another rule, or
+            // vice versa.
+            _inactive_rules.push_back(r);
+            return false;
+          }
+          activate_rule(r);
+        }
+        // Any word that contains a left hand side u of a rule, other than u
+        // itself, contains u without its first letter, or without its last
+        // letter, and so it suffices to check that these are irreducible.
+        internal_string_type w;
+        for (Rule const* rule : _active_rules) {
+          internal_string_type const& lhs = *rule->lhs();
+          for (auto const& v : {lhs.substr(1),
+                                lhs.substr(0, lhs.size() - 1),
+                                *rule->rhs()}) {
+            w = v;
+            internal_rewrite(&w);
+            if (w != v) {
+              return false;
+            }
+          }
+        }
+        return true;
+      }
+
+      // Mark the system as confluent without checking, this is only valid if
+      // the active rules are known to be confluent, for example, if they were
+      // read by KnuthBendix::load.
+      void set_confluent() {
+        LIBSEMIGROUPS_ASSERT(_stack.empty());
+        _confluent        = true;
+        _confluence_known = true;
+      }
+
      private:
       //////////////////////////////////////////////////////////////////////////
       // KnuthBendixImpl - methods for rules - private
       //////////////////////////////////////////////////////////////////////////
 
+      // Returns an estimate of the number of bytes used by rule, or by a rule
+      // with empty sides if rule is nullptr.
+      static size_t rule_memory_used(Rule const* rule) {
+        size_t result = sizeof(Rule) + 2 * sizeof(internal_string_type);
+        if (rule != nullptr) {
+          result += rule->lhs()->capacity() + rule->rhs()->capacity();
+        }
+        return result;
+      }
+
+      void delete_inactive_rules() {
+        for (Rule* rule : _inactive_rules) {
+          delete rule;
+        }
+        _inactive_rules.clear();
+      }
+
       Rule* new_rule() const {
         ++_total_rules;
         Rule* rule;
@@ -459,12 +620,13 @@ namespace libsemigroups {
         return rule;
       }
 
+      template <typename TOrder>
       Rule* new_rule(internal_string_type* lhs,
                      internal_string_type* rhs) const {
         Rule* rule = new_rule();
         delete rule->_lhs;
         delete rule->_rhs;
-        if (shortlex_compare(rhs, lhs)) {
+        if (TOrder()(this, rhs, lhs)) {
           rule->_lhs = lhs;
           rule->_rhs = rhs;
         } else {
@@ -491,6 +653,24 @@ namespace libsemigroups {
         return rule;
       }
 
+      template <typename TOrder>
+      void add_rule(std::string const& p, std::string const& q) {
+        LIBSEMIGROUPS_ASSERT(p != q);
+        auto pp = new external_string_type(p);
+        auto qq = new external_string_type(q);
+        external_to_internal_string(*pp);
+        external_to_internal_string(*qq);
+        add_rule<TOrder>(new_rule<TOrder>(pp, qq));
+      }
+
+      template <typename TOrder>
+      void add_rules(KnuthBendixImpl const* impl) {
+        for (Rule const* rule : impl->_active_rules) {
+          add_rule<TOrder>(new_rule(rule));
+        }
+      }
+
+      template <typename TOrder>
       void add_rule(Rule* rule) {
         LIBSEMIGROUPS_ASSERT(*rule->lhs() != *rule->rhs());
 #ifdef LIBSEMIGROUPS_VERBOSE
@@ -502,11 +682,22 @@ namespace libsemigroups {
           // The rules are not reduced, this should only happen if we are
           // calling add_rule from outside the class (i.e. we are initialising
           // the KnuthBendix).
-          push_stack(rule);
+          push_stack<TOrder>(rule);
           return;  // Do not activate or actually add the rule at this point
         }
+        activate_rule(rule);
+      }
+
+      // Activates rule, which must already belong to _set_rules, and adds it
+      // to _active_rules.
+      void activate_rule(Rule* rule) {
         rule->activate();
         _active_rules.push_back(rule);
+        if (_kb->can_publish() && !rule->lhs()->empty()
+            && !rule->rhs()->empty()) {
+          _kb->publish_pair(internal_string_to_word(*rule->lhs()),
+                            internal_string_to_word(*rule->rhs()));
+        }
         if (_next_rule_it1 == _active_rules.end()) {
           --_next_rule_it1;
         }
@@ -515,10 +706,11 @@ namespace libsemigroups {
         }
         _confluence_known = false;
         if (rule->lhs()->size() < _min_length_lhs_rule) {
-          // TODO(later) this is not valid when using non-length reducing
-          // orderings (such as RECURSIVE)
           _min_length_lhs_rule = rule->lhs()->size();
         }
+        if (rule->rhs()->size() > rule->lhs()->size()) {
+          _length_reducing = false;
+        }
         LIBSEMIGROUPS_ASSERT(_set_rules.size() == _active_rules.size());
       }
 
@@ -563,6 +755,15 @@ namespace libsemigroups {
         return w;
       }
 
+      // Returns the rewritten word w, using buf as temporary storage. This
+      // does not modify *this, and so can be called concurrently, provided
+      // that every thread uses its own buf.
+      word_type rewrite(word_type const& w, internal_string_type* buf) const {
+        word_to_internal_string(w, buf);
+        internal_rewrite(buf);
+        return internal_string_to_word(*buf);
+      }
+
       bool equal_to(external_string_type const& u,
                     external_string_type const& v) {
         if (u == v) {
@@ -616,13 +817,49 @@ namespace libsemigroups {
       //////////////////////////////////////////////////////////////////////////
       // KnuthBendixImpl - other methods - private
       //////////////////////////////////////////////////////////////////////////
-      // REWRITE_FROM_LEFT from Sims, p67
-      // Caution: this uses the assumption that rules are length reducing, if it
-      // is not, then u might not have sufficient space!
+
+      // Returns the sum of the weights of the letters in w, this is only used
+      // by WeightedShortLexOrder.
+      size_t weight(internal_string_type const* w) const {
+        LIBSEMIGROUPS_ASSERT(_kb->_settings._weights.size()
+                             == _kb->alphabet().size());
+        size_t result = 0;
+        for (internal_char_type const& c : *w) {
+          result += _kb->_settings._weights[internal_char_to_uint(c)];
+        }
+        return result;
+      }
+
+      // This is not for use where rules are oriented, since it switches on the
+      // reduction ordering every time it is called.
+      bool less(internal_string_type const* u,
+                internal_string_type const* v) const {
+        switch (_kb->_settings._order) {
+          case policy::order::weighted_shortlex:
+            return WeightedShortLexOrder()(this, u, v);
+          case policy::order::recursive:
+            return RecursivePathOrder()(this, u, v);
+          case policy::order::shortlex:
+            break;
+        }
+        return ShortLexOrder()(this, u, v);
+      }
+
       void internal_rewrite(internal_string_type* u) const {
         if (u->size() < _min_length_lhs_rule) {
           return;
+        } else if (_length_reducing) {
+          internal_rewrite_in_place(u);
+        } else {
+          internal_rewrite_with_stack(u);
         }
+      }
+
+      // REWRITE_FROM_LEFT from Sims, p67
+      // Caution: this uses the assumption that rules are length reducing, if it
+      // is not, then u might not have sufficient space!
+      void internal_rewrite_in_place(internal_string_type* u) const {
+        LIBSEMIGROUPS_ASSERT(u->size() >= _min_length_lhs_rule);
         internal_string_type::iterator const& v_begin = u->begin();
         internal_string_type::iterator        v_end
             = u->begin() + _min_length_lhs_rule - 1;
@@ -659,7 +896,35 @@ namespace libsemigroups {
         u->erase(v_end - u->cbegin());
       }
 
+      // REWRITE_FROM_LEFT from Sims, p67, for rules that are not length
+      // reducing, as can happen with the weighted short-lex and recursive path
+      // orderings. The letters still to be read are stored in reverse in the
+      // string w, so that the right hand side of a rule can be pushed onto it.
+      void internal_rewrite_with_stack(internal_string_type* u) const {
+        internal_string_type w(u->crbegin(), u->crend());
+        u->clear();
+        RuleLookup lookup;
+
+        while (!w.empty()) {
+          u->push_back(w.back());
+          w.pop_back();
+          auto it = _set_rules.find(lookup(u->begin(), u->end()));
+          if (it != _set_rules.end()) {
+            Rule const* rule = (*it).rule();
+            if (rule->lhs()->size() <= u->size()) {
+              LIBSEMIGROUPS_ASSERT(detail::is_suffix(u->cbegin(),
+                                                     u->cend(),
+                                                     rule->lhs()->cbegin(),
+                                                     rule->lhs()->cend()));
+              u->erase(u->size() - rule->lhs()->size());
+              w.append(rule->rhs()->crbegin(), rule->rhs()->crend());
+            }
+          }
+        }
+      }
+
       // TEST_2 from Sims, p76
+      template <typename TOrder>
       void clear_stack() {
         while (!_stack.empty() && !_kb->stopped()) {
 #ifdef LIBSEMIGROUPS_VERBOSE
@@ -671,10 +936,11 @@ namespace libsemigroups {
           LIBSEMIGROUPS_ASSERT(!rule1->active());
           LIBSEMIGROUPS_ASSERT(*rule1->lhs() != *rule1->rhs());
           // Rewrite both sides and reorder if necessary . . .
-          rule1->rewrite();
+          rule1->template rewrite<TOrder>();
 
           if (*rule1->lhs() != *rule1->rhs()) {
             internal_string_type const* lhs = rule1->lhs();
+            std::vector<Rule*>          rewrite_rhs;
             for (auto it = _active_rules.begin(); it != _active_rules.end();) {
               Rule* rule2 = const_cast<Rule*>(*it);
               if (rule2->lhs()->find(*lhs) != external_string_type::npos) {
@@ -684,14 +950,23 @@ namespace libsemigroups {
                 _stack.emplace(rule2);
               } else {
                 if (rule2->rhs()->find(*lhs) != external_string_type::npos) {
-                  internal_rewrite(rule2->rhs());
+                  rewrite_rhs.push_back(rule2);
                 }
                 ++it;
               }
             }
-            add_rule(rule1);
+            add_rule<TOrder>(rule1);
             // rule1 is activated, we do this after removing rules that rule1
-            // makes redundant to avoid failing to insert rule1 in _set_rules
+            // makes redundant to avoid failing to insert rule1 in _set_rules,
+            // and before rewriting the right hand sides containing the left
+            // hand side of rule1, since otherwise rule1 would not be used to
+            // rewrite them, and they would not be reduced.
+            for (Rule* rule2 : rewrite_rhs) {
+              internal_rewrite(rule2->rhs());
+              if (rule2->rhs()->size() > rule2->lhs()->size()) {
+                _length_reducing = false;
+              }
+            }
           } else {
             _inactive_rules.push_back(rule1);
           }
@@ -717,32 +992,39 @@ namespace libsemigroups {
       }
       // FIXME(later) there is a possibly infinite loop here clear_stack ->
       // push_stack -> clear_stack and so on
+      template <typename TOrder>
       void push_stack(Rule* rule) {
         LIBSEMIGROUPS_ASSERT(!rule->active());
         if (*rule->lhs() != *rule->rhs()) {
           _stack.emplace(rule);
-          clear_stack();
+          clear_stack<TOrder>();
         } else {
           _inactive_rules.push_back(rule);
         }
       }
 
       // OVERLAP_2 from Sims, p77
+      template <typename TOrder>
       void overlap(Rule const* u, Rule const* v) {
         LIBSEMIGROUPS_ASSERT(u->active() && v->active());
         auto limit
             = u->lhs()->cend() - std::min(u->lhs()->size(), v->lhs()->size());
-        int64_t u_id = u->id();
-        int64_t v_id = v->id();
+        int64_t      u_id = u->id();
+        int64_t      v_id = v->id();
+        size_t const max_overlap
+            = std::min(_kb->_settings._max_overlap, _overlap_cap);
+        bool const track = _kb->_settings._max_memory != POSITIVE_INFINITY;
         for (auto it = u->lhs()->cend() - 1;
              it > limit && u_id == u->id() && v_id == v->id() && !_kb->stopped()
-             && (_kb->_settings._max_overlap == POSITIVE_INFINITY
-                 || (*_overlap_measure)(u, v, it)
-                        <= _kb->_settings._max_overlap);
+             && (max_overlap == POSITIVE_INFINITY
+                 || (*_overlap_measure)(u, v, it) <= max_overlap);
              --it) {
           // Check if B = [it, u->lhs()->cend()) is a prefix of v->lhs()
           if (detail::is_prefix(
                   v->lhs()->cbegin(), v->lhs()->cend(), it, u->lhs()->cend())) {
+            if (track) {
+              _last_overlap_length = (*_overlap_measure)(u, v, it);
+            }
             // u = P_i = AB -> Q_i and v = P_j = BC -> Q_j
             // This version of new_rule does not reorder
             Rule* rule = new_rule(u->lhs()->cbegin(),
@@ -753,7 +1035,7 @@ namespace libsemigroups {
             rule->_rhs->append(v->lhs()->cbegin() + (u->lhs()->cend() - it),
                                v->lhs()->cend());  // rule = AQ_j -> Q_iC
             // rule is reordered during rewriting in clear_stack
-            push_stack(rule);
+            push_stack<TOrder>(rule);
             // It can be that the iterator `it` is invalidated by the call to
             // push_stack (i.e. if `u` is deactivated, then rewritten, actually
             // changed, and reactivated) and that is the reason for the checks
@@ -765,13 +1047,124 @@ namespace libsemigroups {
         }
       }
 
+      // Pushes the pairs published on the blackboard by the other runners in a
+      // cooperative race (if any) onto the stack. These pairs hold in the
+      // semigroup defined by the rules, and so this does not change the
+      // semigroup, but it can shortcut the completion. Like check_memory,
+      // this is only called from the main loop of knuth_bendix.
+      template <typename TOrder>
+      void consume_pairs() {
+        std::vector<relation_type> pairs;
+        if (!_kb->consume_pairs(pairs)) {
+          return;
+        }
+        size_t const n = _kb->alphabet().size();
+        auto valid = [n](word_type const& w) -> bool {
+          return std::all_of(
+              w.cbegin(), w.cend(), [n](letter_type a) { return a < n; });
+        };
+        for (auto const& p : pairs) {
+          if (!p.first.empty() && !p.second.empty() && valid(p.first)
+              && valid(p.second)) {
+            Rule* rule = new_rule();
+            word_to_internal_string(p.first, rule->_lhs);
+            word_to_internal_string(p.second, rule->_rhs);
+            // rule is reordered during rewriting in clear_stack
+            push_stack<TOrder>(rule);
+          }
+        }
+        REPORT_VERBOSE_DEFAULT("consumed %d pairs from the blackboard\n",
+                               pairs.size());
+      }
+
+      // Checks if the memory used by the rules exceeds the budget, and if it
+      // does, then frees the inactive rules, and applies the pruning policy.
+      // This is only called from the main loop of knuth_bendix, when there is
+      // no call to overlap in progress, and so it is safe to delete rules.
+      // Returns false if knuth_bendix should stop.
+      bool check_memory() {
+        size_t const max_memory = _kb->_settings._max_memory;
+        if (max_memory == POSITIVE_INFINITY
+            || _total_rules < _next_memory_check) {
+          return true;
+        }
+        // memory_used is linear in the number of rules, and so we only call it
+        // after a fixed proportion of that number of new rules were defined.
+        _next_memory_check
+            = _total_rules
+              + std::max(size_t(1024),
+                         (_active_rules.size() + _inactive_rules.size()) / 8);
+        if (memory_used() <= max_memory) {
+          return true;
+        }
+        // The inactive rules are only kept so that they can be reused.
+        delete_inactive_rules();
+        size_t bytes = memory_used();
+        if (bytes <= max_memory) {
+          return true;
+        }
+        if (_kb->_settings._prune_policy == policy::prune::longest_rules) {
+          // Discard rules until we are comfortably below the budget, so that
+          // this does not happen again too soon.
+          size_t const target = max_memory - max_memory / 4;
+          size_t       nr     = 0;
+          size_t       len    = 0;
+          while (bytes > target && !_active_rules.empty()) {
+            len = 0;
+            for (Rule const* rule : _active_rules) {
+              len = std::max(len, rule->lhs()->size());
+            }
+            for (auto it = _active_rules.begin(); it != _active_rules.end();) {
+              if ((*it)->lhs()->size() == len) {
+                Rule const* rule = *it;
+                it               = remove_rule(it);
+                bytes -= rule_memory_used(rule);
+                delete rule;
+                ++nr;
+              } else {
+                ++it;
+              }
+            }
+          }
+          _nr_discarded_rules += nr;
+          _pruned           = true;
+          _confluence_known = false;
+          REPORT_DEFAULT("memory budget of %d bytes exceeded, discarded %d "
+                         "rules with left hand side of length >= %d\n",
+                         max_memory,
+                         nr,
+                         len);
+          return !_active_rules.empty();
+        } else {
+          LIBSEMIGROUPS_ASSERT(_kb->_settings._prune_policy
+                               == policy::prune::overlap_length);
+          if (_last_overlap_length < _overlap_cap) {
+            _overlap_cap = _last_overlap_length;
+          } else if (_overlap_cap > 1) {
+            _overlap_cap--;
+          } else {
+            REPORT_DEFAULT("memory budget of %d bytes exceeded, stopping\n",
+                           max_memory);
+            return false;
+          }
+          REPORT_DEFAULT("memory budget of %d bytes exceeded, postponing "
+                         "overlaps of length > %d\n",
+                         max_memory,
+                         _overlap_cap);
+          return true;
+        }
+      }
+
      public:
       //////////////////////////////////////////////////////////////////////////
       // KnuthBendixImpl - main methods - public
       //////////////////////////////////////////////////////////////////////////
 
       bool confluent() const {
-        if (!_stack.empty()) {
+        if (!_stack.empty() || _pruned) {
+          // If rules were discarded, then the active rules might not define
+          // the same semigroup as the defining rules, and so we do not report
+          // that the system is confluent.
           return false;
         }
         if (!_confluence_known && (!_kb->running() || !_kb->stopped())) {
@@ -781,22 +1174,22 @@ namespace libsemigroups {
           internal_string_type word1;
           internal_string_type word2;
           size_t               seen = 0;
+          // Checking Runner::stopped requires reading the clock, and so we
+          // only do it every so often.
+          detail::CancellationToken cancelled(*_kb);
 
           for (auto it1 = _active_rules.cbegin();
-               it1 != _active_rules.cend()
-               && (!_kb->running() || !_kb->stopped());
+               it1 != _active_rules.cend() && !cancelled.stopped();
                ++it1) {
             Rule const* rule1 = *it1;
             // Seems to be much faster to do this in reverse.
             for (auto it2 = _active_rules.crbegin();
-                 it2 != _active_rules.crend()
-                 && (!_kb->running() || !_kb->stopped());
+                 it2 != _active_rules.crend() && !cancelled.stopped();
                  ++it2) {
               seen++;
               Rule const* rule2 = *it2;
               for (auto it = rule1->lhs()->cend() - 1;
-                   it >= rule1->lhs()->cbegin()
-                   && (!_kb->running() || !_kb->stopped());
+                   it >= rule1->lhs()->cbegin() && !cancelled.stopped();
                    --it) {
                 // Find longest common prefix of suffix B of rule1.lhs() defined
                 // by it and R = rule2.lhs()
@@ -833,55 +1226,118 @@ namespace libsemigroups {
                              _active_rules.size() * _active_rules.size());
             }
           }
-          if (_kb->running() && _kb->stopped()) {
+          if (cancelled.stopped()) {
+            // We did not check every overlap, and so we do not know.
             _confluence_known = false;
+            _confluent        = false;
           }
         }
         return _confluent;
       }
 
+      bool knuth_bendix() {
+        switch (_kb->_settings._order) {
+          case policy::order::weighted_shortlex:
+            return knuth_bendix<WeightedShortLexOrder>();
+          case policy::order::recursive:
+            return knuth_bendix<RecursivePathOrder>();
+          case policy::order::shortlex:
+            break;
+        }
+        return knuth_bendix<ShortLexOrder>();
+      }
+
       // KBS_2 from Sims, p77-78
+      template <typename TOrder>
       bool knuth_bendix() {
         detail::Timer timer;
-        if (_stack.empty() && confluent() && !_kb->stopped()) {
-          // _stack can be non-empty if non-reduced rules were used to define
-          // the KnuthBendix.  If _stack is non-empty, then it means that the
-          // rules in _active_rules might not define the system.
-          REPORT_DEFAULT("the system is confluent already\n");
-          return true;
-        } else if (_active_rules.size() >= _kb->_settings._max_rules) {
-          REPORT_DEFAULT("too many rules\n");
-          return false;
+        if (_resume_from == resume_point::none) {
+          _overlap_cap = POSITIVE_INFINITY;
+          if (_pruned) {
+            // The discarded rules are consequences of the defining rules, and
+            // so we add the defining rules again to be sure that the system
+            // defines the correct semigroup.
+            _pruned = false;
+            for (auto it = _kb->cbegin_rules(); it != _kb->cend_rules();
+                 ++it) {
+              if (it->first != it->second) {
+                add_rule<TOrder>(it->first, it->second);
+              }
+            }
+          }
+          if (_stack.empty() && confluent() && !_kb->stopped()) {
+            // _stack can be non-empty if non-reduced rules were used to
+            // define the KnuthBendix.  If _stack is non-empty, then it means
+            // that the rules in _active_rules might not define the system.
+            REPORT_DEFAULT("the system is confluent already\n");
+            return true;
+          } else if (_active_rules.size() >= _kb->_settings._max_rules) {
+            REPORT_DEFAULT("too many rules\n");
+            return false;
+          }
+          _next_rule_it1 = _active_rules.begin();
+          _resume_from   = resume_point::reduce;
+          _resume_rule1  = nullptr;
         }
-        // Reduce the rules
-        _next_rule_it1 = _active_rules.begin();
-        while (_next_rule_it1 != _active_rules.end() && !_kb->stopped()) {
-          // Copy *_next_rule_it1 and push_stack so that it is not modified by
-          // the call to clear_stack.
-          LIBSEMIGROUPS_ASSERT((*_next_rule_it1)->lhs()
-                               != (*_next_rule_it1)->rhs());
-          push_stack(new_rule(*_next_rule_it1));
-          ++_next_rule_it1;
-        }
-        _next_rule_it1 = _active_rules.begin();
-        size_t nr      = 0;
-        while (_next_rule_it1 != _active_rules.cend()
+        // If the previous call was stopped, then we continue from the rule it
+        // had reached, rather than reducing the rules and considering the
+        // overlaps from the start again.
+        if (_resume_from == resume_point::reduce) {
+          // Reduce the rules
+          while (_next_rule_it1 != _active_rules.end() && !_kb->stopped()) {
+            // Copy *_next_rule_it1 and push_stack so that it is not modified
+            // by the call to clear_stack.
+            LIBSEMIGROUPS_ASSERT((*_next_rule_it1)->lhs()
+                                 != (*_next_rule_it1)->rhs());
+            push_stack<TOrder>(new_rule(*_next_rule_it1));
+            ++_next_rule_it1;
+          }
+          if (!_kb->stopped()) {
+            _next_rule_it1 = _active_rules.begin();
+            _resume_from   = resume_point::overlap;
+          }
+        }
+        // The stack is non-empty if the previous call was stopped while
+        // clearing it.
+        clear_stack<TOrder>();
+        size_t nr = 0;
+        while ((_next_rule_it1 != _active_rules.cend()
+                || _resume_rule1 != nullptr)
                && _active_rules.size() < _kb->_settings._max_rules
                && !_kb->stopped()) {
-          Rule const* rule1 = *_next_rule_it1;
-          _next_rule_it2    = _next_rule_it1;
-          ++_next_rule_it1;
-          overlap(rule1, rule1);
-          while (_next_rule_it2 != _active_rules.begin() && rule1->active()) {
+          Rule const* rule1;
+          if (_resume_rule1 != nullptr) {
+            // Continue with the overlaps of the rule that the previous call
+            // was considering, starting with the pair it was considering.
+            rule1         = _resume_rule1;
+            _resume_rule1 = nullptr;
+            ++_next_rule_it2;
+          } else {
+            rule1          = *_next_rule_it1;
+            _next_rule_it2 = _next_rule_it1;
+            ++_next_rule_it1;
+            overlap<TOrder>(rule1, rule1);
+          }
+          // If this is stopped, then _next_rule_it2 points to the last rule
+          // considered, whose overlaps with rule1 might not all have been
+          // considered.
+          while (_next_rule_it2 != _active_rules.begin() && rule1->active()
+                 && !_kb->stopped()) {
             --_next_rule_it2;
             Rule const* rule2 = *_next_rule_it2;
-            overlap(rule1, rule2);
+            overlap<TOrder>(rule1, rule2);
             ++nr;
             if (rule1->active() && rule2->active()) {
               ++nr;
-              overlap(rule2, rule1);
+              overlap<TOrder>(rule2, rule1);
             }
           }
+          if (_kb->stopped()) {
+            if (rule1->active()) {
+              _resume_rule1 = rule1;
+            }
+            break;
+          }
           if (nr > _kb->_settings._check_confluence_interval) {
             if (confluent()) {
               break;
@@ -889,8 +1345,15 @@ namespace libsemigroups {
             nr = 0;
           }
           if (_next_rule_it1 == _active_rules.cend()) {
-            clear_stack();
+            clear_stack<TOrder>();
           }
+          consume_pairs<TOrder>();
+          if (!check_memory()) {
+            break;
+          }
+        }
+        if (!_kb->stopped()) {
+          _resume_from = resume_point::none;
         }
         // LIBSEMIGROUPS_ASSERT(_stack.empty());
         // Seems that the stack can be non-empty here in KnuthBendix 12, 14, 16
@@ -898,13 +1361,11 @@ namespace libsemigroups {
         bool ret;
         if (_kb->_settings._max_overlap == POSITIVE_INFINITY
             && _kb->_settings._max_rules == POSITIVE_INFINITY
+            && _overlap_cap == POSITIVE_INFINITY && !_pruned
             && !_kb->stopped()) {
           _confluence_known = true;
           _confluent        = true;
-          for (Rule* rule : _inactive_rules) {
-            delete rule;
-          }
-          _inactive_rules.clear();
+          delete_inactive_rules();
           ret = true;
         } else {
           ret = false;
@@ -991,16 +1452,28 @@ namespace libsemigroups {
       // KnuthBendixImpl - data - private
       ////////////////////////////////////////////////////////////////////////
 
+      // Where knuth_bendix should continue from, if it was stopped last time
+      // it was called.
+      enum class resume_point { none, reduce, overlap };
+
       std::list<Rule const*>           _active_rules;
       mutable std::atomic<bool>        _confluent;
       mutable std::atomic<bool>        _confluence_known;
       mutable std::list<Rule*>         _inactive_rules;
       bool                             _internal_is_same_as_external;
       KnuthBendix*                     _kb;
+      size_t                           _last_overlap_length;
+      bool                             _length_reducing;
       size_t                           _min_length_lhs_rule;
+      size_t                           _next_memory_check;
       std::list<Rule const*>::iterator _next_rule_it1;
       std::list<Rule const*>::iterator _next_rule_it2;
+      size_t                           _nr_discarded_rules;
+      size_t                           _overlap_cap;
       OverlapMeasure*                  _overlap_measure;
+      bool                             _pruned;
+      resume_point                     _resume_from;
+      Rule const*                      _resume_rule1;
       std::set<RuleLookup>             _set_rules;
       std::stack<Rule*>                _stack;
       internal_string_type*            _tmp_word1;
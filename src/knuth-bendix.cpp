@@ -16,8 +16,12 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
-#include <cstddef>  // for size_t
-#include <string>   // for string
+#include <algorithm>  // for equal, find, min
+#include <cstddef>    // for size_t
+#include <cstdint>    // for uint64_t
+#include <istream>    // for istream
+#include <ostream>    // for ostream
+#include <string>     // for string
 
 #include "cong-intf.hpp"    // for CongruenceInterface, CongruenceInterface::...
 #include "fpsemi-intf.hpp"  // for FpSemigroupInterface
@@ -28,6 +32,7 @@
 #include "libsemigroups-debug.hpp"      // for LIBSEMIGROUPS_ASSERT
 #include "libsemigroups-exception.hpp"  // for LIBSEMIGROUPS_EXCEPTION
 #include "obvinf.hpp"                   // for IsObviouslyInfinitePairs
+#include "parallel.hpp"                 // for detail::parallel_for
 #include "stl.hpp"                      // for detail::make_unique
 #include "types.hpp"                    // for word_type
 
@@ -37,8 +42,64 @@
 // KnuthBendixImpl.
 #include "kbe-impl.hpp"
 
+namespace {
+  // The minimum number of words that each thread rewrites in
+  // KnuthBendix::normal_forms_impl.
+  constexpr size_t normal_forms_min_block = 256;
+}  // namespace
+
 namespace libsemigroups {
   namespace fpsemigroup {
+    namespace {
+      // Helpers for KnuthBendix::save and KnuthBendix::load. Integers are
+      // written as 8 bytes in little-endian order, and strings as their
+      // length followed by their characters.
+      constexpr char     kb_file_magic[4] = {'L', 'S', 'K', 'B'};
+      constexpr uint64_t kb_file_version  = 2;
+
+      void write_uint(std::ostream& os, uint64_t val) {
+        char buf[8];
+        for (size_t i = 0; i < 8; ++i) {
+          buf[i] = static_cast<char>((val >> (8 * i)) & 0xFF);
+        }
+        os.write(buf, 8);
+      }
+
+      void write_string(std::ostream& os, std::string const& str) {
+        write_uint(os, str.size());
+        os.write(str.data(), str.size());
+      }
+
+      uint64_t read_uint(std::istream& is) {
+        char buf[8];
+        if (!is.read(buf, 8)) {
+          LIBSEMIGROUPS_EXCEPTION("unexpected end of input");
+        }
+        uint64_t val = 0;
+        for (size_t i = 0; i < 8; ++i) {
+          val |= static_cast<uint64_t>(static_cast<unsigned char>(buf[i]))
+                 << (8 * i);
+        }
+        return val;
+      }
+
+      std::string read_string(std::istream& is) {
+        uint64_t    len = read_uint(is);
+        std::string str;
+        // Read in chunks so that a corrupt length does not cause a huge
+        // allocation before the end of the input is detected.
+        char buf[4096];
+        while (len > 0) {
+          size_t n = std::min(len, static_cast<uint64_t>(sizeof(buf)));
+          if (!is.read(buf, n)) {
+            LIBSEMIGROUPS_EXCEPTION("unexpected end of input");
+          }
+          str.append(buf, n);
+          len -= n;
+        }
+        return str;
+      }
+    }  // namespace
 
     //////////////////////////////////////////////////////////////////////////
     // KnuthBendix::Settings - constructor - public
@@ -46,9 +107,13 @@ namespace libsemigroups {
 
     KnuthBendix::Settings::Settings()
         : _check_confluence_interval(4096),
+          _max_memory(POSITIVE_INFINITY),
           _max_overlap(POSITIVE_INFINITY),
           _max_rules(POSITIVE_INFINITY),
-          _overlap_policy(policy::overlap::ABC) {}
+          _order(policy::order::shortlex),
+          _overlap_policy(policy::overlap::ABC),
+          _prune_policy(policy::prune::longest_rules),
+          _weights() {}
 
     //////////////////////////////////////////////////////////////////////////
     // KnuthBendix - setters for Settings - public
@@ -61,6 +126,38 @@ namespace libsemigroups {
       return *this;
     }
 
+    KnuthBendix& KnuthBendix::order(policy::order val) {
+      if (val == _settings._order) {
+        return *this;
+      } else if (nr_rules() != 0) {
+        LIBSEMIGROUPS_EXCEPTION("cannot change the reduction ordering after "
+                                "rules have been added");
+      }
+      _settings._order = val;
+      return *this;
+    }
+
+    KnuthBendix& KnuthBendix::weights(std::vector<size_t> const& val) {
+      if (alphabet().empty()) {
+        LIBSEMIGROUPS_EXCEPTION("the alphabet must be set before the weights");
+      } else if (val.size() != alphabet().size()) {
+        LIBSEMIGROUPS_EXCEPTION("expected %d weights, found %d",
+                                alphabet().size(),
+                                val.size());
+      } else if (nr_rules() != 0) {
+        LIBSEMIGROUPS_EXCEPTION("cannot change the weights after rules have "
+                                "been added");
+      }
+      auto it = std::find(val.cbegin(), val.cend(), 0);
+      if (it != val.cend()) {
+        LIBSEMIGROUPS_EXCEPTION("invalid weight for letter %d, expected a "
+                                "positive integer, found 0",
+                                it - val.cbegin());
+      }
+      _settings._weights = val;
+      return *this;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     // KnuthBendix - constructors and destructor - public
     //////////////////////////////////////////////////////////////////////////
@@ -97,6 +194,11 @@ namespace libsemigroups {
         if (alphabet().empty()) {
           set_alphabet(kb.alphabet());
         }
+        // The reduction ordering must be set before the rules are added.
+        if (nr_rules() == 0) {
+          _settings._order   = kb._settings._order;
+          _settings._weights = kb._settings._weights;
+        }
         // throws if rules contain letters that are not in the alphabet.
         if (add) {
           add_rules(kb.active_rules());
@@ -124,6 +226,14 @@ namespace libsemigroups {
       return _impl->nr_rules();
     }
 
+    size_t KnuthBendix::nr_discarded_rules() const noexcept {
+      return _impl->nr_discarded_rules();
+    }
+
+    size_t KnuthBendix::memory_used() const {
+      return _impl->memory_used();
+    }
+
     bool KnuthBendix::equal_to(std::string const& u, std::string const& v) {
       validate_word(u);
       validate_word(v);
@@ -159,6 +269,113 @@ namespace libsemigroups {
       return os;
     }
 
+    void KnuthBendix::save(std::ostream& os) const {
+      if (!confluent()) {
+        LIBSEMIGROUPS_EXCEPTION("cannot save a KnuthBendix that is not "
+                                "confluent");
+      }
+      os.write(kb_file_magic, sizeof(kb_file_magic));
+      write_uint(os, kb_file_version);
+      write_string(os, alphabet());
+      write_uint(os, _settings._check_confluence_interval);
+      write_uint(os, _settings._max_overlap);
+      write_uint(os, _settings._max_rules);
+      write_uint(os, static_cast<uint64_t>(_settings._overlap_policy));
+      write_uint(os, static_cast<uint64_t>(_settings._order));
+      for (size_t const& w : _settings._weights) {
+        write_uint(os, w);
+      }
+      auto const rules = active_rules();
+      write_uint(os, rules.size());
+      for (auto const& rule : rules) {
+        write_string(os, rule.first);
+        write_string(os, rule.second);
+      }
+      if (!os) {
+        LIBSEMIGROUPS_EXCEPTION("failed to write to the output stream");
+      }
+    }
+
+    void KnuthBendix::load(std::istream& is) {
+      if (!alphabet().empty()) {
+        LIBSEMIGROUPS_EXCEPTION("cannot load into a KnuthBendix whose "
+                                "alphabet has already been set");
+      }
+      char magic[sizeof(kb_file_magic)];
+      if (!is.read(magic, sizeof(magic))
+          || !std::equal(magic, magic + sizeof(magic), kb_file_magic)) {
+        LIBSEMIGROUPS_EXCEPTION("invalid input, not written by "
+                                "KnuthBendix::save");
+      }
+      uint64_t const version = read_uint(is);
+      if (version != 1 && version != kb_file_version) {
+        LIBSEMIGROUPS_EXCEPTION("unsupported version %d, expected %d",
+                                version,
+                                kb_file_version);
+      }
+      std::string const lphbt      = read_string(is);
+      size_t const      intrvl     = read_uint(is);
+      size_t const      mx_overlap = read_uint(is);
+      size_t const      mx_rules   = read_uint(is);
+      uint64_t const    plcy       = read_uint(is);
+      if (plcy > static_cast<uint64_t>(policy::overlap::MAX_AB_BC)) {
+        LIBSEMIGROUPS_EXCEPTION("invalid overlap policy %d", plcy);
+      }
+      // Version 1 has no reduction ordering, and so is always short-lex.
+      uint64_t            ordr = 0;
+      std::vector<size_t> wghts;
+      if (version > 1) {
+        ordr = read_uint(is);
+        if (ordr > static_cast<uint64_t>(policy::order::recursive)) {
+          LIBSEMIGROUPS_EXCEPTION("invalid reduction ordering %d", ordr);
+        }
+        wghts.resize(lphbt.size());
+        for (auto& w : wghts) {
+          w = read_uint(is);
+        }
+      }
+      std::vector<rule_type> rules(read_uint(is));
+      for (auto& rule : rules) {
+        rule.first  = read_string(is);
+        rule.second = read_string(is);
+      }
+
+      // Everything is done in tmp first, so that this is not modified if the
+      // input is invalid, in which case tmp throws. This cannot throw, since
+      // the same is then done with the same input.
+      KnuthBendix tmp;
+      for (KnuthBendix* kb : {&tmp, this}) {
+        if (!lphbt.empty()) {
+          kb->set_alphabet(lphbt);
+          if (version > 1) {
+            kb->weights(wghts);
+          }
+        }
+        kb->order(static_cast<policy::order>(ordr));
+        kb->check_confluence_interval(intrvl);
+        kb->max_overlap(mx_overlap);
+        kb->max_rules(mx_rules);
+        kb->overlap_policy(static_cast<policy::overlap>(plcy));
+        for (auto const& rule : rules) {
+          // validate_word throws if rule contains a letter not in the
+          // alphabet, and active rules are always oriented so that lhs > rhs.
+          kb->validate_word(rule.first);
+          kb->validate_word(rule.second);
+          if (!kb->_impl->less(rule.second, rule.first)) {
+            LIBSEMIGROUPS_EXCEPTION("invalid rule, the left hand side must be "
+                                    "greater than the right hand side in the "
+                                    "reduction ordering");
+          }
+        }
+        // The rules are added directly to the active rules, and are not added
+        // to the defining rules.
+        if (!kb->_impl->set_reduced_rules(rules)) {
+          LIBSEMIGROUPS_EXCEPTION("invalid rules, the rules are not reduced");
+        }
+        kb->_impl->set_confluent();
+      }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     // KnuthBendix - main methods - public
     //////////////////////////////////////////////////////////////////////////
@@ -199,12 +416,22 @@ namespace libsemigroups {
     }
 
     bool KnuthBendix::is_obviously_infinite_impl() {
-      if (alphabet().size() > nr_rules()) {
+      auto first = cbegin_rules();
+      auto last  = cend_rules();
+      // If the active rules were read by load, then there are no defining
+      // rules, and the active rules define the semigroup instead.
+      std::vector<rule_type> const loaded
+          = (first == last ? active_rules() : std::vector<rule_type>());
+      if (!loaded.empty()) {
+        first = loaded.cbegin();
+        last  = loaded.cend();
+      }
+      if (alphabet().size() > static_cast<size_t>(last - first)) {
         return true;
       }
       detail::IsObviouslyInfinitePairs<char, std::string> ioi(
           alphabet().size());
-      ioi.add_rules(cbegin_rules(), cend_rules());
+      ioi.add_rules(first, last);
       return ioi.result();
     }
 
@@ -214,10 +441,12 @@ namespace libsemigroups {
 
     void KnuthBendix::set_alphabet_impl(std::string const& lphbt) {
       _impl->set_internal_alphabet(lphbt);
+      _settings._weights.assign(lphbt.size(), 1);
     }
 
-    void KnuthBendix::set_alphabet_impl(size_t) {
+    void KnuthBendix::set_alphabet_impl(size_t n) {
       _impl->set_internal_alphabet();
+      _settings._weights.assign(n, 1);
     }
 
     bool KnuthBendix::validate_identity_impl(std::string const& id) const {
@@ -233,6 +462,41 @@ namespace libsemigroups {
         return false;  // Don't add rules for the identity
       }
     }
+
+    // Rewriting is const, and so once run() has returned the words can be
+    // rewritten in parallel.
+    std::vector<std::string>
+    KnuthBendix::normal_forms_impl(std::vector<std::string> const& words) {
+      run();
+      std::vector<std::string> result(words);
+      detail::parallel_for(
+          result.size(),
+          max_threads(),
+          normal_forms_min_block,
+          [this, &result](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+              rewrite(&result[i]);
+            }
+          });
+      return result;
+    }
+
+    std::vector<word_type>
+    KnuthBendix::normal_forms_impl(std::vector<word_type> const& words) {
+      run();
+      std::vector<word_type> result(words.size());
+      detail::parallel_for(
+          result.size(),
+          max_threads(),
+          normal_forms_min_block,
+          [this, &words, &result](size_t first, size_t last) {
+            std::string buf;
+            for (size_t i = first; i < last; ++i) {
+              result[i] = _impl->rewrite(words[i], &buf);
+            }
+          });
+      return result;
+    }
   }  // namespace fpsemigroup
 
   namespace congruence {
@@ -335,6 +599,7 @@ namespace libsemigroups {
 
     void KnuthBendix::run_impl() {
       auto stppd = [this]() -> bool { return stopped(); };
+      _kb->blackboard(blackboard());
       _kb->run_until(stppd);
       report_why_we_stopped();
     }
@@ -23,39 +23,382 @@
 
 #include "race.hpp"
 
-#include <functional>  // for mem_fn
-#include <thread>
+#include <algorithm>   // for all_of, copy_n, count, max, min, stable_sort
+#include <functional>  // for function
+#include <numeric>     // for iota
+#include <thread>      // for thread::id, this_thread
 
+#include "constants.hpp"                // for POSITIVE_INFINITY, UNDEFINED
 #include "libsemigroups-exception.hpp"  // for LibsemigroupException
+#include "report.hpp"                   // for REPORT_DEFAULT, REPORT_TIME
 #include "runner.hpp"                   // for Runner
+#include "thread-pool.hpp"              // for TaskGroup, thread_pool
+#include "timer.hpp"                    // for Timer
 
 namespace libsemigroups {
   namespace detail {
+    namespace {
+      bool over_budget(Runner const& rnnr) {
+        return rnnr.over_memory_limit() || rnnr.over_cpu_time_limit();
+      }
+    }  // namespace
 
     Race::Race()
-        : _max_threads(std::thread::hardware_concurrency()),
+        : _blackboard(nullptr),
+          _cooperative(false),
+          _initial_runners(POSITIVE_INFINITY),
+          _max_threads(std::thread::hardware_concurrency()),
           _mtx(),
-          _winner(nullptr) {}
+          _next_stage(),
+          _nr_started(0),
+          _order(),
+          _stage_interval(std::chrono::milliseconds(100)),
+          _stop_latency(0),
+          _winner(nullptr),
+          _winner_index(UNDEFINED) {}
+
+    Race& Race::start_order(std::vector<size_t> const& val) {
+      if (_nr_started != 0) {
+        LIBSEMIGROUPS_EXCEPTION(
+            "the race has already started, cannot set the start order");
+      }
+      std::vector<bool> seen(_runners.size(), false);
+      if (val.size() != _runners.size()) {
+        LIBSEMIGROUPS_EXCEPTION("expected a vector of length %d, found %d",
+                                _runners.size(),
+                                val.size());
+      }
+      for (auto i : val) {
+        if (i >= _runners.size() || seen[i]) {
+          LIBSEMIGROUPS_EXCEPTION(
+              "expected a permutation of [0, %d)", _runners.size());
+        }
+        seen[i] = true;
+      }
+      _order = val;
+      return *this;
+    }
+
+    Race& Race::budget(size_t                   memory_limit,
+                       std::chrono::nanoseconds cpu_time_limit) {
+      for (auto const& rnnr : _runners) {
+        rnnr->memory_limit(memory_limit);
+        rnnr->cpu_time_limit(cpu_time_limit);
+      }
+      return *this;
+    }
 
     void Race::add_runner(std::shared_ptr<Runner> r) {
       if (_winner != nullptr) {
         LIBSEMIGROUPS_EXCEPTION("the race is over, cannot add runners");
       }
       _runners.push_back(r);
+      _order.clear();
     }
 
     void Race::run() {
       if (empty()) {
         LIBSEMIGROUPS_EXCEPTION("no runners given, cannot run");
       }
-      run_func(std::mem_fn(&Runner::run));
+      run_func(FOREVER);
+      if (_winner == nullptr
+          && std::all_of(_runners.cbegin(),
+                         _runners.cend(),
+                         [](std::shared_ptr<Runner> const& rnnr) {
+                           return over_budget(*rnnr);
+                         })) {
+        LIBSEMIGROUPS_EXCEPTION(
+            "every runner exceeded its memory or CPU time limit");
+      }
     }
 
     void Race::run_for(std::chrono::nanoseconds x) {
       if (empty()) {
         LIBSEMIGROUPS_EXCEPTION("no runners given, cannot run_for");
       }
-      run_func([&x](std::shared_ptr<Runner> r) -> void { r->run_for(x); });
+      run_func(x);
+    }
+
+    void Race::run_func(std::chrono::nanoseconds t) {
+      using clock = std::chrono::high_resolution_clock;
+      LIBSEMIGROUPS_ASSERT(!empty());
+      if (_winner != nullptr) {
+        return;
+      }
+      size_t nr_threads = std::min(_runners.size(), _max_threads);
+      if (nr_threads == 1) {
+        REPORT_DEFAULT("using 0 additional threads\n");
+        detail::Timer tmr;
+        // The runners after the first are only run if the ones before them
+        // exceed their budgets.
+        for (size_t i = 0; i < _runners.size() && _winner == nullptr; ++i) {
+          if (t == FOREVER) {
+            _runners[i]->run();
+          } else {
+            _runners[i]->run_for(t);
+          }
+          if (!over_budget(*_runners[i])) {
+            _winner       = _runners[i];
+            _winner_index = i;
+          } else {
+            REPORT_DEFAULT("#%d exceeded its budget, dropping it\n", i);
+          }
+        }
+        REPORT_TIME(tmr);
+        return;
+      }
+      for (size_t i = 0; i < _runners.size(); ++i) {
+        if (_runners[i]->finished()) {
+          REPORT_DEFAULT("using 0 additional threads\n");
+          _winner       = _runners[i];
+          _winner_index = i;
+          REPORT_DEFAULT("#%d is already finished!\n", i);
+          return;
+        }
+      }
+
+      std::vector<size_t> tids(_runners.size(), 0);
+
+      REPORT_DEFAULT("running %d runners using %d / %d threads in the pool\n",
+                     nr_threads,
+                     std::min(nr_threads, thread_pool().size()),
+                     thread_pool().size());
+      detail::Timer tmr;
+      LIBSEMIGROUPS_ASSERT(nr_threads != 0);
+
+      if (_cooperative) {
+        if (_blackboard == nullptr) {
+          _blackboard = std::make_shared<Blackboard>();
+        }
+        for (auto const& rnnr : _runners) {
+          rnnr->blackboard(_blackboard);
+        }
+      }
+
+      // The first time slice is short, so that small instances are not
+      // delayed, and then the slices double in length, so that the time
+      // spent resuming a runner is negligible.
+      std::chrono::nanoseconds const first_slice
+          = std::chrono::milliseconds(8);
+      std::chrono::nanoseconds const max_slice
+          = std::chrono::milliseconds(1024);
+
+      bool const        forever = (t == FOREVER);
+      clock::time_point deadline;
+      if (!forever) {
+        deadline = clock::now() + t;
+      }
+
+      // The runners are started in the order _order, at first only
+      // _initial_runners of them, and then one more every _stage_interval
+      // until nr_threads have been started. Which runners have been started
+      // is remembered between calls to this function, so that resuming the
+      // race does not restart the staging.
+      if (_order.empty()) {
+        _order.resize(_runners.size());
+        std::iota(_order.begin(), _order.end(), 0);
+      }
+      if (_nr_started == 0) {
+        _nr_started
+            = std::max(size_t(1), std::min(_initial_runners, nr_threads));
+        _next_stage = clock::now() + _stage_interval;
+      }
+      if (_nr_started < nr_threads) {
+        REPORT_DEFAULT("starting %d runners, and another every %s\n",
+                       _nr_started,
+                       detail::Timer::string(_stage_interval));
+      }
+
+      // The time when the winner finished, and killed the others, which is
+      // only valid if over is true; both are protected by _mtx.
+      bool              over = false;
+      clock::time_point over_time;
+      _stop_latency = std::chrono::nanoseconds(0);
+
+      TaskGroup                                            tg;
+      std::function<void(size_t, std::chrono::nanoseconds)> step;
+      step = [this,
+              &tids,
+              &tg,
+              &step,
+              &over,
+              &over_time,
+              nr_threads,
+              first_slice,
+              max_slice,
+              forever,
+              deadline](size_t pos, std::chrono::nanoseconds slice) {
+        tids[pos]  = THREAD_ID_MANAGER.tid(std::this_thread::get_id());
+        auto& rnnr = _runners[pos];
+        if (rnnr->dead()) {
+          return;
+        }
+        if (!forever) {
+          auto const now = clock::now();
+          if (now >= deadline) {
+            return;
+          }
+          slice = std::min(slice,
+                           std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               deadline - now));
+        }
+        try {
+          rnnr->run_for(slice);
+        } catch (std::exception const& e) {
+          REPORT_DEFAULT(
+              "exception thrown by #%d:\n%s\n", tids[pos], e.what());
+          return;
+        }
+        // Stop two Runner* objects from killing each other
+        {
+          std::lock_guard<std::mutex> lg(_mtx);
+          if (rnnr->dead()) {
+            if (over) {
+              // This was running when the winner finished, and so the race
+              // had to wait for it to stop.
+              _stop_latency = std::max(
+                  _stop_latency,
+                  std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      clock::now() - over_time));
+            }
+            return;
+          } else if (rnnr->finished()) {
+            over      = true;
+            over_time = clock::now();
+            for (size_t i = 0; i < _runners.size(); ++i) {
+              if (i != pos) {
+                _runners[i]->kill();
+              }
+            }
+            return;
+          } else if (over_budget(*rnnr)) {
+            // This is dropped from the race, and the next runner (if any)
+            // takes its thread, even if nr_threads runners were started.
+            REPORT_DEFAULT("#%d exceeded its %s limit, dropping it\n",
+                           pos,
+                           rnnr->over_memory_limit() ? "memory" : "CPU time");
+            if (_nr_started < _runners.size()) {
+              size_t const i = _order[_nr_started++];
+              REPORT_DEFAULT("starting runner #%d\n", i);
+              _next_stage = clock::now() + _stage_interval;
+              tg.run([&step, i, first_slice]() { step(i, first_slice); });
+            }
+            return;
+          } else if (_nr_started < nr_threads && clock::now() >= _next_stage) {
+            // None of the runners started so far has finished in time, and
+            // so we start another one.
+            size_t const i = _order[_nr_started++];
+            REPORT_DEFAULT("starting runner #%d\n", i);
+            _next_stage = clock::now() + _stage_interval;
+            tg.run([&step, i, first_slice]() { step(i, first_slice); });
+          }
+        }
+        slice = std::min(2 * slice, max_slice);
+        tg.run([&step, pos, slice]() { step(pos, slice); });
+      };
+
+      for (size_t j = 0; j < _nr_started; ++j) {
+        size_t const i = _order[j];
+        tg.run([&step, i, first_slice]() { step(i, first_slice); });
+      }
+      tg.wait();
+
+      REPORT_TIME(tmr);
+      if (over) {
+        REPORT_DEFAULT("the losers stopped within %s of the winner\n",
+                       detail::Timer::string(_stop_latency));
+      }
+      if (_blackboard != nullptr) {
+        REPORT_DEFAULT("%d pairs shared on the blackboard\n",
+                       _blackboard->nr_pairs());
+      }
+      for (auto method = _runners.begin(); method < _runners.end(); ++method) {
+        if ((*method)->finished()) {
+          LIBSEMIGROUPS_ASSERT(_winner == nullptr);
+          _winner       = *method;
+          _winner_index = method - _runners.begin();
+          REPORT_DEFAULT("#%d is the winner!\n", tids.at(_winner_index));
+          break;
+        }
+      }
+      if (_winner != nullptr) {
+        for (auto rnnr : _runners) {
+          if (rnnr != _winner) {
+            rnnr.reset();
+          }
+        }
+        _runners.clear();
+        _runners.push_back(_winner);
+        // The race is over, and so there's nothing more to share.
+        _winner->blackboard(nullptr);
+        _blackboard.reset();
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    // RaceHistory
+    ////////////////////////////////////////////////////////////////////////
+
+    void RaceHistory::add_win(std::string const& key, size_t i) {
+      std::lock_guard<std::mutex> lg(_mtx);
+      auto&                       wins = _wins[key];
+      if (i >= wins.size()) {
+        wins.resize(i + 1, 0);
+      }
+      ++wins[i];
+    }
+
+    size_t RaceHistory::nr_wins(std::string const& key, size_t i) const {
+      std::lock_guard<std::mutex> lg(_mtx);
+      auto                        it = _wins.find(key);
+      return (it == _wins.cend() || i >= it->second.size() ? 0
+                                                           : it->second[i]);
+    }
+
+    size_t RaceHistory::nr_winners(std::string const& key) const {
+      std::lock_guard<std::mutex> lg(_mtx);
+      auto                        it = _wins.find(key);
+      if (it == _wins.cend()) {
+        return 0;
+      }
+      return it->second.size()
+             - std::count(it->second.cbegin(), it->second.cend(), 0);
+    }
+
+    std::vector<size_t> RaceHistory::order(std::string const& key,
+                                           size_t nr_runners) const {
+      std::vector<size_t> wins(nr_runners, 0);
+      {
+        std::lock_guard<std::mutex> lg(_mtx);
+        auto                        it = _wins.find(key);
+        if (it != _wins.cend()) {
+          std::copy_n(it->second.cbegin(),
+                      std::min(nr_runners, it->second.size()),
+                      wins.begin());
+        }
+      }
+      std::vector<size_t> result(nr_runners, 0);
+      std::iota(result.begin(), result.end(), 0);
+      std::stable_sort(
+          result.begin(), result.end(), [&wins](size_t i, size_t j) {
+            return wins[i] > wins[j];
+          });
+      return result;
+    }
+
+    size_t RaceHistory::size() const {
+      std::lock_guard<std::mutex> lg(_mtx);
+      return _wins.size();
+    }
+
+    void RaceHistory::clear() {
+      std::lock_guard<std::mutex> lg(_mtx);
+      _wins.clear();
+    }
+
+    RaceHistory& race_history() {
+      static RaceHistory history;
+      return history;
     }
   }  // namespace detail
 }  // namespace libsemigroups
@@ -18,8 +18,79 @@
 
 #include "report.hpp"
 
+#include <algorithm>   // for max, push_heap, pop_heap
+#include <functional>  // for greater
+
+#include "thread-pool.hpp"  // for thread_pool
+
 namespace libsemigroups {
   detail::Reporter        REPORTER;
   detail::ThreadIdManager THREAD_ID_MANAGER;
 
+  namespace detail {
+    namespace {
+      // An object of this type is created in every thread, other than the
+      // main thread and the workers of thread_pool(), that is given a thread
+      // id, and it returns the id to THREAD_ID_MANAGER when the thread exits.
+      struct ThreadIdReleaser {
+        ~ThreadIdReleaser() {
+          if (registered) {
+            THREAD_ID_MANAGER.release(std::this_thread::get_id());
+          }
+        }
+        bool registered = false;
+      };
+
+      thread_local ThreadIdReleaser releaser;
+    }  // namespace
+
+    size_t ThreadIdManager::tid(std::thread::id t) {
+      ThreadPool& pool = thread_pool();
+      if (t == std::this_thread::get_id() && pool.is_worker()) {
+        return pool.index() + 1;
+      }
+      std::lock_guard<std::mutex> lg(_mtx);
+      auto                        it = _thread_map.find(t);
+      if (it != _thread_map.end()) {
+        return (*it).second;
+      }
+      // The ids 1, ..., pool.size() belong to the workers of the pool, and so
+      // any free id in this range (which can happen if the pool is resized)
+      // is discarded.
+      size_t const first_free = pool.size() + 1;
+      while (!_free_tids.empty() && _free_tids.front() < first_free) {
+        std::pop_heap(
+            _free_tids.begin(), _free_tids.end(), std::greater<size_t>());
+        _free_tids.pop_back();
+      }
+      size_t result;
+      if (!_free_tids.empty()) {
+        result = _free_tids.front();
+        std::pop_heap(
+            _free_tids.begin(), _free_tids.end(), std::greater<size_t>());
+        _free_tids.pop_back();
+      } else {
+        _next_tid = std::max(_next_tid, first_free);
+        result    = _next_tid++;
+      }
+      _thread_map.emplace(t, result);
+      if (t == std::this_thread::get_id()) {
+        releaser.registered = true;
+      }
+      return result;
+    }
+
+    void ThreadIdManager::release(std::thread::id t) {
+      std::lock_guard<std::mutex> lg(_mtx);
+      auto                        it = _thread_map.find(t);
+      if (it == _thread_map.end()) {
+        return;
+      }
+      _free_tids.push_back((*it).second);
+      std::push_heap(
+          _free_tids.begin(), _free_tids.end(), std::greater<size_t>());
+      _thread_map.erase(it);
+    }
+  }  // namespace detail
+
 }  // namespace libsemigroups
@@ -21,12 +21,43 @@
 
 #include "runner.hpp"
 
+#include <time.h>  // for clock_gettime, CLOCK_THREAD_CPUTIME_ID
+
+#include <algorithm>  // for max
+#include <thread>     // for get_id
+
 #include "report.hpp"  // for REPORT_DEFAULT
 #include "timer.hpp"   // for Timer::string
 
 namespace libsemigroups {
+  namespace {
+    // Returns the CPU time used by the calling thread, or, if this is not
+    // available, the wall-clock time.
+    std::chrono::nanoseconds thread_cpu_time() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+      timespec ts;
+      if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return std::chrono::seconds(ts.tv_sec)
+               + std::chrono::nanoseconds(ts.tv_nsec);
+      }
+#endif
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch());
+    }
+  }  // namespace
+
   Runner::Runner()
-      : _last_report(std::chrono::high_resolution_clock::now()),
+      : _blackboard(nullptr),
+        _blackboard_pos(0),
+        _cpu_start(0),
+        _cpu_thread(std::thread::id()),
+        _cpu_time(std::chrono::nanoseconds(0)),
+        _cpu_time_limit(FOREVER),
+        _last_report(std::chrono::high_resolution_clock::now()),
+        _memory_limit(POSITIVE_INFINITY),
+        _next_budget_check(std::chrono::high_resolution_clock::time_point()),
+        _over_cpu_time_limit(false),
+        _over_memory_limit(false),
         _report_time_interval(),
         _run_for(FOREVER),
         _start_time(),
@@ -48,11 +79,19 @@ namespace libsemigroups {
       set_state(state::running_for);
       _start_time = std::chrono::high_resolution_clock::now();
       _run_for    = val;
-      // run_impl should depend on the method timed_out!
-      run_impl();
+      try {
+        BudgetGuard bg(*this);
+        // run_impl should depend on the method timed_out!
+        run_impl();
+      } catch (LibsemigroupsException const& e) {
+        if (!dead()) {
+          set_state(state::not_running);
+        }
+        throw;
+      }
       if (!finished()) {
         if (!dead()) {
-          set_state(state::timed_out);
+          set_state(over_budget_state(state::timed_out));
         }
       } else {
         set_state(state::not_running);
@@ -84,8 +123,62 @@ namespace libsemigroups {
       REPORT_DEFAULT("killed!\n");
     } else if (timed_out()) {
       REPORT_DEFAULT("timed out!\n");
+    } else if (over_memory_limit()) {
+      REPORT_DEFAULT("exceeded the memory limit of %d bytes!\n",
+                     _memory_limit);
+    } else if (over_cpu_time_limit()) {
+      REPORT_DEFAULT("exceeded the CPU time limit of %s!\n",
+                     detail::Timer::string(_cpu_time_limit));
     }
     // Checking finished can be expensive, so we don't
   }
 
+  std::chrono::nanoseconds Runner::cpu_time() const {
+    // _cpu_start is only valid in the thread running this.
+    if (running() && std::this_thread::get_id() == _cpu_thread) {
+      return _cpu_time.load() + (thread_cpu_time() - _cpu_start);
+    }
+    return _cpu_time;
+  }
+
+  // Checks the CPU time used at most once every millisecond, and the memory
+  // used at most once every millisecond, or every 100 times the time that
+  // the last call to memory_used took, whichever is longer, so that
+  // checking the budget never takes more than about 1% of the run time.
+  bool Runner::check_budget() const {
+    using clock      = std::chrono::high_resolution_clock;
+    auto const start = clock::now();
+    if (start < _next_budget_check.load()) {
+      return false;
+    }
+    if (_cpu_time_limit != FOREVER && cpu_time() > _cpu_time_limit) {
+      _over_cpu_time_limit = true;
+      return true;
+    }
+    std::chrono::nanoseconds wait = std::chrono::milliseconds(1);
+    if (_memory_limit != POSITIVE_INFINITY) {
+      if (memory_used() > _memory_limit) {
+        _over_memory_limit = true;
+        return true;
+      }
+      wait = std::max(wait,
+                      std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          100 * (clock::now() - start)));
+    }
+    _next_budget_check = clock::now() + wait;
+    return false;
+  }
+
+  void Runner::start_budget() {
+    _cpu_thread          = std::this_thread::get_id();
+    _cpu_start           = thread_cpu_time();
+    _next_budget_check   = std::chrono::high_resolution_clock::time_point();
+    _over_cpu_time_limit = false;
+    _over_memory_limit   = false;
+  }
+
+  void Runner::stop_budget() {
+    _cpu_time = _cpu_time.load() + (thread_cpu_time() - _cpu_start);
+  }
+
 }  // namespace libsemigroups
@@ -0,0 +1,260 @@
+//
+// libsemigroups - C++ library for semigroups and monoids
+// Copyright (C) 2019 James D. Mitchell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// This file contains the implementations of the member functions of the
+// classes ThreadPool and TaskGroup.
+
+#include "thread-pool.hpp"
+
+#include <algorithm>  // for max
+#include <chrono>     // for milliseconds
+
+#include "libsemigroups-debug.hpp"      // for LIBSEMIGROUPS_ASSERT
+#include "libsemigroups-exception.hpp"  // for LIBSEMIGROUPS_EXCEPTION
+
+namespace libsemigroups {
+  namespace detail {
+    namespace {
+      // The pool that the calling thread is a worker of (if any), and the
+      // index of the calling thread in that pool.
+      thread_local ThreadPool const* this_pool  = nullptr;
+      thread_local size_t            this_index = 0;
+    }  // namespace
+
+    ////////////////////////////////////////////////////////////////////////
+    // ThreadPool - constructors + destructor - public
+    ////////////////////////////////////////////////////////////////////////
+
+    ThreadPool::ThreadPool(size_t nr_threads)
+        : _cv(),
+          _mtx(),
+          _next_queue(0),
+          _nr_queued(0),
+          _nr_running(0),
+          _queues(),
+          _stop(false),
+          _threads() {
+      start(nr_threads);
+    }
+
+    ThreadPool::~ThreadPool() {
+      stop();
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    // ThreadPool - member functions - public
+    ////////////////////////////////////////////////////////////////////////
+
+    void ThreadPool::resize(size_t nr_threads) {
+      if (is_worker()) {
+        LIBSEMIGROUPS_EXCEPTION(
+            "cannot resize a thread pool from one of its worker threads");
+      } else if (_nr_queued != 0 || _nr_running != 0) {
+        LIBSEMIGROUPS_EXCEPTION(
+            "cannot resize a thread pool with queued or running tasks");
+      }
+      stop();
+      start(nr_threads);
+    }
+
+    void ThreadPool::submit(task_type task, TaskGroup const* group) {
+      size_t const i = (this_pool == this ? this_index
+                                          : _next_queue++ % _queues.size());
+      {
+        std::lock_guard<std::mutex> lg(_queues[i]->_mtx);
+        _queues[i]->_tasks.push_back({std::move(task), group});
+        ++_nr_queued;
+      }
+      {
+        // Locking here ensures that a worker cannot miss the notification
+        // between checking _nr_queued and waiting.
+        std::lock_guard<std::mutex> lg(_mtx);
+      }
+      _cv.notify_one();
+    }
+
+    bool ThreadPool::run_pending_task(TaskGroup const* group) {
+      if (_nr_queued == 0) {
+        return false;
+      }
+      task_type    task;
+      bool         found = false;
+      size_t const n     = _queues.size();
+      size_t const first = (this_pool == this ? this_index : _next_queue % n);
+      for (size_t j = 0; j < n && !found; ++j) {
+        found = pop((first + j) % n, group, task);
+      }
+      if (found) {
+        task();
+        --_nr_running;
+      }
+      return found;
+    }
+
+    bool ThreadPool::is_worker() const noexcept {
+      return this_pool == this;
+    }
+
+    size_t ThreadPool::index() const noexcept {
+      LIBSEMIGROUPS_ASSERT(is_worker());
+      return this_index;
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    // ThreadPool - member functions - private
+    ////////////////////////////////////////////////////////////////////////
+
+    // Takes the first task in the i-th queue, if any.
+    bool ThreadPool::pop(size_t i, task_type& task) {
+      Queue&                      q = *_queues[i];
+      std::lock_guard<std::mutex> lg(q._mtx);
+      if (q._tasks.empty()) {
+        return false;
+      }
+      task = std::move(q._tasks.front()._func);
+      q._tasks.pop_front();
+      ++_nr_running;
+      --_nr_queued;
+      return true;
+    }
+
+    // Takes the first task in the i-th queue belonging to group, if any.
+    bool ThreadPool::pop(size_t i, TaskGroup const* group, task_type& task) {
+      Queue&                      q = *_queues[i];
+      std::lock_guard<std::mutex> lg(q._mtx);
+      for (auto it = q._tasks.begin(); it != q._tasks.end(); ++it) {
+        if (it->_group == group) {
+          task = std::move(it->_func);
+          q._tasks.erase(it);
+          ++_nr_running;
+          --_nr_queued;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    // Takes the first task in the first non-empty queue, starting after the
+    // i-th.
+    bool ThreadPool::steal(size_t i, task_type& task) {
+      size_t const n = _queues.size();
+      for (size_t j = 1; j <= n; ++j) {
+        if (pop((i + j) % n, task)) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    void ThreadPool::start(size_t nr_threads) {
+      LIBSEMIGROUPS_ASSERT(_threads.empty());
+      nr_threads = std::max(size_t(1), nr_threads);
+      _stop      = false;
+      _queues.clear();
+      for (size_t i = 0; i < nr_threads; ++i) {
+        _queues.emplace_back(new Queue());
+      }
+      for (size_t i = 0; i < nr_threads; ++i) {
+        _threads.emplace_back(&ThreadPool::worker, this, i);
+      }
+    }
+
+    void ThreadPool::stop() {
+      {
+        std::lock_guard<std::mutex> lg(_mtx);
+        _stop = true;
+      }
+      _cv.notify_all();
+      for (auto& t : _threads) {
+        t.join();
+      }
+      _threads.clear();
+    }
+
+    void ThreadPool::worker(size_t i) {
+      this_pool  = this;
+      this_index = i;
+      task_type task;
+      while (true) {
+        if (pop(i, task) || steal(i, task)) {
+          task();
+          task = nullptr;
+          --_nr_running;
+          continue;
+        }
+        std::unique_lock<std::mutex> lck(_mtx);
+        _cv.wait(lck, [this]() { return _stop || _nr_queued != 0; });
+        if (_stop) {
+          return;
+        }
+      }
+    }
+
+    ThreadPool& thread_pool() {
+      static ThreadPool pool(std::thread::hardware_concurrency());
+      return pool;
+    }
+
+    ////////////////////////////////////////////////////////////////////////
+    // TaskGroup - member functions
+    ////////////////////////////////////////////////////////////////////////
+
+    TaskGroup::~TaskGroup() {
+      wait_no_throw();
+    }
+
+    void TaskGroup::wait() {
+      wait_no_throw();
+      std::exception_ptr error = nullptr;
+      {
+        std::lock_guard<std::mutex> lg(_mtx);
+        std::swap(error, _error);
+      }
+      if (error != nullptr) {
+        std::rethrow_exception(error);
+      }
+    }
+
+    void TaskGroup::done(std::exception_ptr error) {
+      std::lock_guard<std::mutex> lg(_mtx);
+      if (error != nullptr && _error == nullptr) {
+        _error = error;
+      }
+      if (--_pending == 0) {
+        _cv.notify_all();
+      }
+    }
+
+    void TaskGroup::wait_no_throw() {
+      while (_pending != 0) {
+        if (!_pool.run_pending_task(this)) {
+          // The remaining tasks are running in other threads, but they might
+          // submit further tasks, and so we only wait for a short time before
+          // checking the queues again.
+          std::unique_lock<std::mutex> lck(_mtx);
+          _cv.wait_for(lck, std::chrono::milliseconds(1), [this]() {
+            return _pending == 0;
+          });
+        }
+      }
+      // Acquiring the lock ensures that the last call to done has returned,
+      // and so it is safe to destroy this.
+      std::lock_guard<std::mutex> lg(_mtx);
+    }
+  }  // namespace detail
+}  // namespace libsemigroups
@@ -21,11 +21,11 @@
 
 #include "todd-coxeter.hpp"
 
-#include <algorithm>  // for reverse
+#include <algorithm>  // for all_of, reverse
 #include <chrono>     // for nanoseconds etc
 #include <cstddef>    // for size_t
 #include <memory>     // for shared_ptr
-#include <numeric>    // for iota
+#include <numeric>    // for iota, partial_sum
 #include <random>     // for mt19937
 #include <string>     // for operator+, basic_string
 #include <utility>    // for pair
@@ -43,6 +43,7 @@
 #include "libsemigroups-debug.hpp"      // for LIBSEMIGROUPS_ASSERT
 #include "libsemigroups-exception.hpp"  // for LIBSEMIGROUPS_EXCEPTION
 #include "obvinf.hpp"                   // for IsObviouslyInfinite
+#include "parallel.hpp"                 // for detail::parallel_for
 #include "report.hpp"                   // for REPORT
 #include "stl.hpp"                      // for apply_permutation
 #include "tce.hpp"                      // for TCE
@@ -127,6 +128,18 @@ namespace {
   using class_index_type = libsemigroups::CongruenceInterface::class_index_type;
   using word_type        = libsemigroups::word_type;
 
+  // The minimum number of words that each thread processes in
+  // fpsemigroup::ToddCoxeter::normal_forms_impl.
+  constexpr size_t normal_forms_min_block = 256;
+
+  // The minimum number of words that each thread processes in
+  // congruence::ToddCoxeter::words_to_class_indices_impl.
+  constexpr size_t words_to_class_indices_min_block = 256;
+
+  // The minimum number of elements that each thread processes in
+  // congruence::ToddCoxeter::parent_class_indices_impl.
+  constexpr size_t parent_class_indices_min_block = 1024;
+
   void sort_generating_pairs(std::vector<class_index_type>& perm,
                              std::vector<word_type>&        vec) {
     // Apply the permutation (adapted from
@@ -478,6 +491,25 @@ namespace libsemigroups {
       return CongruenceInterface::contains(lhs, rhs);
     }
 
+    std::vector<bool>
+    ToddCoxeter::contains(std::vector<relation_type> const& pairs) {
+      for (auto const& p : pairs) {
+        validate_word(p.first);
+        validate_word(p.second);
+      }
+      init();
+      if (!_prefilled && _relations.empty() && _extra.empty()) {
+        // This defines the free semigroup
+        std::vector<bool> result;
+        result.reserve(pairs.size());
+        for (auto const& p : pairs) {
+          result.push_back(p.first == p.second);
+        }
+        return result;
+      }
+      return CongruenceInterface::contains(pairs);
+    }
+
     ////////////////////////////////////////////////////////////////////////
     // ToddCoxeter - member functions (init + settings) - public
     ////////////////////////////////////////////////////////////////////////
@@ -626,6 +658,14 @@ namespace libsemigroups {
       erase_free_cosets();
     }
 
+    size_t ToddCoxeter::memory_used() const {
+      // The coset table and the two tables of preimages have a row for every
+      // coset, as do the 3 vectors in CosetManager.
+      return (3 * _table.nr_cols() + 3) * coset_capacity() * sizeof(coset_type)
+             + _coinc.size() * sizeof(Coincidence)
+             + _deduct.size() * sizeof(Deduction);
+    }
+
     ////////////////////////////////////////////////////////////////////////
     // ToddCoxeter - member functions (state) - public
     ////////////////////////////////////////////////////////////////////////
@@ -742,7 +782,10 @@ namespace libsemigroups {
     }
 
     void ToddCoxeter::run_impl() {
-      if (is_quotient_obviously_infinite()) {
+      // Once the enumeration has started, the presentation and generating
+      // pairs cannot change, and so the check is not repeated when this is
+      // run for a time slice by a Race, or by sims().
+      if (_state <= state::initialized && is_quotient_obviously_infinite()) {
         LIBSEMIGROUPS_EXCEPTION(
             "there are infinitely many classes in the congruence and "
             "Todd-Coxeter will never terminate");
@@ -830,6 +873,91 @@ namespace libsemigroups {
       _table      = Table(n, 1, UNDEFINED);
     }
 
+    std::vector<coset_type> ToddCoxeter::words_to_class_indices_impl(
+        std::vector<word_type> const& words) {
+      std::vector<coset_type> result(words.size());
+      if (words.empty()) {
+        return result;
+      }
+      // The class index of the first word is found in this thread, since
+      // this runs the enumeration, and standardizes the table (if
+      // necessary). After this the table is only read, and so the class
+      // indices of the remaining words can be found concurrently.
+      result[0] = word_to_class_index_impl(words[0]);
+      detail::parallel_for(
+          words.size() - 1,
+          max_threads(),
+          words_to_class_indices_min_block,
+          [this, &words, &result](size_t first, size_t last) {
+            tau_interleaved(words, first + 1, last + 1, result);
+          });
+      return result;
+    }
+
+    // The coset of an element x of fp of length at least 2 is obtained from
+    // the coset of its prefix (or suffix, for a left congruence), which is
+    // shorter than x, by following a single edge in the table. So, if the
+    // elements are processed in order of increasing length, all of the
+    // elements of any given length can be processed concurrently.
+    std::vector<coset_type>
+    ToddCoxeter::parent_class_indices_impl(FroidurePinBase& fp) {
+      size_t const            n = fp.size();
+      std::vector<coset_type> result(n);
+      if (n == 0) {
+        return result;
+      }
+      // Run the enumeration and standardize as in word_to_class_index_impl.
+      word_to_class_index_impl(fp.factorisation(0));
+
+      // Sort the elements of fp by length. The elements of fp are usually,
+      // but not always (for example, after closure), already sorted by
+      // length.
+      std::vector<size_t> first(fp.current_max_word_length() + 2, 0);
+      for (size_t pos = 0; pos < n; ++pos) {
+        first[fp.length_const(pos) + 1]++;
+      }
+      std::partial_sum(first.cbegin(), first.cend(), first.begin());
+      std::vector<size_t> sorted(n);
+      {
+        std::vector<size_t> next(first);
+        for (size_t pos = 0; pos < n; ++pos) {
+          sorted[next[fp.length_const(pos)]++] = pos;
+        }
+      }
+
+      bool const left = (kind() == congruence_type::left);
+      for (size_t len = 1; len < first.size() - 1; ++len) {
+        size_t const offset = first[len];
+        detail::parallel_for(
+            first[len + 1] - offset,
+            max_threads(),
+            parent_class_indices_min_block,
+            [this, &fp, &result, &sorted, left, len, offset](size_t i,
+                                                             size_t j) {
+              for (; i < j; ++i) {
+                size_t const pos = sorted[offset + i];
+                coset_type   c   = _id_coset;
+                if (left) {
+                  if (len > 1) {
+                    c = result[fp.suffix(pos)];
+                  }
+                  result[pos] = _table.get(c, fp.first_letter(pos));
+                } else {
+                  if (len > 1) {
+                    c = result[fp.prefix(pos)];
+                  }
+                  result[pos] = _table.get(c, fp.final_letter(pos));
+                }
+              }
+            });
+      }
+      for (auto& c : result) {
+        LIBSEMIGROUPS_ASSERT(is_active_coset(c) && c != _id_coset);
+        c--;
+      }
+      return result;
+    }
+
     ////////////////////////////////////////////////////////////////////////
     // ToddCoxeter - member functions (validation) - private
     ////////////////////////////////////////////////////////////////////////
@@ -1033,6 +1161,40 @@ namespace libsemigroups {
     // ToddCoxeter - member functions (cosets) - private
     ////////////////////////////////////////////////////////////////////////
 
+    // The words are traced in groups, one letter of every word in the group
+    // at a time, rather than one word after another. The look ups in the
+    // table for the different words in a group do not depend on each other,
+    // and so the processor can overlap them, rather than waiting for each
+    // look up (which is usually a cache miss if the table is large) to
+    // finish before starting the next.
+    void ToddCoxeter::tau_interleaved(std::vector<word_type> const& words,
+                                      size_t                        first,
+                                      size_t                        last,
+                                      std::vector<coset_type>& result) const {
+      constexpr size_t width = 8;
+      bool const       left  = (kind() == congruence_type::left);
+      coset_type       c[width];
+      for (; first < last; first += width) {
+        size_t const n   = std::min(width, last - first);
+        size_t       len = 0;
+        for (size_t k = 0; k < n; ++k) {
+          c[k] = _id_coset;
+          len  = std::max(len, words[first + k].size());
+        }
+        for (size_t i = 0; i < len; ++i) {
+          for (size_t k = 0; k < n; ++k) {
+            word_type const& w = words[first + k];
+            if (i < w.size() && c[k] != UNDEFINED) {
+              c[k] = _table.get(c[k], left ? w[w.size() - i - 1] : w[i]);
+            }
+          }
+        }
+        for (size_t k = 0; k < n; ++k) {
+          result[first + k] = (c[k] == UNDEFINED ? c[k] : c[k] - 1);
+        }
+      }
+    }
+
     coset_type ToddCoxeter::new_coset() {
       if (!has_free_cosets()) {
         reserve(2 * coset_capacity());
@@ -1108,6 +1270,44 @@ namespace libsemigroups {
       }
     }
 
+    // Pushes the identity coset through the pairs published on the
+    // blackboard by the other runners in a cooperative race (if any). These
+    // pairs hold in the congruence being computed, and so this does not change
+    // the result, but it can cause coincidences much earlier than they would
+    // otherwise be found.
+    void ToddCoxeter::process_shared_pairs() {
+      std::vector<relation_type> pairs;
+      if (!consume_pairs(pairs)) {
+        return;
+      }
+      size_t const n     = nr_generators();
+      auto         valid = [n](word_type const& w) -> bool {
+        return !w.empty()
+               && std::all_of(
+                   w.cbegin(), w.cend(), [n](letter_type a) { return a < n; });
+      };
+      bool const stack_deductions = _state == state::felsch && !_prefilled;
+      for (auto& p : pairs) {
+        if (!valid(p.first) || !valid(p.second)) {
+          continue;
+        }
+        if (kind() == congruence_type::left) {
+          std::reverse(p.first.begin(), p.first.end());
+          std::reverse(p.second.begin(), p.second.end());
+        }
+        if (stack_deductions) {
+          push_definition_hlt<StackDeductions, ProcessCoincidences>(
+              _id_coset, p.first, p.second);
+          process_deductions();
+        } else {
+          push_definition_hlt<DoNotStackDeductions, ProcessCoincidences>(
+              _id_coset, p.first, p.second);
+        }
+      }
+      REPORT_VERBOSE_DEFAULT("consumed %d pairs from the blackboard\n",
+                             pairs.size());
+    }
+
     ////////////////////////////////////////////////////////////////////////
     // ToddCoxeter - member functions (main strategies) - private
     ////////////////////////////////////////////////////////////////////////
@@ -1160,6 +1360,7 @@ namespace libsemigroups {
             standardize_immediate(_current, t, a);
           }
         }
+        process_shared_pairs();
         if (report()) {
           TODD_COXETER_REPORT_COSETS()
         }
@@ -1248,6 +1449,7 @@ namespace libsemigroups {
             standardize_immediate(_current, t, x);
           }
         }
+        process_shared_pairs();
         if (report()) {
           TODD_COXETER_REPORT_COSETS()
         }
@@ -1440,8 +1642,15 @@ namespace libsemigroups {
       std::vector<coset_type> q(coset_capacity(), 0);
       std::iota(q.begin(), q.end(), 0);
 
+      detail::CancellationToken cancelled(*this);
+
       // Perform a DFS through the _table
       while (s <= t) {
+        if (cancelled.stopped()) {
+          // The table has not been changed yet, only p and q.
+          REPORT("stopped\n").prefix().flush_right().flush();
+          return;
+        }
         if (standardize_deferred(p, q, s, t, x)) {
           s = t;
           x = 0;
@@ -1473,7 +1682,13 @@ namespace libsemigroups {
       std::vector<coset_type> q(coset_capacity(), 0);
       std::iota(q.begin(), q.end(), 0);
 
+      detail::CancellationToken cancelled(*this);
+
       for (coset_type s = 0; s <= t; ++s) {
+        if (cancelled.stopped()) {
+          REPORT("stopped\n").prefix().flush_right().flush();
+          return;
+        }
         for (letter_type x = 0; x < n; ++x) {
           standardize_deferred(p, q, s, t, x);
         }
@@ -1555,6 +1770,8 @@ namespace libsemigroups {
       std::vector<coset_type> q(coset_capacity(), 0);
       std::iota(q.begin(), q.end(), 0);
 
+      detail::CancellationToken cancelled(*this);
+
       while (s <= t) {
         if (standardize_deferred(p, q, s, t, 0)) {
           out.push_back(word_type(t, a));
@@ -1565,6 +1782,10 @@ namespace libsemigroups {
       bool new_generator = true;
       int  x, u, w;
       while (a < n && t < nr_cosets_active() - 1) {
+        if (cancelled.stopped()) {
+          REPORT("stopped\n").prefix().flush_right().flush();
+          return;
+        }
         if (new_generator) {
           w = -1;  // -1 is the empty word
           if (standardize_deferred(p, q, 0, t, a)) {
@@ -1927,4 +2148,47 @@ namespace libsemigroups {
 
 #endif
   }  // namespace congruence
+
+  ////////////////////////////////////////////////////////////////////////
+  // fpsemigroup::ToddCoxeter - specialisations - private
+  ////////////////////////////////////////////////////////////////////////
+
+  template <>
+  std::vector<std::string> fpsemigroup::ToddCoxeter::normal_forms_impl(
+      std::vector<std::string> const& words) {
+    std::vector<word_type> wwords;
+    wwords.reserve(words.size());
+    for (auto const& w : words) {
+      wwords.push_back(string_to_word(w));
+    }
+    wwords = normal_forms_impl(wwords);
+    std::vector<std::string> result;
+    result.reserve(words.size());
+    for (auto const& w : wwords) {
+      result.push_back(word_to_string(w));
+    }
+    return result;
+  }
+
+  template <>
+  std::vector<word_type> fpsemigroup::ToddCoxeter::normal_forms_impl(
+      std::vector<word_type> const& words) {
+    std::vector<word_type> result(words.size());
+    if (words.empty()) {
+      return result;
+    }
+    // The first normal form is found in this thread, since this runs the
+    // enumeration and standardizes the table (if necessary), after which the
+    // remaining normal forms can be found concurrently.
+    result[0] = normal_form(words[0]);
+    detail::parallel_for(words.size() - 1,
+                         max_threads(),
+                         normal_forms_min_block,
+                         [this, &words, &result](size_t first, size_t last) {
+                           for (size_t i = first + 1; i <= last; ++i) {
+                             result[i] = normal_form(words[i]);
+                           }
+                         });
+    return result;
+  }
 }  // namespace libsemigroups
@@ -22,8 +22,9 @@
 
 #include "uf.hpp"
 
-#include <cstddef>  // for size_t
-#include <vector>   // for vector
+#include <algorithm>  // for fill, min, swap
+#include <cstddef>    // for size_t
+#include <vector>     // for vector
 
 #include "libsemigroups-debug.hpp"  // for LIBSEMIGROUPS_ASSERT
 
@@ -34,7 +35,11 @@ namespace libsemigroups {
         : _size(copy._size),
           _table(new table_type(*copy._table)),
           _blocks(nullptr),
-          _haschanged(copy._haschanged) {
+          _haschanged(copy._haschanged),
+          _next_rep(copy._next_rep),
+          _nr_blocks(copy._nr_blocks),
+          _rank(copy._rank),
+          _rep(copy._rep) {
       if (copy._blocks != nullptr) {
         // Copy the blocks as well
         _blocks = new blocks_type();
@@ -55,7 +60,43 @@ namespace libsemigroups {
           _table(new table_type(table)),
           _blocks(nullptr),
           _haschanged(true),
-          _next_rep(0) {}
+          _next_rep(0),
+          _nr_blocks(0),
+          _rank(table.size(), 0),
+          _rep(table.size(), 0) {
+      // Find the roots without modifying the table, every entry on the path
+      // from i to its root is given the root as its value in roots, so that
+      // this is linear in _size.
+      table_type roots(_size, _size);
+      table_type path;
+      for (size_t i = 0; i < _size; i++) {
+        size_t j = i;
+        while (roots[j] == _size && (*_table)[j] != j) {
+          LIBSEMIGROUPS_ASSERT((*_table)[j] < _size);
+          path.push_back(j);
+          j = (*_table)[j];
+        }
+        size_t const r = (roots[j] == _size ? j : roots[j]);
+        roots[j]       = r;
+        for (size_t k : path) {
+          roots[k] = r;
+        }
+        path.clear();
+        if (r == i) {
+          // i is a root
+          _nr_blocks++;
+        }
+      }
+      // Since we loop in increasing order, the first entry found in a block
+      // is the least entry in the block.
+      std::vector<bool> seen(_size, false);
+      for (size_t i = 0; i < _size; i++) {
+        if (!seen[roots[i]]) {
+          seen[roots[i]] = true;
+          _rep[roots[i]] = i;
+        }
+      }
+    }
 
     // Constructor by size
     UF::UF(size_t size)
@@ -63,10 +104,15 @@ namespace libsemigroups {
           _table(new table_type()),
           _blocks(nullptr),
           _haschanged(false),
-          _next_rep(0) {
+          _next_rep(0),
+          _nr_blocks(size),
+          _rank(size, 0),
+          _rep() {
       _table->reserve(size);
+      _rep.reserve(size);
       for (size_t i = 0; i < size; i++) {
         _table->push_back(i);
+        _rep.push_back(i);
       }
     }
 
@@ -125,68 +171,77 @@ namespace libsemigroups {
       return _blocks;
     }
 
-    // find
-    size_t UF::find(size_t i) {
-      size_t ii;
+    // root, with path halving
+    size_t UF::root(size_t i) {
       LIBSEMIGROUPS_ASSERT(_size == _table->size());
-      do {
-        ii = i;
-        LIBSEMIGROUPS_ASSERT(ii < _size);
-        i = (*_table)[ii];
-      } while (ii != i);
+      LIBSEMIGROUPS_ASSERT(i < _size);
+      table_type& table = *_table;
+      while (table[i] != i) {
+        table[i] = table[table[i]];
+        i        = table[i];
+      }
       return i;
     }
 
+    // find
+    size_t UF::find(size_t i) {
+      return _rep[root(i)];
+    }
+
     // union
     void UF::unite(size_t i, size_t j) {
-      size_t ii, jj;
-      LIBSEMIGROUPS_ASSERT(_size == _table->size());
-      ii = find(i);
-      jj = find(j);
-      if (ii < jj) {
-        LIBSEMIGROUPS_ASSERT(jj < _size);
-        (*_table)[jj] = ii;
-      } else {
-        LIBSEMIGROUPS_ASSERT(ii < _size);
-        (*_table)[ii] = jj;
-      }
+      size_t ii = root(i);
+      size_t jj = root(j);
       _haschanged = true;
+      if (ii == jj) {
+        return;
+      }
+      // Make the root of lower rank a child of the root of higher rank
+      if (_rank[ii] < _rank[jj]) {
+        std::swap(ii, jj);
+      } else if (_rank[ii] == _rank[jj]) {
+        _rank[ii]++;
+      }
+      (*_table)[jj] = ii;
+      _rep[ii]      = std::min(_rep[ii], _rep[jj]);
+      _nr_blocks--;
     }
 
     // flatten
     void UF::flatten() {
       LIBSEMIGROUPS_ASSERT(_size == _table->size());
+      // We cannot write find(i) into the table as we go, since this changes
+      // the roots of blocks that have not yet been processed.
+      table_type reps;
+      reps.reserve(_size);
       for (size_t i = 0; i < _size; i++) {
-        (*_table)[i] = find(i);
+        reps.push_back(find(i));
+      }
+      std::fill(_rank.begin(), _rank.end(), 0);
+      for (size_t i = 0; i < _size; i++) {
+        (*_table)[i] = reps[i];
+        _rep[i]      = reps[i];
+        if (reps[i] != i) {
+          _rank[reps[i]] = 1;
+        }
       }
     }
 
     // add_entry
     void UF::add_entry() {
       _table->push_back(_size);
+      _rank.push_back(0);
+      _rep.push_back(_size);
       if (_blocks != nullptr) {
         _blocks->push_back(new table_type(1, _size));
       }
       _size++;
+      _nr_blocks++;
     }
 
     // nr_blocks
     size_t UF::nr_blocks() {
-      LIBSEMIGROUPS_ASSERT(_size == _table->size());
-      if (_size == 0) {
-        return 0;
-      }
-      size_t count = 1;
-      size_t max   = 0;
-      flatten();  // So we can use [i] instead of ->find(i)
-      LIBSEMIGROUPS_ASSERT((*_table)[0] == 0);
-      for (size_t i = 1; i < _size; i++) {
-        if ((*_table)[i] > max) {
-          max = (*_table)[i];
-          count++;
-        }
-      }
-      return count;
+      return _nr_blocks;
     }
 
     void UF::reset_next_rep() {
@@ -19,6 +19,8 @@
 // 1. iwyu
 // 2. add examples from Action
 
+#include <algorithm>  // for equal
+
 #include "action.hpp"
 #include "bmat8.hpp"
 #include "element-helper.hpp"
@@ -564,4 +566,159 @@ namespace libsemigroups {
 
     REQUIRE(o.size() == 360360);
   }
+
+  LIBSEMIGROUPS_TEST_CASE("Action",
+                          "019",
+                          "max_threads",
+                          "[quick][no-valgrind]") {
+    auto rg    = ReportGuard(REPORT);
+    using Perm = PermHelper<10>::type;
+    using Orb  = RightAction<Perm,
+                            std::array<u_int8_t, 4>,
+                            OnTuples<Perm, u_int8_t, std::array<u_int8_t, 4>>>;
+    Orb o1, o2;
+    REQUIRE(o1.max_threads() == 1);
+    REQUIRE(o2.max_threads(4).max_threads() == 4);
+    REQUIRE(o2.max_threads(0).max_threads() == 1);
+    o2.max_threads(4);
+    for (auto o : {&o1, &o2}) {
+      o->add_seed({0, 1, 2, 3});
+      o->add_generator(Perm({1, 0, 2, 3, 4, 5, 6, 7, 8, 9}));
+    }
+    REQUIRE(o2.size() == 2);
+    for (auto o : {&o1, &o2}) {
+      o->add_generator(Perm({1, 2, 3, 4, 5, 6, 7, 8, 9, 0}));
+    }
+    REQUIRE(o1.size() == 5040);
+    REQUIRE(o2.size() == 5040);
+    REQUIRE(std::equal(o1.cbegin(), o1.cend(), o2.cbegin()));
+    for (size_t i = 0; i < o1.size(); ++i) {
+      for (size_t j = 0; j < 2; ++j) {
+        REQUIRE(o1.digraph().neighbor(i, j) == o2.digraph().neighbor(i, j));
+      }
+    }
+    REQUIRE(o1.digraph().nr_scc() == o2.digraph().nr_scc());
+
+    using PPerm = PPermHelper<6>::type;
+    RightAction<PPerm, PPerm, ImageRightAction<PPerm, PPerm>> o3;
+    o3.max_threads(3);
+    o3.add_seed(PPerm::identity(6));
+    o3.add_generator(PPerm({0, 1, 2, 3, 4, 5}, {1, 2, 3, 4, 5, 0}, 6));
+    o3.add_generator(PPerm({0, 1, 2, 3, 4, 5}, {1, 0, 2, 3, 4, 5}, 6));
+    o3.add_generator(PPerm({1, 2, 3, 4, 5}, {0, 1, 2, 3, 4}, 6));
+    REQUIRE(o3.size() == 64);
+  }
+
+  struct FlatIndexTraits : public ActionTraits<BMat8, BMat8> {
+    static constexpr bool flat_index = true;
+  };
+
+  LIBSEMIGROUPS_TEST_CASE("Action", "020", "flat_index", "[quick]") {
+    auto rg = ReportGuard(REPORT);
+    using flat_orb_type
+        = RightAction<BMat8, BMat8, row_action_type, FlatIndexTraits>;
+    std::vector<BMat8> gens
+        = {BMat8({{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}),
+           BMat8({{0, 1, 0, 0}, {1, 0, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}),
+           BMat8({{0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}, {1, 0, 0, 0}}),
+           BMat8({{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {1, 0, 0, 1}}),
+           BMat8({{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 0}})};
+    BMat8 seed
+        = BMat8({{1, 1, 1, 0}, {1, 1, 0, 0}, {0, 1, 0, 1}, {0, 1, 0, 0}})
+              .row_space_basis();
+
+    row_orb_type  o1;
+    flat_orb_type o2, o3;
+    o3.max_threads(4);
+    o3.reserve(10);
+    o1.add_seed(seed);
+    o2.add_seed(seed);
+    o3.add_seed(seed);
+    REQUIRE(o2.position(seed) == 0);
+    REQUIRE(o2.position(gens[0]) == UNDEFINED);
+    for (auto const& x : gens) {
+      o1.add_generator(x);
+      o2.add_generator(x);
+      o3.add_generator(x);
+    }
+    REQUIRE(o1.size() == 553);
+    REQUIRE(o2.size() == 553);
+    REQUIRE(o3.size() == 553);
+    REQUIRE(std::equal(o1.cbegin(), o1.cend(), o2.cbegin()));
+    REQUIRE(std::equal(o1.cbegin(), o1.cend(), o3.cbegin()));
+    for (size_t i = 0; i < o2.size(); ++i) {
+      REQUIRE(o2.position(o2[i]) == i);
+      REQUIRE(o3.position(o3[i]) == i);
+    }
+    for (auto x : {BMat8(0), BMat8(1), BMat8(0xFF00FF00FF00FF00)}) {
+      REQUIRE(o2.position(x) == o1.position(x));
+    }
+    REQUIRE(o2.digraph().nr_scc() == o1.digraph().nr_scc());
+  }
+
+  LIBSEMIGROUPS_TEST_CASE("Action",
+                          "021",
+                          "cache_scc_multipliers",
+                          "[quick][no-valgrind]") {
+    auto rg    = ReportGuard(REPORT);
+    using Perm = PermHelper<10>::type;
+    using Orb  = RightAction<Perm,
+                            std::array<u_int8_t, 4>,
+                            OnTuples<Perm, u_int8_t, std::array<u_int8_t, 4>>>;
+    Orb o1, o2;
+    REQUIRE(!o1.cache_scc_multipliers());
+    REQUIRE(o2.cache_scc_multipliers(true).cache_scc_multipliers());
+    o2.max_threads(4);
+    for (auto o : {&o1, &o2}) {
+      o->add_seed({0, 1, 2, 3});
+      o->add_generator(Perm({1, 0, 2, 3, 4, 5, 6, 7, 8, 9}));
+    }
+    REQUIRE(o1.size() == 2);
+    REQUIRE(o2.size() == 2);
+    REQUIRE(o2.multiplier_from_scc_root(1) == o1.multiplier_from_scc_root(1));
+    // Adding a generator discards the cached multipliers
+    for (auto o : {&o1, &o2}) {
+      o->add_generator(Perm({1, 2, 3, 4, 5, 6, 7, 8, 9, 0}));
+    }
+    REQUIRE(o1.size() == 5040);
+    REQUIRE(o2.size() == 5040);
+    REQUIRE_THROWS_AS(o2.multiplier_from_scc_root(5040),
+                      LibsemigroupsException);
+    REQUIRE_THROWS_AS(o2.multiplier_to_scc_root(5040), LibsemigroupsException);
+
+    size_t const mem  = o2.memory_used();
+    auto const&  from = o2.multipliers_from_scc_root();
+    auto const&  to   = o2.multipliers_to_scc_root();
+    REQUIRE(mem > 0);
+    REQUIRE(o2.memory_used() > mem);
+    REQUIRE(from.size() == 5040);
+    REQUIRE(to.size() == 5040);
+    for (size_t i = 0; i < o1.size(); ++i) {
+      REQUIRE(o1.multiplier_from_scc_root(i) == from[i]);
+      REQUIRE(o1.multiplier_to_scc_root(i) == to[i]);
+      REQUIRE(o2.multiplier_from_scc_root(i) == from[i]);
+      REQUIRE(o2.multiplier_to_scc_root(i) == to[i]);
+    }
+
+    col_orb_type col_orb;
+    col_orb.cache_scc_multipliers(true).max_threads(2);
+    col_orb.add_seed(
+        BMat8({{1, 1, 1, 0}, {1, 1, 0, 0}, {0, 1, 0, 1}, {0, 1, 0, 0}})
+            .col_space_basis());
+    col_orb.add_generator(
+        BMat8({{0, 1, 0, 0}, {1, 0, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}));
+    col_orb.add_generator(
+        BMat8({{0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}, {1, 0, 0, 0}}));
+    col_orb.add_generator(
+        BMat8({{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {1, 0, 0, 1}}));
+    col_orb.add_generator(
+        BMat8({{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 0}}));
+    REQUIRE(col_orb.size() == 553);
+    for (size_t i = 0; i < col_orb.size(); ++i) {
+      REQUIRE((col_orb.multiplier_from_scc_root(i)
+               * col_orb.multiplier_to_scc_root(i) * col_orb.at(i))
+                  .col_space_basis()
+              == col_orb.at(i));
+    }
+  }
 }  // namespace libsemigroups
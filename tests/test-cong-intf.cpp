@@ -17,6 +17,8 @@
 
 // The purpose of this file is to test the CongruenceInterface class.
 
+#include <algorithm>  // for sort
+
 #include "catch.hpp"  // for LIBSEMIGROUPS_TEST_CASE
 #include "cong-pair.hpp"
 #include "cong.hpp"
@@ -577,5 +579,73 @@ namespace libsemigroups {
       REQUIRE(!cong.contains({1}, {2, 2, 2, 2, 2, 2, 2, 2, 2, 2}));
       REQUIRE(cong.nr_classes() == 88);
     }
+
+    LIBSEMIGROUPS_TEST_CASE("CongruenceInterface",
+                            "013",
+                            "non_trivial_class_indices",
+                            "[quick][cong]") {
+      auto rg = ReportGuard(REPORT);
+      auto S  = FroidurePin<Transformation<uint16_t>>(
+          {Transformation<uint16_t>({1, 3, 4, 2, 3}),
+           Transformation<uint16_t>({3, 2, 1, 3, 3})});
+      REQUIRE(S.size() == 88);
+
+      std::unique_ptr<CongruenceInterface> cong;
+      SECTION("ToddCoxeter (left)") {
+        cong = detail::make_unique<ToddCoxeter>(left, S);
+      }
+      SECTION("ToddCoxeter (right)") {
+        cong = detail::make_unique<ToddCoxeter>(right, S);
+      }
+      SECTION("ToddCoxeter (2-sided)") {
+        cong = detail::make_unique<ToddCoxeter>(twosided, S);
+      }
+      SECTION("CongruenceByPairs") {
+        cong
+            = detail::make_unique<CongruenceByPairs<decltype(S)::element_type>>(
+                right, S);
+      }
+      SECTION("Congruence") {
+        cong = detail::make_unique<Congruence>(left, S);
+      }
+      cong->max_threads(4);
+      cong->add_pair(
+          S.factorisation(Transformation<uint16_t>({3, 4, 4, 4, 4})),
+          S.factorisation(Transformation<uint16_t>({3, 1, 3, 3, 3})));
+
+      auto ntc = cong->non_trivial_class_indices();
+      REQUIRE(ntc == cong->non_trivial_class_indices());
+      REQUIRE(ntc->nr_classes() == cong->nr_non_trivial_classes());
+      REQUIRE(ntc->nr_classes() != 0);
+
+      // The order of the classes, and of the words in each class, is not
+      // necessarily the same as in non_trivial_classes.
+      std::vector<std::vector<word_type>> expected(cong->cbegin_ntc(),
+                                                   cong->cend_ntc());
+      std::vector<std::vector<word_type>> result;
+      size_t                              total = 0;
+      for (size_t i = 0; i < ntc->nr_classes(); ++i) {
+        REQUIRE(ntc->size(i) > 1);
+        result.push_back(ntc->words(i));
+        std::sort(result.back().begin(), result.back().end());
+        auto const klass = cong->word_to_class_index(ntc->word(i, 0));
+        for (auto pos = ntc->cbegin(i); pos < ntc->cend(i); ++pos) {
+          REQUIRE(cong->word_to_class_index(S.factorisation(*pos)) == klass);
+        }
+        total += ntc->size(i);
+      }
+      for (auto& klass : expected) {
+        std::sort(klass.begin(), klass.end());
+      }
+      std::sort(expected.begin(), expected.end());
+      std::sort(result.begin(), result.end());
+      REQUIRE(result == expected);
+      REQUIRE(total <= S.size());
+      REQUIRE_THROWS_AS(ntc->word(ntc->nr_classes(), 0),
+                        LibsemigroupsException);
+      REQUIRE_THROWS_AS(ntc->word(0, ntc->size(0)), LibsemigroupsException);
+      REQUIRE_THROWS_AS(ntc->words(ntc->nr_classes()),
+                        LibsemigroupsException);
+    }
   }  // namespace congruence
 }  // namespace libsemigroups
@@ -19,9 +19,10 @@
 // The purpose of this file is to test the classes CongruenceByPairs
 // and FpSemigroupByPairs.
 
-#include <algorithm>   // for sort, transform
-#include <functional>  // for mem_fn
-#include <vector>      // for vector
+#include <algorithm>      // for sort, transform
+#include <functional>     // for mem_fn
+#include <unordered_map>  // for unordered_map
+#include <vector>         // for vector
 
 #include "catch.hpp"      // for REQUIRE, SECTION, REQUIRE_THROWS_AS, REQ...
 #include "cong-intf.hpp"  // for congruence_type, CongruenceInterface::non_tr...
@@ -609,6 +610,147 @@ namespace libsemigroups {
     REQUIRE(cong3.nr_classes() == 11804);
   }
 
+  LIBSEMIGROUPS_TEST_CASE("CongruenceByPairs",
+                          "019",
+                          "(cong) max_threads",
+                          "[quick][cong][cong-pair][no-valgrind]") {
+    auto rg      = ReportGuard(REPORT);
+    using Transf = typename TransfHelper<8>::type;
+    FroidurePin<Transf> S({Transf({7, 3, 5, 3, 4, 2, 7, 7}),
+                           Transf({1, 2, 4, 4, 7, 3, 0, 7}),
+                           Transf({0, 6, 4, 2, 2, 6, 6, 4}),
+                           Transf({3, 6, 3, 4, 0, 6, 0, 7})});
+    REQUIRE(S.size() == 11804);
+
+    using P = CongruenceByPairs<decltype(S)::element_type>;
+
+    for (auto knd : {left, right}) {
+      P serial(knd, S);
+      REQUIRE(serial.max_threads() == 1);
+      serial.add_pair({0, 3, 2, 1, 3, 2, 2}, {3, 2, 2, 1, 3, 3});
+
+      P parallel(knd, S);
+      parallel.max_threads(4);
+      REQUIRE(parallel.max_threads() == 4);
+      parallel.add_pair({0, 3, 2, 1, 3, 2, 2}, {3, 2, 2, 1, 3, 3});
+
+      REQUIRE(parallel.nr_classes() == serial.nr_classes());
+      REQUIRE(parallel.nr_non_trivial_classes()
+              == serial.nr_non_trivial_classes());
+
+      // The class indices might differ, but the partitions must be the same.
+      std::unordered_map<size_t, size_t> serial_to_parallel;
+      std::unordered_map<size_t, size_t> parallel_to_serial;
+      bool                               same = true;
+      for (size_t i = 0; i < S.size(); ++i) {
+        word_type w = S.factorisation(i);
+        size_t    x = serial.word_to_class_index(w);
+        size_t    y = parallel.word_to_class_index(w);
+        if (serial_to_parallel.emplace(x, y).first->second != y
+            || parallel_to_serial.emplace(y, x).first->second != x) {
+          same = false;
+        }
+      }
+      REQUIRE(same);
+    }
+    // The serial version takes several seconds in this case, since it
+    // multiplies every pair it finds, not only those that merge classes.
+    P parallel(twosided, S);
+    parallel.max_threads(4);
+    parallel.add_pair({0, 3, 2, 1, 3, 2, 2}, {3, 2, 2, 1, 3, 3});
+    REQUIRE(parallel.nr_classes() == 525);
+    REQUIRE(P(left, S).max_threads(0).max_threads() == 1);
+  }
+
+  LIBSEMIGROUPS_TEST_CASE("CayleyGraphCongruenceByPairs",
+                          "001",
+                          "left, right, and 2-sided congruences",
+                          "[quick][cong][cong-pair]") {
+    auto rg      = ReportGuard(REPORT);
+    using Transf = typename TransfHelper<8>::type;
+    FroidurePin<Transf> S({Transf({7, 3, 5, 3, 4, 2, 7, 7}),
+                           Transf({1, 2, 4, 4, 7, 3, 0, 7}),
+                           Transf({0, 6, 4, 2, 2, 6, 6, 4}),
+                           Transf({3, 6, 3, 4, 0, 6, 0, 7})});
+
+    {
+      // S is copied, and the copy is enumerated by p
+      CayleyGraphCongruenceByPairs p(left, S);
+      p.add_pair({0, 3, 2, 1, 3, 2, 2}, {3, 2, 2, 1, 3, 3});
+      REQUIRE(p.const_contains({0, 3, 2, 1, 3, 2, 2}, {3, 2, 2, 1, 3, 3})
+              == tril::unknown);
+      REQUIRE(!p.finished());
+      REQUIRE(p.nr_classes() == 7449);
+      REQUIRE(p.finished());
+      REQUIRE(!S.started());
+      REQUIRE(p.parent_froidure_pin()->finished());
+      REQUIRE(p.is_quotient_obviously_finite());
+      REQUIRE(!p.is_quotient_obviously_infinite());
+      REQUIRE(p.const_contains({0, 3, 2, 1, 3, 2, 2}, {3, 2, 2, 1, 3, 3})
+              == tril::TRUE);
+
+      REQUIRE(p.word_to_class_index({1, 1, 3, 2, 2, 1, 3, 1, 3, 3})
+              == p.word_to_class_index({2, 2, 0, 1}));
+      REQUIRE(p.word_to_class_index({1, 1, 0, 3})
+              != p.word_to_class_index({1, 0, 3, 2, 0, 2, 0, 3, 2, 2, 1}));
+      REQUIRE_THROWS_AS(p.quotient_froidure_pin(), LibsemigroupsException);
+    }
+
+    REQUIRE(S.size() == 11804);
+    for (auto knd : {left, right, twosided}) {
+      CayleyGraphCongruenceByPairs p(knd, S);
+      p.add_pair({0, 3, 2, 1, 3, 2, 2}, {3, 2, 2, 1, 3, 3});
+
+      CongruenceByPairs<decltype(S)::element_type> q(knd, S);
+      q.max_threads(2);
+      q.add_pair({0, 3, 2, 1, 3, 2, 2}, {3, 2, 2, 1, 3, 3});
+
+      REQUIRE(p.nr_classes() == q.nr_classes());
+      REQUIRE(p.nr_non_trivial_classes() == q.nr_non_trivial_classes());
+
+      bool same = true;
+      for (size_t i = 0; i < p.nr_classes(); ++i) {
+        same = same && p.word_to_class_index(p.class_index_to_word(i)) == i;
+      }
+      REQUIRE(same);
+
+      size_t nr = 0;
+      for (auto it = p.cbegin_ntc(); it < p.cend_ntc(); ++it) {
+        same = same && it->size() > 1;
+        for (auto const& w : *it) {
+          same = same
+                 && q.word_to_class_index(w)
+                        == q.word_to_class_index(it->at(0));
+          nr++;
+        }
+      }
+      REQUIRE(same);
+      REQUIRE(nr + p.nr_classes() - p.nr_non_trivial_classes() == S.size());
+    }
+  }
+
+  LIBSEMIGROUPS_TEST_CASE("CayleyGraphCongruenceByPairs",
+                          "002",
+                          "quotient and trivial congruence",
+                          "[quick][cong][cong-pair]") {
+    auto rg      = ReportGuard(REPORT);
+    using Transf = typename TransfHelper<5>::type;
+    FroidurePin<Transf> S({Transf({1, 3, 4, 2, 3}), Transf({3, 2, 1, 3, 3})});
+    REQUIRE(S.size() == 88);
+
+    CayleyGraphCongruenceByPairs p(twosided, S);
+    REQUIRE(p.nr_classes() == 88);
+    REQUIRE(p.nr_non_trivial_classes() == 0);
+
+    CayleyGraphCongruenceByPairs q(twosided, S);
+    q.add_pair(S.factorisation(Transf({3, 4, 4, 4, 4})),
+               S.factorisation(Transf({3, 1, 3, 3, 3})));
+    REQUIRE(q.nr_classes() == 21);
+    REQUIRE(q.quotient_froidure_pin()->size() == 21);
+    REQUIRE(q.class_index_to_word(0) == word_type({0}));
+    REQUIRE_THROWS_AS(q.class_index_to_word(21), LibsemigroupsException);
+  }
+
   LIBSEMIGROUPS_TEST_CASE("KnuthBendixCongruenceByPairs",
                           "001",
                           "non-trivial congruence on an infinite fp semigroup",
@@ -1398,6 +1398,86 @@ namespace libsemigroups {
     REQUIRE_THROWS_AS(cong.cbegin_ntc(), LibsemigroupsException);
   }
 
+  LIBSEMIGROUPS_TEST_CASE("Congruence",
+                          "046",
+                          "congruence on a finished FroidurePin",
+                          "[quick][cong][no-valgrind]") {
+    auto rg      = ReportGuard(REPORT);
+    using Transf = TransfHelper<8>::type;
+    FroidurePin<Transf> S({Transf({7, 3, 5, 3, 4, 2, 7, 7}),
+                           Transf({1, 2, 4, 4, 7, 3, 0, 7}),
+                           Transf({0, 6, 4, 2, 2, 6, 6, 4}),
+                           Transf({3, 6, 3, 4, 0, 6, 0, 7})});
+    REQUIRE(S.size() == 11804);
+
+    for (auto knd : {left, right, twosided}) {
+      Congruence cong(knd, S);
+      cong.add_pair({0, 3, 2, 1, 3, 2, 2}, {3, 2, 2, 1, 3, 3});
+      REQUIRE(cong.nr_classes()
+              == (knd == left ? 7449 : (knd == right ? 9693 : 525)));
+      REQUIRE(cong.contains({0, 3, 2, 1, 3, 2, 2}, {3, 2, 2, 1, 3, 3}));
+    }
+    Congruence cong(twosided, S);
+    cong.add_pair({0, 3, 2, 1, 3, 2, 2}, {3, 2, 2, 1, 3, 3});
+    REQUIRE(cong.contains({1, 2, 1, 3, 3, 2, 1, 2}, {2, 1, 3, 3, 2, 1, 0}));
+    REQUIRE(cong.quotient_froidure_pin()->size() == 525);
+    REQUIRE(cong.nr_non_trivial_classes() == 1);
+  }
+
+  LIBSEMIGROUPS_TEST_CASE("Congruence", "047", "adaptive", "[quick][cong]") {
+    auto rg = ReportGuard(REPORT);
+    detail::race_history().clear();
+
+    FpSemigroup S;
+    S.set_alphabet(2);
+    S.add_rule({0, 0, 0}, {0});  // (a^3, a)
+    S.add_rule({0}, {1, 1});     // (a, b^2)
+
+    {
+      Congruence cong(left, S);
+      REQUIRE(!cong.adaptive());
+      REQUIRE(cong.nr_classes() == 5);
+      // Non-adaptive congruences do not record anything
+      REQUIRE(detail::race_history().size() == 0);
+    }
+
+    for (size_t i = 0; i < 3; ++i) {
+      Congruence cong(left, S);
+      cong.adaptive(true);
+      REQUIRE(cong.adaptive());
+      REQUIRE(cong.nr_classes() == 5);
+      REQUIRE(cong.word_to_class_index({0, 0, 1})
+              == cong.word_to_class_index({0, 0, 0, 0, 1}));
+    }
+    REQUIRE(detail::race_history().size() != 0);
+    detail::race_history().clear();
+  }
+
+  LIBSEMIGROUPS_TEST_CASE("Congruence",
+                          "048",
+                          "batch word_to_class_index and contains",
+                          "[quick][cong]") {
+    auto        rg = ReportGuard(REPORT);
+    FpSemigroup S;
+    S.set_alphabet(2);
+    S.add_rule({0, 0, 0}, {0});  // (a^3, a)
+    S.add_rule({0}, {1, 1});     // (a, b^2)
+
+    Congruence cong(left, S);
+    cong.max_threads(2);
+    std::vector<word_type> words = {{0, 0, 1}, {0, 0, 0, 0, 1}, {1}, {0}};
+    auto                   result = cong.words_to_class_indices(words);
+    REQUIRE(result.size() == 4);
+    REQUIRE(result[0] == result[1]);
+    for (size_t i = 0; i < words.size(); ++i) {
+      REQUIRE(result[i] == cong.word_to_class_index(words[i]));
+    }
+    REQUIRE(cong.contains({{{0, 0, 1}, {0, 0, 0, 0, 1}},
+                           {{0}, {1}},
+                           {{1}, {1}}})
+            == std::vector<bool>({true, false, true}));
+  }
+
   // The next 3 test cases are commented out because they test features we
   // decided not to include in v1.0.0.
 
@@ -164,6 +164,17 @@ namespace libsemigroups {
       REQUIRE(rv.nr_rows() == 2);
       REQUIRE(std::all_of(
           rv.begin(), rv.end(), [](size_t val) { return val == 666; }));
+      rv.set(1, 0, 0);
+      rv.set(1, 114, 1);
+      rv.add_cols(200);
+      REQUIRE(rv.nr_cols() == 315);
+      REQUIRE(rv.get(1, 0) == 0);
+      REQUIRE(rv.get(1, 114) == 1);
+      for (size_t i = 0; i < 2; ++i) {
+        for (size_t j = 115; j < 315; ++j) {
+          REQUIRE(rv.get(i, j) == 666);
+        }
+      }
     }
 
     LIBSEMIGROUPS_TEST_CASE("DynamicArray2",
@@ -1538,6 +1549,10 @@ namespace libsemigroups {
       REQUIRE(sv.size(0) == 3);
       REQUIRE(sv.size(1) == 2);
       REQUIRE(sv.size(2) == 1);
+      sv.clear(1);
+      REQUIRE(sv.size(0) == 3);
+      REQUIRE(sv.size(1) == 0);
+      REQUIRE(sv.size(2) == 1);
       sv.clear();
       REQUIRE(sv.size(0) == 0);
       REQUIRE(sv.size(1) == 0);
@@ -16,7 +16,9 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
+#include <algorithm>  // for equal, is_sorted, min, min_element
 #include <cstddef>    // for size_t
+#include <random>     // for mt19937
 #include <stdexcept>  // for runtime_error
 #include <vector>     // for vector
 
@@ -532,4 +534,379 @@ namespace libsemigroups {
     }
     REQUIRE_THROWS_AS(g.root_of_scc(1000), LibsemigroupsException);
   }
+
+  LIBSEMIGROUPS_TEST_CASE("ActionDigraph",
+                          "021",
+                          "incremental strongly connected components",
+                          "[quick][digraph]") {
+    using node_type = ActionDigraph<size_t>::node_type;
+    std::mt19937 mt;
+
+    // Returns a copy of g whose components have not been computed
+    auto copy = [](ActionDigraph<size_t> const& g) {
+      ActionDigraph<size_t> h(g.nr_nodes(), g.out_degree());
+      for (node_type v = 0; v < g.nr_nodes(); ++v) {
+        for (node_type i = 0; i < g.out_degree(); ++i) {
+          h.add_edge(v, g.neighbor(v, i), i);
+        }
+      }
+      return h;
+    };
+
+    auto check = [&copy](ActionDigraph<size_t> const& g) {
+      auto h = copy(g);
+      REQUIRE(g.nr_scc() == h.nr_scc());
+      REQUIRE(std::equal(g.cbegin_sccs(), g.cend_sccs(), h.cbegin_sccs()));
+      Forest const& f1 = g.spanning_forest();
+      Forest const& f2 = h.spanning_forest();
+      Forest const& b1 = g.reverse_spanning_forest();
+      Forest const& b2 = h.reverse_spanning_forest();
+      REQUIRE(f1.nr_nodes() == g.nr_nodes());
+      REQUIRE(b1.nr_nodes() == g.nr_nodes());
+      for (node_type v = 0; v < g.nr_nodes(); ++v) {
+        REQUIRE(g.scc_id(v) == h.scc_id(v));
+        REQUIRE(f1.parent(v) == f2.parent(v));
+        REQUIRE(f1.label(v) == f2.label(v));
+        REQUIRE(b1.parent(v) == b2.parent(v));
+        REQUIRE(b1.label(v) == b2.label(v));
+      }
+    };
+
+    // Adds n nodes with random out-edges to g
+    auto extend = [&mt](ActionDigraph<size_t>& g, size_t n) {
+      size_t const first = g.nr_nodes();
+      g.add_nodes(n);
+      std::uniform_int_distribution<node_type> dist(0, g.nr_nodes() - 1);
+      for (node_type v = first; v < g.nr_nodes(); ++v) {
+        for (node_type i = 0; i < g.out_degree(); ++i) {
+          g.add_edge(v, dist(mt), i);
+        }
+      }
+    };
+
+    ActionDigraph<size_t> g(0, 2);
+    extend(g, 100);
+    check(g);
+    for (size_t n = 0; n < 10; ++n) {
+      extend(g, 50);
+      check(g);
+    }
+    REQUIRE(g.nr_nodes() == 600);
+
+    // The next nodes are not fully defined
+    g.add_nodes(2);
+    g.add_edge(600, 0, 0);
+    REQUIRE_THROWS_AS(g.nr_scc(), LibsemigroupsException);
+    g.add_edge(600, 601, 1);
+    g.add_edge(601, 600, 0);
+    g.add_edge(601, 601, 1);
+    check(g);
+
+    // Changing the edges of an existing node
+    g.add_edge(0, 601, 0);
+    check(g);
+    g.add_to_out_degree(1);
+    for (node_type v = 0; v < g.nr_nodes(); ++v) {
+      g.add_edge(v, (v + 1) % g.nr_nodes(), 2);
+    }
+    check(g);
+    REQUIRE(g.nr_scc() == 1);
+    extend(g, 50);
+    check(g);
+  }
+
+  LIBSEMIGROUPS_TEST_CASE("ActionDigraph",
+                          "022",
+                          "parallel strongly connected components",
+                          "[quick][digraph]") {
+    using node_type = ActionDigraph<size_t>::node_type;
+    auto g          = ActionDigraph<size_t>::random(5000, 2);
+    for (size_t n = 0; n < 100; ++n) {
+      add_cycle(g, 10);
+    }
+    g.add_to_out_degree(1);
+    for (node_type v = 0; v < g.nr_nodes(); ++v) {
+      g.add_edge(v, (v < 5000 ? v : (v / 10) * 10 + 1) % g.nr_nodes(), 1);
+      g.add_edge(v, v, 2);
+    }
+    ActionDigraph<size_t> h = g;  // The components are not computed yet
+    REQUIRE(g.max_threads() == 1);
+    REQUIRE(g.max_threads(0).max_threads() == 1);
+    g.max_threads(4);
+    REQUIRE(g.nr_scc() == h.nr_scc());
+
+    // The components are the same, but the roots are the least nodes
+    for (auto it = h.cbegin_sccs(); it < h.cend_sccs(); ++it) {
+      node_type const root = *std::min_element(it->cbegin(), it->cend());
+      for (node_type v : *it) {
+        REQUIRE(g.root_of_scc(v) == root);
+      }
+    }
+    for (auto it = g.cbegin_sccs(); it < g.cend_sccs(); ++it) {
+      REQUIRE(std::is_sorted(it->cbegin(), it->cend()));
+      if (it > g.cbegin_sccs()) {
+        REQUIRE((it - 1)->front() < it->front());
+      }
+    }
+
+    // The forests are the same as those found by the serial algorithm for
+    // the same components
+    ActionDigraph<size_t> k = g;
+    k.max_threads(1);
+    Forest const& f1 = g.spanning_forest();
+    Forest const& f2 = k.spanning_forest();
+    Forest const& b1 = g.reverse_spanning_forest();
+    Forest const& b2 = k.reverse_spanning_forest();
+    for (node_type v = 0; v < g.nr_nodes(); ++v) {
+      REQUIRE(f1.parent(v) == f2.parent(v));
+      REQUIRE(f1.label(v) == f2.label(v));
+      REQUIRE(b1.parent(v) == b2.parent(v));
+      REQUIRE(b1.label(v) == b2.label(v));
+      if (f1.parent(v) != UNDEFINED) {
+        REQUIRE(g.neighbor(f1.parent(v), f1.label(v)) == v);
+        REQUIRE(g.neighbor(v, b1.label(v)) == b1.parent(v));
+      }
+    }
+
+    // Extending the digraph after finding the components in parallel
+    add_cycle(g, 10);
+    for (node_type v = g.nr_nodes() - 10; v < g.nr_nodes(); ++v) {
+      g.add_edge(v, 0, 1);
+      g.add_edge(v, v, 2);
+    }
+    REQUIRE(g.nr_scc() == h.nr_scc() + 1);
+    REQUIRE(g.root_of_scc(g.nr_nodes() - 1) == g.nr_nodes() - 10);
+    REQUIRE(g.spanning_forest().nr_nodes() == g.nr_nodes());
+    REQUIRE(g.reverse_spanning_forest().nr_nodes() == g.nr_nodes());
+  }
+
+  LIBSEMIGROUPS_TEST_CASE("ActionDigraph",
+                          "023",
+                          "paths in short-lex order and numbers of paths",
+                          "[quick][digraph]") {
+    using node_type = ActionDigraph<size_t>::node_type;
+    // Every word over {0, 1} labels a path from 0 to 0
+    ActionDigraph<size_t> g(1, 2);
+    g.add_edge(0, 0, 0);
+    g.add_edge(0, 0, 1);
+
+    std::vector<word_type> expected = {{}};
+    for (size_t i = 1; i < 15; ++i) {
+      word_type w = expected[(i - 1) / 2];
+      w.push_back((i - 1) % 2);
+      expected.push_back(w);
+    }
+    REQUIRE(std::vector<word_type>(g.cbegin_pislo(0, 0, 4), g.cend_pislo())
+            == expected);
+    REQUIRE(std::vector<word_type>(g.cbegin_pstislo(0, 0, 2, 4),
+                                   g.cend_pstislo())
+            == std::vector<word_type>(expected.cbegin() + 3, expected.cend()));
+    REQUIRE(g.cbegin_pislo(0, 4, 4) == g.cend_pislo());
+    auto it = g.cbegin_pislo(0, 10);
+    REQUIRE(it->size() == 10);
+    REQUIRE(*it == word_type(10, 0));
+    REQUIRE(*(++it) == word_type({0, 0, 0, 0, 0, 0, 0, 0, 0, 1}));
+    REQUIRE(it++ != it);
+
+    REQUIRE(g.number_of_paths(0, 0, 0, 4) == 15);
+    REQUIRE(g.number_of_paths(0, UNDEFINED, 2, 4) == 12);
+    REQUIRE(g.number_of_paths(0, 0) == POSITIVE_INFINITY);
+    REQUIRE(g.number_of_paths_by_length(0, UNDEFINED, 4)
+            == std::vector<uint64_t>({1, 2, 4, 8}));
+    REQUIRE(g.number_of_paths_by_length(0, 0, 64).back() == uint64_t(1) << 63);
+    REQUIRE_THROWS_AS(g.number_of_paths_by_length(0, 0, 65),
+                      LibsemigroupsException);
+    REQUIRE_THROWS_AS(g.number_of_paths_by_length(0, 0, POSITIVE_INFINITY),
+                      LibsemigroupsException);
+    REQUIRE(g.number_of_paths_by_length(0, 0, 70, 1000000007).back()
+            == 635008130);
+    REQUIRE_THROWS_AS(g.number_of_paths(1, 0), LibsemigroupsException);
+    REQUIRE_THROWS_AS(g.cbegin_pstislo(0, 1), LibsemigroupsException);
+
+    // A path with some edges undefined, there are only finitely many paths
+    ActionDigraph<size_t> h(4, 2);
+    h.add_edge(0, 1, 0);
+    h.add_edge(1, 2, 0);
+    h.add_edge(2, 3, 1);
+    h.add_edge(0, 2, 1);
+    REQUIRE(h.number_of_paths(0, 3) == 2);
+    REQUIRE(h.number_of_paths(0, UNDEFINED) == 6);
+    REQUIRE(h.number_of_paths(3, 0) == 0);
+    REQUIRE(std::vector<word_type>(h.cbegin_pislo(0), h.cend_pislo())
+            == std::vector<word_type>(
+                {{}, {0}, {1}, {0, 0}, {1, 1}, {0, 0, 1}}));
+    REQUIRE(std::vector<word_type>(h.cbegin_pstislo(0, 3), h.cend_pstislo())
+            == std::vector<word_type>({{1, 1}, {0, 0, 1}}));
+    REQUIRE(h.cbegin_pstislo(3, 0) == h.cend_pstislo());
+
+    // The paths to a target are those with that target among all paths
+    auto k = ActionDigraph<size_t>::random(20, 3);
+    for (node_type target = 0; target < 20; ++target) {
+      size_t nr = 0;
+      auto   jt = k.cbegin_pstislo(0, target, 0, 6);
+      for (auto kt = k.cbegin_pislo(0, 0, 6); kt != k.cend_pislo(); ++kt) {
+        node_type v = 0;
+        for (auto a : *kt) {
+          v = k.neighbor(v, a);
+        }
+        if (v == target) {
+          REQUIRE(*jt == *kt);
+          ++jt;
+          ++nr;
+        }
+      }
+      REQUIRE(jt == k.cend_pstislo());
+      REQUIRE(k.number_of_paths(0, target, 0, 6) == nr);
+    }
+  }
+
+  LIBSEMIGROUPS_TEST_CASE("ActionDigraph",
+                          "024",
+                          "compressed edges, subdigraphs, and quotients",
+                          "[quick][digraph]") {
+    ActionDigraph<size_t> g(5, 2);
+    REQUIRE(g.nr_edges() == 0);
+    REQUIRE(g.compressed_out_edges().nr_nodes() == 5);
+    REQUIRE(g.compressed_out_edges().nr_edges() == 0);
+    g.add_edge(0, 1, 0);
+    g.add_edge(0, 2, 1);
+    g.add_edge(1, 0, 1);
+    g.add_edge(2, 0, 0);
+    g.add_edge(3, 4, 1);
+    REQUIRE(g.nr_edges() == 5);
+    g.add_edge(3, 0, 1);
+    REQUIRE(g.nr_edges() == 5);
+    REQUIRE(!g.validate());
+
+    auto const& out = g.compressed_out_edges();
+    REQUIRE(out.nr_nodes() == 5);
+    REQUIRE(out.nr_edges() == 5);
+    REQUIRE(out.degree(0) == 2);
+    REQUIRE(out.degree(4) == 0);
+    REQUIRE(std::vector<size_t>(out.cbegin_nodes(0), out.cend_nodes(0))
+            == std::vector<size_t>({1, 2}));
+    REQUIRE(std::vector<size_t>(out.cbegin_labels(1), out.cend_labels(1))
+            == std::vector<size_t>({1}));
+    REQUIRE(std::vector<size_t>(out.cbegin_nodes(3), out.cend_nodes(3))
+            == std::vector<size_t>({0}));
+    REQUIRE_THROWS_AS(out.degree(5), LibsemigroupsException);
+
+    auto const& in = g.compressed_in_edges();
+    REQUIRE(in.nr_edges() == 5);
+    REQUIRE(std::vector<size_t>(in.cbegin_nodes(0), in.cend_nodes(0))
+            == std::vector<size_t>({1, 2, 3}));
+    REQUIRE(std::vector<size_t>(in.cbegin_labels(0), in.cend_labels(0))
+            == std::vector<size_t>({1, 0, 1}));
+    REQUIRE(in.degree(4) == 0);
+
+    // The views are recomputed after the digraph is modified
+    g.add_edge(4, 4, 0);
+    REQUIRE(g.compressed_out_edges().degree(4) == 1);
+    REQUIRE(g.compressed_in_edges().degree(4) == 1);
+
+    // Induced subdigraphs
+    std::vector<size_t>   nodes = {0, 1, 2};
+    ActionDigraph<size_t> s
+        = g.induced_subdigraph(nodes.cbegin(), nodes.cend());
+    REQUIRE(s.nr_nodes() == 3);
+    REQUIRE(s.nr_edges() == 4);
+    nodes = {2, 0};
+    s     = g.induced_subdigraph(nodes.cbegin(), nodes.cend());
+    REQUIRE(s.nr_nodes() == 2);
+    REQUIRE(s.nr_edges() == 2);
+    REQUIRE(s.neighbor(0, 0) == 1);
+    REQUIRE(s.neighbor(1, 1) == 0);
+    REQUIRE(s.neighbor(1, 0) == UNDEFINED);
+    nodes = {0, 5};
+    REQUIRE_THROWS_AS(g.induced_subdigraph(nodes.cbegin(), nodes.cend()),
+                      LibsemigroupsException);
+    nodes = {0, 1, 0};
+    REQUIRE_THROWS_AS(g.induced_subdigraph(nodes.cbegin(), nodes.cend()),
+                      LibsemigroupsException);
+
+    // Quotients
+    ActionDigraph<size_t> c(6, 1);
+    for (size_t i = 0; i < 6; ++i) {
+      c.add_edge(i, (i + 1) % 6, 0);
+    }
+    ActionDigraph<size_t> q = c.quotient({0, 1, 2, 0, 1, 2});
+    REQUIRE(q.nr_nodes() == 3);
+    REQUIRE(q.nr_edges() == 3);
+    REQUIRE(q.validate());
+    REQUIRE(q.neighbor(2, 0) == 0);
+    REQUIRE(c.quotient({0, 0, 0, 0, 0, 0}).nr_edges() == 1);
+    REQUIRE_THROWS_AS(c.quotient({0, 1, 0, 1, 0, 0}), LibsemigroupsException);
+    REQUIRE_THROWS_AS(c.quotient({0, 1}), LibsemigroupsException);
+    REQUIRE_THROWS_AS(c.quotient({0, 1, 2, 0, 1, UNDEFINED}),
+                      LibsemigroupsException);
+
+    // Subdigraphs induced by the strongly connected components
+    auto r = ActionDigraph<size_t>::random(100, 3);
+    REQUIRE(r.nr_edges() == 300);
+    REQUIRE(r.compressed_out_edges().nr_edges() == 300);
+    REQUIRE(r.compressed_in_edges().nr_edges() == 300);
+    REQUIRE(r.compressed_out_edges().degree(99) == 3);
+    size_t nr = 0;
+    for (size_t i = 0; i < r.nr_scc(); ++i) {
+      s = r.induced_subdigraph(r.cbegin_scc(i), r.cend_scc(i));
+      REQUIRE(s.nr_nodes() == size_t(r.cend_scc(i) - r.cbegin_scc(i)));
+      if (s.validate()) {
+        REQUIRE(s.nr_scc() == 1);
+      }
+      nr += s.nr_edges();
+    }
+    REQUIRE(nr <= 300);
+    REQUIRE(r.induced_subdigraph(r.cbegin_nodes(), r.cend_nodes()).nr_edges()
+            == 300);
+    REQUIRE(r.quotient(std::vector<size_t>(100, 0)).nr_edges() == 3);
+  }
+
+  LIBSEMIGROUPS_TEST_CASE("ActionDigraph",
+                          "025",
+                          "parallel strongly connected components of paths",
+                          "[quick][digraph]") {
+    using node_type = ActionDigraph<size_t>::node_type;
+    size_t const n  = 40000;
+
+    // A path, where every node is a component on its own
+    ActionDigraph<size_t> g(n, 1);
+    for (node_type v = 0; v < n; ++v) {
+      g.add_edge(v, std::min(v + 1, n - 1), 0);
+    }
+    g.max_threads(4);
+    REQUIRE(g.nr_scc() == n);
+    for (node_type v = 0; v < n; ++v) {
+      REQUIRE(g.root_of_scc(v) == v);
+    }
+
+    // A path of cycles of length 2, the components are the cycles
+    ActionDigraph<size_t> h(n, 2);
+    for (node_type v = 0; v < n; v += 2) {
+      h.add_edge(v, v + 1, 0);
+      h.add_edge(v + 1, v, 0);
+      h.add_edge(v, v, 1);
+      h.add_edge(v + 1, std::min(v + 2, n - 1), 1);
+    }
+    h.max_threads(4);
+    REQUIRE(h.nr_scc() == n / 2);
+    for (node_type v = 0; v < n; ++v) {
+      REQUIRE(h.root_of_scc(v) == v - v % 2);
+    }
+    for (auto it = h.cbegin_sccs(); it < h.cend_sccs(); ++it) {
+      REQUIRE(std::is_sorted(it->cbegin(), it->cend()));
+      if (it > h.cbegin_sccs()) {
+        REQUIRE((it - 1)->front() < it->front());
+      }
+    }
+
+    // A cycle with the edges in the opposite direction to the nodes
+    ActionDigraph<size_t> k(n, 1);
+    for (node_type v = 0; v < n; ++v) {
+      k.add_edge(v, (v + n - 1) % n, 0);
+    }
+    k.max_threads(4);
+    REQUIRE(k.nr_scc() == 1);
+    REQUIRE(k.root_of_scc(n - 1) == 0);
+    REQUIRE(k.cbegin_sccs()->size() == n);
+  }
 }  // namespace libsemigroups
@@ -18,6 +18,7 @@
 
 #include <cstddef>  // for size_t
 #include <cstdint>  // for uint32_t, int32_t, int64_t
+#include <thread>   // for thread
 #include <vector>   // for vector
 
 #include "blocks.hpp"                // for Blocks
@@ -740,6 +741,36 @@ namespace libsemigroups {
     z.redefine(y, id, 0);
     REQUIRE(z == y);
   }
+
+  LIBSEMIGROUPS_TEST_CASE("Bipartition",
+                          "009",
+                          "products in threads not in the thread pool",
+                          "[quick][element]") {
+    auto x = Bipartition(
+        {0, 1, 2, 1, 0, 2, 1, 0, 2, 2, 0, 0, 2, 0, 3, 4, 4, 1, 3, 0});
+    auto y = Bipartition(
+        {0, 1, 1, 1, 1, 2, 3, 2, 4, 5, 5, 2, 4, 2, 1, 1, 1, 2, 3, 2});
+    auto expected = Bipartition(
+        {0, 1, 0, 1, 0, 0, 1, 0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 1, 1, 1});
+
+    std::vector<Bipartition> results(8, x.identity());
+    for (size_t i = 0; i < 2; ++i) {
+      std::vector<std::thread> threads;
+      for (size_t j = 0; j < results.size(); ++j) {
+        threads.emplace_back([&x, &y, &results, j]() {
+          for (size_t k = 0; k < 100; ++k) {
+            results[j].redefine(x, y, 0);
+          }
+        });
+      }
+      for (auto& t : threads) {
+        t.join();
+      }
+      for (auto const& z : results) {
+        REQUIRE(z == expected);
+      }
+    }
+  }
   LIBSEMIGROUPS_TEST_CASE("ProjectiveMaxPlusMatrix",
                           "001",
                           "methods",
@@ -188,5 +188,39 @@ namespace libsemigroups {
       REQUIRE(static_cast<word_type>(x) == word_type({0}));
       REQUIRE(static_cast<std::string>(x) == std::string(1, kb.alphabet()[0]));
     }
+
+    LIBSEMIGROUPS_TEST_CASE("KBE", "007", "pooled allocation", "[quick]") {
+      auto        rg = ReportGuard(REPORT);
+      KnuthBendix kb;
+      kb.set_alphabet("ab");
+      kb.add_rule("aaa", "a");
+      kb.add_rule("bbbb", "b");
+      kb.add_rule("abbbbbabb", "bba");
+      REQUIRE(kb.confluent() == false);
+      kb.run();
+
+      KBE               a(kb, 0);
+      KBE               b(kb, 1);
+      std::vector<KBE*> elts;
+      for (size_t i = 0; i < 3000; ++i) {
+        elts.push_back(i % 2 == 0 ? a.heap_copy() : b.heap_copy());
+      }
+      for (size_t i = 0; i < elts.size(); i += 2) {
+        delete elts[i];
+        elts[i] = b.heap_copy();
+      }
+      for (auto x : elts) {
+        REQUIRE(*x == b);
+      }
+      Element* x = a.heap_identity();
+      REQUIRE(*x == KBE(&kb));
+      delete x;
+      for (auto y : elts) {
+        delete y;
+      }
+
+      FroidurePin<KBE> S({a, b});
+      REQUIRE(S.size() == 12);
+    }
   }  // namespace detail
 }  // namespace libsemigroups
@@ -20,11 +20,16 @@
 //    reduction orderings different from shortlex
 // 2. Examples from MAF
 
-#include <iostream>  // for ostringstream
+#include <algorithm>  // for sort, unique
+#include <chrono>     // for microseconds
+#include <iostream>   // for ostringstream
+#include <memory>     // for make_shared
+#include <sstream>    // for stringstream
 #include <string>    // for string
 #include <utility>   // for pair
 #include <vector>    // for vector
 
+#include "blackboard.hpp"  // for Blackboard
 #include "catch.hpp"  // for REQUIRE, REQUIRE_NOTHROW, REQUIRE_THROWS_AS
 #include "element-helper.hpp"        // for TransfHelper
 #include "element.hpp"               // for Element, Transf, Transf...
@@ -32,6 +37,7 @@
 #include "kbe.hpp"                   // for detail::KBE
 #include "knuth-bendix.hpp"          // for KnuthBendix, operator<<
 #include "libsemigroups-config.hpp"  // for LIBSEMIGROUPS_DEBUG
+#include "order.hpp"                 // for shortlex_words
 #include "report.hpp"                // for ReportGuard
 #include "test-main.hpp"             // for LIBSEMIGROUPS_TEST_CASE
 #include "types.hpp"                 // for word_type
@@ -1449,8 +1455,8 @@ namespace libsemigroups {
                {"bd", "aa"}, {"ca", "ac"},  {"cb", "d"},   {"cc", "ad"},
                {"cd", "e"},  {"ce", "bb"},  {"da", "ad"},  {"db", "aa"},
                {"dc", "e"},  {"dd", "be"},  {"de", "a"},   {"ea", "b"},
-               {"eb", "be"}, {"ec", "bb"},  {"ed", "a"},   {"ee", "ca"},
-               {"aaa", "e"}, {"aac", "be"}, {"bbb", "ed"}, {"bbe", "aad"}}));
+               {"eb", "be"}, {"ec", "bb"},  {"ed", "a"},   {"ee", "ac"},
+               {"aaa", "e"}, {"aac", "be"}, {"bbb", "a"},  {"bbe", "aad"}}));
     }
 
     // trivial group - BHN presentation
@@ -1944,8 +1950,8 @@ namespace libsemigroups {
                {"bd", "aa"}, {"ca", "ac"},  {"cb", "d"},   {"cc", "ad"},
                {"cd", "y"},  {"cy", "bb"},  {"da", "ad"},  {"db", "aa"},
                {"dc", "y"},  {"dd", "by"},  {"dy", "a"},   {"ya", "b"},
-               {"yb", "by"}, {"yc", "bb"},  {"yd", "a"},   {"yy", "ca"},
-               {"aaa", "y"}, {"aac", "by"}, {"bbb", "yd"}, {"bby", "aad"}}));
+               {"yb", "by"}, {"yc", "bb"},  {"yd", "a"},   {"yy", "ac"},
+               {"aaa", "y"}, {"aac", "by"}, {"bbb", "a"},  {"bby", "aad"}}));
     }
 
     // Second of BHN's series of increasingly complicated presentations of 1.
@@ -2762,6 +2768,347 @@ namespace libsemigroups {
       REQUIRE_THROWS_AS(kb3.set_identity("ab"), LibsemigroupsException);
       REQUIRE_NOTHROW(kb3.set_identity("a"));
     }
+
+    LIBSEMIGROUPS_TEST_CASE("KnuthBendix",
+                            "102",
+                            "(fpsemi) normal_forms and equal_to (many words)",
+                            "[quick][knuth-bendix][fpsemigroup][fpsemi]") {
+      auto        rg = ReportGuard(REPORT);
+      KnuthBendix kb;
+      kb.set_alphabet("ab");
+      kb.add_rule("aaa", "a");
+      kb.add_rule("bbbb", "b");
+      kb.add_rule("abbbbbabb", "bba");
+      kb.max_threads(4);
+      REQUIRE(kb.max_threads() == 4);
+
+      auto words = shortlex_words(2, 10);
+      REQUIRE(words.size() == 2046);
+
+      auto nfs = kb.normal_forms(words);
+      REQUIRE(nfs.size() == words.size());
+      for (size_t i = 0; i < words.size(); ++i) {
+        REQUIRE(nfs[i] == kb.normal_form(words[i]));
+      }
+      std::sort(nfs.begin(), nfs.end());
+      nfs.erase(std::unique(nfs.begin(), nfs.end()), nfs.end());
+      REQUIRE(nfs.size() == 12);
+
+      std::vector<std::string> swords;
+      for (auto const& w : words) {
+        swords.push_back(kb.word_to_string(w));
+      }
+      auto snfs = kb.normal_forms(swords);
+      for (size_t i = 0; i < swords.size(); ++i) {
+        REQUIRE(snfs[i] == kb.normal_form(swords[i]));
+      }
+
+      std::vector<relation_type> pairs;
+      std::vector<FpSemigroupInterface::rule_type> spairs;
+      for (size_t i = 0; i < words.size(); i += 7) {
+        pairs.emplace_back(words[i], words[words.size() - i - 1]);
+        spairs.emplace_back(swords[i], swords[words.size() - i - 1]);
+      }
+      auto eqs  = kb.equal_to(pairs);
+      auto seqs = kb.equal_to(spairs);
+      REQUIRE(eqs == seqs);
+      for (size_t i = 0; i < pairs.size(); ++i) {
+        REQUIRE(eqs[i] == kb.equal_to(pairs[i].first, pairs[i].second));
+      }
+      REQUIRE(kb.equal_to(std::vector<relation_type>({{{0, 0, 0}, {0}}}))
+              == std::vector<bool>({true}));
+
+      REQUIRE_THROWS_AS(kb.normal_forms(std::vector<word_type>({{0}, {2}})),
+                        LibsemigroupsException);
+      REQUIRE_THROWS_AS(kb.normal_forms(std::vector<std::string>({"a", "c"})),
+                        LibsemigroupsException);
+      REQUIRE(kb.max_threads(0).max_threads() == 1);
+    }
+
+    LIBSEMIGROUPS_TEST_CASE("KnuthBendix",
+                            "103",
+                            "(fpsemi) save and load",
+                            "[quick][knuth-bendix][fpsemigroup][fpsemi]") {
+      auto        rg = ReportGuard(REPORT);
+      KnuthBendix kb1;
+      kb1.set_alphabet("cab");
+      kb1.add_rule("aaa", "a");
+      kb1.add_rule("bbbb", "b");
+      kb1.add_rule("abbbbbabb", "bba");
+      kb1.add_rule("cc", "c");
+      kb1.add_rule("ca", "a");
+      kb1.add_rule("cb", "b");
+      kb1.add_rule("ac", "a");
+      kb1.add_rule("bc", "b");
+      kb1.overlap_policy(KnuthBendix::policy::overlap::AB_BC);
+      kb1.max_rules(1000);
+
+      std::stringstream ss;
+      REQUIRE_THROWS_AS(kb1.save(ss), LibsemigroupsException);
+      kb1.run();
+      REQUIRE(kb1.confluent());
+      kb1.save(ss);
+
+      KnuthBendix kb2;
+      kb2.load(ss);
+      REQUIRE(kb2.alphabet() == "cab");
+      REQUIRE(kb2.confluent());
+      REQUIRE(kb2.active_rules() == kb1.active_rules());
+      REQUIRE(kb2.nr_active_rules() == kb1.nr_active_rules());
+      REQUIRE(kb2.size() == kb1.size());
+      REQUIRE(kb2.normal_form("bbbbbbbbbcaaaab")
+              == kb1.normal_form("bbbbbbbbbcaaaab"));
+      REQUIRE(kb2.equal_to("abbbbbabb", "bba"));
+
+      // Cannot load twice
+      std::stringstream ss2;
+      kb2.save(ss2);
+      REQUIRE_THROWS_AS(kb2.load(ss2), LibsemigroupsException);
+
+      // Truncated or invalid input
+      std::string const data = ss2.str();
+      for (size_t i = 0; i < data.size(); i += 5) {
+        std::stringstream bad(data.substr(0, i));
+        KnuthBendix       kb3;
+        REQUIRE_THROWS_AS(kb3.load(bad), LibsemigroupsException);
+      }
+      std::stringstream bad("LSKX");
+      KnuthBendix       kb4;
+      REQUIRE_THROWS_AS(kb4.load(bad), LibsemigroupsException);
+    }
+
+    LIBSEMIGROUPS_TEST_CASE("KnuthBendix",
+                            "104",
+                            "(fpsemi) weighted short-lex ordering",
+                            "[quick][knuth-bendix][fpsemigroup][fpsemi]") {
+      auto        rg = ReportGuard(REPORT);
+      KnuthBendix kb;
+      REQUIRE(kb.order() == KnuthBendix::policy::order::shortlex);
+      REQUIRE_THROWS_AS(kb.weights({1, 3}), LibsemigroupsException);
+      kb.set_alphabet("ab");
+      REQUIRE(kb.weights() == std::vector<size_t>({1, 1}));
+      REQUIRE_THROWS_AS(kb.weights({1}), LibsemigroupsException);
+      REQUIRE_THROWS_AS(kb.weights({1, 0}), LibsemigroupsException);
+      kb.order(KnuthBendix::policy::order::weighted_shortlex).weights({1, 3});
+      REQUIRE(kb.weights() == std::vector<size_t>({1, 3}));
+
+      // b has weight 3 > 2 = weight of aa, so the rule b -> aa increases the
+      // length of a word.
+      kb.add_rule("b", "aa");
+      kb.add_rule("aaaa", "a");
+      REQUIRE_THROWS_AS(kb.order(KnuthBendix::policy::order::shortlex),
+                        LibsemigroupsException);
+      REQUIRE_THROWS_AS(kb.weights({1, 1}), LibsemigroupsException);
+
+      kb.run();
+      REQUIRE(kb.confluent());
+      REQUIRE(kb.active_rules()
+              == std::vector<KnuthBendix::rule_type>(
+                  {{"b", "aa"}, {"aaaa", "a"}}));
+      REQUIRE(kb.rewrite("b") == "aa");
+      REQUIRE(kb.rewrite("bb") == "a");
+      REQUIRE(kb.rewrite("abab") == "aaa");
+      REQUIRE(kb.normal_forms(std::vector<std::string>({"b", "bb", "bbb"}))
+              == std::vector<std::string>({"aa", "a", "aaa"}));
+      REQUIRE(kb.size() == 3);
+
+      KnuthBendix kb2(kb);
+      REQUIRE(kb2.order() == KnuthBendix::policy::order::weighted_shortlex);
+      REQUIRE(kb2.weights() == std::vector<size_t>({1, 3}));
+      REQUIRE(kb2.active_rules() == kb.active_rules());
+
+      std::stringstream ss;
+      kb.save(ss);
+      KnuthBendix kb3;
+      kb3.load(ss);
+      REQUIRE(kb3.order() == KnuthBendix::policy::order::weighted_shortlex);
+      REQUIRE(kb3.weights() == std::vector<size_t>({1, 3}));
+      REQUIRE(kb3.active_rules() == kb.active_rules());
+      REQUIRE(kb3.rewrite("bbb") == "aaa");
+    }
+
+    LIBSEMIGROUPS_TEST_CASE("KnuthBendix",
+                            "105",
+                            "(fpsemi) recursive path ordering",
+                            "[quick][knuth-bendix][fpsemigroup][fpsemi]") {
+      auto        rg = ReportGuard(REPORT);
+      KnuthBendix kb;
+      kb.set_alphabet("ab");
+      kb.order(KnuthBendix::policy::order::recursive);
+      // ab is greater than baa in the recursive path ordering, and so the rule
+      // ab -> baa increases the length of a word.
+      REQUIRE(recursive_path_compare(std::string("baa"), std::string("ab")));
+      kb.add_rule("baa", "ab");
+      kb.run();
+      REQUIRE(kb.confluent());
+      REQUIRE(kb.active_rules()
+              == std::vector<KnuthBendix::rule_type>({{"ab", "baa"}}));
+      REQUIRE(kb.rewrite("aab") == "baaaa");
+      REQUIRE(kb.rewrite("abb") == "bbaaaa");
+      REQUIRE(kb.rewrite("bba") == "bba");
+    }
+
+    LIBSEMIGROUPS_TEST_CASE("KnuthBendix",
+                            "106",
+                            "(fpsemi) all reduction orderings agree",
+                            "[quick][knuth-bendix][fpsemigroup][fpsemi]") {
+      auto rg = ReportGuard(REPORT);
+      using order = KnuthBendix::policy::order;
+      std::vector<size_t> sizes;
+      for (auto val :
+           {order::shortlex, order::weighted_shortlex, order::recursive}) {
+        KnuthBendix kb;
+        kb.set_alphabet("cab");
+        kb.order(val);
+        if (val == order::weighted_shortlex) {
+          kb.weights({1, 3, 2});
+        }
+        kb.add_rule("aaa", "a");
+        kb.add_rule("bbbb", "b");
+        kb.add_rule("abbbbbabb", "bba");
+        kb.add_rule("cc", "c");
+        kb.add_rule("ca", "a");
+        kb.add_rule("cb", "b");
+        kb.add_rule("ac", "a");
+        kb.add_rule("bc", "b");
+        kb.run();
+        REQUIRE(kb.confluent());
+        sizes.push_back(kb.size());
+        std::vector<std::string> words;
+        for (auto const& w : shortlex_words(3, 6)) {
+          words.push_back(kb.word_to_string(w));
+        }
+        auto nfs = kb.normal_forms(words);
+        for (size_t i = 0; i < words.size(); ++i) {
+          REQUIRE(kb.rewrite(nfs[i]) == nfs[i]);
+        }
+        REQUIRE(kb.equal_to("abbbbbabb", "bba"));
+        REQUIRE(!kb.equal_to("a", "b"));
+      }
+      REQUIRE(sizes[0] == sizes[1]);
+      REQUIRE(sizes[0] == sizes[2]);
+    }
+
+    LIBSEMIGROUPS_TEST_CASE("KnuthBendix",
+                            "107",
+                            "(fpsemi) memory budget",
+                            "[quick][knuth-bendix][fpsemigroup][fpsemi]") {
+      auto rg = ReportGuard(REPORT);
+      for (auto val : {KnuthBendix::policy::prune::longest_rules,
+                       KnuthBendix::policy::prune::overlap_length}) {
+        // SL(2, 7), see KnuthBendix 016
+        KnuthBendix kb;
+        kb.set_alphabet("abAB");
+        kb.add_rule("aaaaaaa", "");
+        kb.add_rule("bb", "ababab");
+        kb.add_rule("bb", "aaaabaaaabaaaabaaaab");
+        kb.add_rule("aA", "");
+        kb.add_rule("Aa", "");
+        kb.add_rule("bB", "");
+        kb.add_rule("Bb", "");
+        REQUIRE(kb.nr_discarded_rules() == 0);
+
+        kb.max_memory(4096).prune_policy(val);
+        kb.run();
+        REQUIRE(!kb.confluent());
+        if (val == KnuthBendix::policy::prune::longest_rules) {
+          REQUIRE(kb.nr_discarded_rules() > 0);
+        } else {
+          REQUIRE(kb.nr_discarded_rules() == 0);
+        }
+
+        kb.max_memory(POSITIVE_INFINITY);
+        kb.run();
+        REQUIRE(kb.confluent());
+        REQUIRE(kb.nr_active_rules() == 152);
+        REQUIRE(kb.size() == 336);
+        REQUIRE(kb.memory_used() > 0);
+      }
+    }
+
+    LIBSEMIGROUPS_TEST_CASE("KnuthBendix",
+                            "109",
+                            "(fpsemi) resuming after run_for",
+                            "[quick][knuth-bendix][fpsemigroup][fpsemi]") {
+      auto rg = ReportGuard(REPORT);
+      // SL(2, 7), see KnuthBendix 016
+      KnuthBendix kb;
+      kb.set_alphabet("abAB");
+      kb.add_rule("aaaaaaa", "");
+      kb.add_rule("bb", "ababab");
+      kb.add_rule("bb", "aaaabaaaabaaaabaaaab");
+      kb.add_rule("aA", "");
+      kb.add_rule("Aa", "");
+      kb.add_rule("bB", "");
+      kb.add_rule("Bb", "");
+
+      while (!kb.finished()) {
+        kb.run_for(std::chrono::microseconds(100));
+      }
+      REQUIRE(kb.confluent());
+      REQUIRE(kb.nr_active_rules() == 152);
+      REQUIRE(kb.size() == 336);
+    }
+
+    LIBSEMIGROUPS_TEST_CASE("KnuthBendix",
+                            "110",
+                            "(fpsemi) load rejects rules that are not reduced",
+                            "[quick][knuth-bendix][fpsemigroup][fpsemi]") {
+      auto        rg = ReportGuard(REPORT);
+      KnuthBendix kb1;
+      kb1.set_alphabet("ab");
+      kb1.add_rule("aa", "a");
+      kb1.add_rule("bb", "b");
+      kb1.add_rule("ba", "ab");
+      REQUIRE(kb1.confluent());
+      REQUIRE(kb1.active_rules()
+              == std::vector<KnuthBendix::rule_type>(
+                  {{"aa", "a"}, {"ba", "ab"}, {"bb", "b"}}));
+      std::stringstream ss;
+      kb1.save(ss);
+      std::string const data = ss.str();
+
+      // The lengths of the words are written as 8 bytes, least significant
+      // first.
+      auto const word = [](std::string const& w) {
+        return std::string(1, static_cast<char>(w.size()))
+               + std::string(7, '\0') + w;
+      };
+      // Returns data with the rule from replaced by the rule to.
+      auto const replace = [&data, &word](KnuthBendix::rule_type const& from,
+                                          KnuthBendix::rule_type const& to) {
+        std::string const old = word(from.first) + word(from.second);
+        std::string       result(data);
+        size_t const      pos = result.find(old);
+        REQUIRE(pos != std::string::npos);
+        return result.replace(
+            pos, old.size(), word(to.first) + word(to.second));
+      };
+
+      KnuthBendix kb2;
+      for (auto const& bad : {
+               // Two rules with the same left hand side
+               replace({"ba", "ab"}, {"bb", "ab"}),
+               // A right hand side that is not irreducible
+               replace({"ba", "ab"}, {"ba", "aa"}),
+               // A left hand side containing that of another rule
+               replace({"bb", "b"}, {"bab", "b"})}) {
+        std::stringstream is(bad);
+        REQUIRE_THROWS_AS(kb2.load(is), LibsemigroupsException);
+        // kb2 is not modified
+        REQUIRE(kb2.alphabet().empty());
+        REQUIRE(kb2.nr_active_rules() == 0);
+      }
+
+      std::stringstream is(data);
+      kb2.load(is);
+      REQUIRE(kb2.confluent());
+      REQUIRE(kb2.active_rules() == kb1.active_rules());
+      // The defining rules are not modified
+      REQUIRE(kb2.nr_rules() == 0);
+      REQUIRE(!kb2.is_obviously_infinite());
+      REQUIRE(kb2.size() == 3);
+    }
   }  // namespace fpsemigroup
 
   namespace congruence {
@@ -3181,5 +3528,26 @@ namespace libsemigroups {
       REQUIRE_THROWS_AS(kb.set_nr_generators(3), LibsemigroupsException);
       REQUIRE_NOTHROW(kb.set_nr_generators(2));
     }
+
+    LIBSEMIGROUPS_TEST_CASE("KnuthBendix",
+                            "108",
+                            "(cong) consuming pairs from a blackboard",
+                            "[quick][congruence][knuth-bendix][cong]") {
+      auto        rg = ReportGuard(REPORT);
+      KnuthBendix kb;
+      kb.set_nr_generators(2);
+      kb.add_pair({0, 0, 0}, {0});
+      kb.add_pair({1, 1, 1}, {1});
+      kb.add_pair({0, 1, 0, 1}, {0, 0});
+      // Without the pair on the blackboard there are 14 classes.
+      auto bb = std::make_shared<detail::Blackboard>();
+      // Only a runner computing the same congruence should publish a pair,
+      // here we publish one that does not hold, to check that it is used.
+      bb->publish(nullptr, {0, 0}, {0});
+      kb.blackboard(bb);
+      REQUIRE(kb.nr_classes() == 8);
+      // The rules found by kb are published in turn.
+      REQUIRE(bb->nr_pairs() > 1);
+    }
   }  // namespace congruence
 }  // namespace libsemigroups
@@ -18,9 +18,15 @@
 
 // The purpose of this file is to test the Race class.
 
+#include <atomic>   // for atomic
+#include <chrono>   // for milliseconds, seconds
 #include <cstddef>  // for size_t
+#include <memory>   // for make_shared
+#include <vector>   // for vector
 
+#include "blackboard.hpp"               // for Blackboard
 #include "catch.hpp"                    // for REQUIRE, REQUIRE_THROWS_AS
+#include "constants.hpp"                // for POSITIVE_INFINITY, UNDEFINED
 #include "libsemigroups-exception.hpp"  // for LibsemigroupsException (ptr o...
 #include "race.hpp"                     // for Race
 #include "report.hpp"                   // for ReportGuard
@@ -65,6 +71,90 @@ namespace libsemigroups {
       }
     };
 
+    // Publishes a single pair, and then waits to be killed.
+    class TestRunner4 : public Runner {
+     private:
+      void run_impl() override {
+        publish_pair({0, 0}, {0});
+        while (!stopped()) {
+        }
+      }
+
+      bool finished_impl() const override {
+        return false;
+      }
+    };
+
+    // Finishes once it has consumed a pair published by another runner.
+    class TestRunner5 : public Runner {
+     public:
+      std::vector<relation_type> consumed;
+
+     private:
+      void run_impl() override {
+        while (!stopped() && !consume_pairs(consumed)) {
+        }
+      }
+
+      bool finished_impl() const override {
+        return !consumed.empty();
+      }
+    };
+
+    // Only stops when it is killed, however long it is asked to run for.
+    class TestRunner6 : public Runner {
+     private:
+      void run_impl() override {
+        CancellationToken cancelled(*this, 16);
+        while (!cancelled()) {
+        }
+      }
+
+      bool finished_impl() const override {
+        return false;
+      }
+    };
+
+    // Counts the number of times it is run, never finishes.
+    class TestRunner7 : public Runner {
+     public:
+      std::atomic<size_t> nr_runs;
+
+      TestRunner7() : Runner(), nr_runs(0) {}
+
+     private:
+      void run_impl() override {
+        ++nr_runs;
+        while (!stopped()) {
+        }
+      }
+
+      bool finished_impl() const override {
+        return false;
+      }
+    };
+
+    // Uses more and more memory, never finishes.
+    class TestRunner8 : public Runner {
+     public:
+      size_t memory_used() const override {
+        return _data.capacity() * sizeof(size_t);
+      }
+
+     private:
+      void run_impl() override {
+        while (!stopped()) {
+          _data.push_back(_data.size());
+        }
+      }
+
+      bool finished_impl() const override {
+        return false;
+      }
+
+      std::vector<size_t> _data;
+    };
+
     LIBSEMIGROUPS_TEST_CASE("Race", "001", "run_for", "[quick]") {
       auto rg = ReportGuard(REPORT);
       Race rc;
@@ -156,5 +246,176 @@ namespace libsemigroups {
       rc.run_for(std::chrono::milliseconds(10));
       REQUIRE(rc.winner() != nullptr);
     }
+
+    LIBSEMIGROUPS_TEST_CASE("Race", "009", "cooperative", "[quick]") {
+      auto rg = ReportGuard(REPORT);
+      Race rc;
+      REQUIRE(!rc.cooperative());
+      rc.cooperative(true).max_threads(2);
+      REQUIRE(rc.cooperative());
+      REQUIRE(rc.blackboard() == nullptr);
+      auto tr = std::make_shared<TestRunner5>();
+      rc.add_runner(std::make_shared<TestRunner4>());
+      rc.add_runner(tr);
+      rc.run();
+      REQUIRE(rc.winner() == tr);
+      REQUIRE(tr->consumed
+              == std::vector<relation_type>({relation_type({0, 0}, {0})}));
+      // The race is over, so the blackboard is released.
+      REQUIRE(rc.blackboard() == nullptr);
+      REQUIRE(tr->blackboard() == nullptr);
+    }
+
+    LIBSEMIGROUPS_TEST_CASE("Race", "010", "Blackboard", "[quick]") {
+      int        x = 0, y = 0;
+      Blackboard bb(3);
+      REQUIRE(bb.max_pairs() == 3);
+      REQUIRE(bb.nr_pairs() == 0);
+      REQUIRE(bb.publish(&x, {0}, {1}));
+      REQUIRE(bb.publish(&y, {1}, {2}));
+      REQUIRE(bb.publish(&x, {2}, {3}));
+      REQUIRE(bb.full());
+      REQUIRE(!bb.publish(&y, {3}, {4}));
+      REQUIRE(bb.nr_pairs() == 3);
+
+      std::vector<relation_type> out;
+      size_t                     pos = 0;
+      REQUIRE(bb.consume(&x, pos, out));
+      REQUIRE(pos == 3);
+      REQUIRE(out == std::vector<relation_type>({relation_type({1}, {2})}));
+      REQUIRE(!bb.consume(&x, pos, out));
+      pos = 0;
+      out.clear();
+      REQUIRE(bb.consume(&y, pos, out));
+      REQUIRE(out
+              == std::vector<relation_type>(
+                  {relation_type({0}, {1}), relation_type({2}, {3})}));
+    }
+
+    LIBSEMIGROUPS_TEST_CASE("Race", "011", "stop latency", "[quick]") {
+      auto rg = ReportGuard(REPORT);
+      Race rc;
+      rc.max_threads(2);
+      REQUIRE(rc.stop_latency() == std::chrono::nanoseconds(0));
+      auto loser  = std::make_shared<TestRunner6>();
+      auto winner = std::make_shared<TestRunner3>();
+      rc.add_runner(loser);
+      rc.add_runner(winner);
+      rc.run();
+      // The race only returns once the loser has stopped.
+      REQUIRE(rc.winner() == winner);
+      REQUIRE(loser->dead());
+      REQUIRE(!loser->running());
+      REQUIRE(rc.stop_latency() < std::chrono::seconds(1));
+    }
+
+    LIBSEMIGROUPS_TEST_CASE("Race", "012", "start_order", "[quick]") {
+      auto rg = ReportGuard(REPORT);
+      Race rc;
+      auto slow = std::make_shared<TestRunner7>();
+      auto fast = std::make_shared<TestRunner3>();
+      rc.add_runner(slow);
+      rc.add_runner(fast);
+      REQUIRE_THROWS_AS(rc.start_order({0}), LibsemigroupsException);
+      REQUIRE_THROWS_AS(rc.start_order({0, 0}), LibsemigroupsException);
+      REQUIRE_THROWS_AS(rc.start_order({0, 2}), LibsemigroupsException);
+      REQUIRE(rc.winner_index() == UNDEFINED);
+      rc.max_threads(2).start_order({1, 0}).initial_runners(1);
+      REQUIRE(rc.initial_runners() == 1);
+      rc.stage_interval(std::chrono::seconds(10));
+      rc.run();
+      // The winner is started first, and finishes before the other runner
+      // is started.
+      REQUIRE(rc.winner() == fast);
+      REQUIRE(rc.winner_index() == 1);
+      REQUIRE(slow->nr_runs == 0);
+    }
+
+    LIBSEMIGROUPS_TEST_CASE("Race", "013", "initial_runners", "[quick]") {
+      auto rg = ReportGuard(REPORT);
+      Race rc;
+      auto slow = std::make_shared<TestRunner7>();
+      auto fast = std::make_shared<TestRunner3>();
+      rc.add_runner(slow);
+      rc.add_runner(fast);
+      rc.max_threads(2).initial_runners(1).stage_interval(
+          std::chrono::milliseconds(10));
+      REQUIRE(rc.stage_interval() == std::chrono::milliseconds(10));
+      rc.run();
+      // The first runner does not finish, and so the second is started after
+      // 10ms.
+      REQUIRE(rc.winner() == fast);
+      REQUIRE(rc.winner_index() == 1);
+      REQUIRE(slow->nr_runs != 0);
+    }
+
+    LIBSEMIGROUPS_TEST_CASE("Race", "014", "RaceHistory", "[quick]") {
+      RaceHistory rh;
+      REQUIRE(rh.size() == 0);
+      REQUIRE(rh.nr_winners("a") == 0);
+      REQUIRE(rh.order("a", 3) == std::vector<size_t>({0, 1, 2}));
+      rh.add_win("a", 2);
+      rh.add_win("a", 2);
+      rh.add_win("a", 1);
+      rh.add_win("b", 0);
+      REQUIRE(rh.size() == 2);
+      REQUIRE(rh.nr_wins("a", 2) == 2);
+      REQUIRE(rh.nr_wins("a", 0) == 0);
+      REQUIRE(rh.nr_wins("a", 10) == 0);
+      REQUIRE(rh.nr_winners("a") == 2);
+      REQUIRE(rh.order("a", 4) == std::vector<size_t>({2, 1, 0, 3}));
+      REQUIRE(rh.order("b", 2) == std::vector<size_t>({0, 1}));
+      rh.clear();
+      REQUIRE(rh.size() == 0);
+    }
+
+    LIBSEMIGROUPS_TEST_CASE("Race", "015", "budget", "[quick]") {
+      auto rg = ReportGuard(REPORT);
+      {
+        // In 1 thread, the second runner is only run because the first
+        // exceeds its budget.
+        Race rc;
+        auto hog  = std::make_shared<TestRunner8>();
+        auto fast = std::make_shared<TestRunner3>();
+        rc.add_runner(hog);
+        rc.add_runner(fast);
+        rc.max_threads(1).budget(size_t(1) << 20, FOREVER);
+        REQUIRE(fast->memory_limit() == size_t(1) << 20);
+        rc.run();
+        REQUIRE(hog->over_memory_limit());
+        REQUIRE(rc.winner() == fast);
+        REQUIRE(rc.winner_index() == 1);
+      }
+      {
+        // The runner that exceeds its budget is dropped, and the next is
+        // started straight away, and not after the stage interval.
+        Race rc;
+        auto hog  = std::make_shared<TestRunner8>();
+        auto fast = std::make_shared<TestRunner3>();
+        rc.add_runner(hog);
+        rc.add_runner(fast);
+        rc.max_threads(2).initial_runners(1).stage_interval(
+            std::chrono::seconds(60));
+        rc.budget(size_t(1) << 20, FOREVER);
+        rc.run();
+        REQUIRE(rc.winner() == fast);
+      }
+      {
+        Race rc;
+        rc.add_runner(std::make_shared<TestRunner8>());
+        rc.add_runner(std::make_shared<TestRunner8>());
+        rc.max_threads(2).budget(size_t(1) << 20, FOREVER);
+        REQUIRE_THROWS_AS(rc.run(), LibsemigroupsException);
+        REQUIRE(!rc.finished());
+      }
+      {
+        Race rc;
+        rc.add_runner(std::make_shared<TestRunner7>());
+        rc.add_runner(std::make_shared<TestRunner7>());
+        rc.max_threads(2).budget(POSITIVE_INFINITY,
+                                 std::chrono::milliseconds(10));
+        REQUIRE_THROWS_AS(rc.run(), LibsemigroupsException);
+      }
+    }
   }  // namespace detail
 }  // namespace libsemigroups
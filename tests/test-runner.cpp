@@ -19,8 +19,10 @@
 // The purpose of this file is to test the Runner class.
 
 #include <cstddef>  // for size_t
+#include <vector>   // for vector
 
 #include "catch.hpp"      // for REQUIRE, REQUIRE_NOTHROW
+#include "constants.hpp"  // for POSITIVE_INFINITY
 #include "report.hpp"     // for ReportGuard
 #include "runner.hpp"     // for Runner
 #include "test-main.hpp"  // for LIBSEMIGROUPS_TEST_CASE
@@ -67,6 +69,61 @@ namespace libsemigroups {
       }
     };
 
+    // The test runners in this file and in test-race.cpp belong to the same
+    // namespace, and so their names must be distinct.
+
+    // Uses more and more memory, never finishes.
+    class TestRunner9 : public Runner {
+     public:
+      size_t memory_used() const override {
+        return _data.capacity() * sizeof(size_t);
+      }
+
+     private:
+      void run_impl() override {
+        while (!stopped()) {
+          _data.push_back(_data.size());
+        }
+        report_why_we_stopped();
+      }
+
+      bool finished_impl() const override {
+        return false;
+      }
+
+      std::vector<size_t> _data;
+    };
+
+    // Never finishes, and does not sleep.
+    class TestRunner10 : public Runner {
+     private:
+      void run_impl() override {
+        while (!stopped()) {
+        }
+        report_why_we_stopped();
+      }
+
+      bool finished_impl() const override {
+        return false;
+      }
+    };
+
+    // Uses some CPU time, and then throws.
+    class TestRunner11 : public Runner {
+     private:
+      void run_impl() override {
+        auto const start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start
+               < std::chrono::milliseconds(5)) {
+        }
+        LIBSEMIGROUPS_EXCEPTION("run_impl failed");
+      }
+
+      bool finished_impl() const override {
+        return false;
+      }
+    };
+
     LIBSEMIGROUPS_TEST_CASE("Runner", "000", "run_for", "[quick]") {
       auto        rg = ReportGuard(REPORT);
       TestRunner1 tr;
@@ -191,5 +248,109 @@ namespace libsemigroups {
       REQUIRE(tr.report());
     }
 
+    LIBSEMIGROUPS_TEST_CASE("Runner",
+                            "009",
+                            "CancellationToken",
+                            "[quick]") {
+      auto              rg = ReportGuard(REPORT);
+      TestRunner3       tr;
+      CancellationToken cancelled(tr, 4);
+      REQUIRE(!cancelled());
+      tr.kill();
+      // The runner is only checked every 4 calls
+      size_t nr = 1;
+      while (!cancelled()) {
+        ++nr;
+      }
+      REQUIRE(nr <= 4);
+      REQUIRE(cancelled());
+      REQUIRE(cancelled.stopped());
+
+      TestRunner2       tr2;
+      CancellationToken stppd(tr2, 1);
+      REQUIRE(!stppd.stopped());
+      tr2.run_for(std::chrono::milliseconds(10));
+      REQUIRE(!stppd.stopped());
+      REQUIRE(!stppd());
+    }
+
+    LIBSEMIGROUPS_TEST_CASE("Runner", "010", "memory_limit", "[quick]") {
+      auto        rg = ReportGuard(REPORT);
+      TestRunner9 tr;
+      REQUIRE(tr.memory_limit() == POSITIVE_INFINITY);
+      tr.memory_limit(size_t(1) << 20);
+      REQUIRE(tr.memory_limit() == size_t(1) << 20);
+      tr.run();
+      REQUIRE(tr.over_memory_limit());
+      REQUIRE(!tr.over_cpu_time_limit());
+      REQUIRE(tr.memory_used() > size_t(1) << 20);
+      REQUIRE(tr.stopped());
+      REQUIRE(!tr.finished());
+      REQUIRE(!tr.dead());
+      REQUIRE(!tr.timed_out());
+
+      tr.memory_limit(size_t(1) << 24);
+      tr.run_for(std::chrono::seconds(10));
+      REQUIRE(tr.over_memory_limit());
+      REQUIRE(!tr.timed_out());
+      REQUIRE(tr.memory_used() > size_t(1) << 24);
+
+      // The limits are copied
+      TestRunner9 copy(tr);
+      REQUIRE(copy.memory_limit() == size_t(1) << 24);
+      REQUIRE(copy.over_memory_limit());
+    }
+
+    LIBSEMIGROUPS_TEST_CASE("Runner", "011", "cpu_time_limit", "[quick]") {
+      auto         rg = ReportGuard(REPORT);
+      TestRunner10 tr;
+      REQUIRE(tr.cpu_time_limit() == FOREVER);
+      REQUIRE(tr.cpu_time() == std::chrono::nanoseconds(0));
+      tr.run_for(std::chrono::milliseconds(10));
+      REQUIRE(tr.timed_out());
+      REQUIRE(!tr.over_cpu_time_limit());
+      REQUIRE(tr.cpu_time() > std::chrono::nanoseconds(0));
+
+      auto const limit = tr.cpu_time() + std::chrono::milliseconds(20);
+      tr.cpu_time_limit(limit);
+      REQUIRE(tr.cpu_time_limit() == limit);
+      tr.run();
+      REQUIRE(tr.over_cpu_time_limit());
+      REQUIRE(!tr.over_memory_limit());
+      REQUIRE(tr.cpu_time() >= limit);
+      REQUIRE(tr.stopped());
+      REQUIRE(!tr.timed_out());
+
+      // TestRunner10 does not use any memory, so a memory limit has no effect
+      tr.cpu_time_limit(FOREVER);
+      tr.memory_limit(0);
+      tr.run_for(std::chrono::milliseconds(10));
+      REQUIRE(tr.timed_out());
+    }
+
+    LIBSEMIGROUPS_TEST_CASE("Runner",
+                            "012",
+                            "cpu_time when run_impl throws",
+                            "[quick]") {
+      auto         rg = ReportGuard(REPORT);
+      TestRunner11 tr;
+      REQUIRE_THROWS_AS(tr.run_for(std::chrono::milliseconds(100)),
+                        LibsemigroupsException);
+      REQUIRE(!tr.running());
+      auto t = tr.cpu_time();
+      REQUIRE(t > std::chrono::nanoseconds(0));
+      REQUIRE(tr.cpu_time() == t);
+
+      REQUIRE_THROWS_AS(tr.run_until([]() { return false; }),
+                        LibsemigroupsException);
+      REQUIRE(!tr.running());
+      REQUIRE(tr.cpu_time() > t);
+      t = tr.cpu_time();
+      REQUIRE(tr.cpu_time() == t);
+
+      REQUIRE_THROWS_AS(tr.run(), LibsemigroupsException);
+      REQUIRE(!tr.running());
+      REQUIRE(tr.cpu_time() > t);
+    }
   }  // namespace detail
 }  // namespace libsemigroups
@@ -23,8 +23,10 @@
 //
 //   http://brauer.maths.qmul.ac.uk/Atlas/
 
-#include <cstddef>  // for size_t
-#include <cstdint>  // for uint64_t
+#include <algorithm>  // for count
+#include <cstddef>    // for size_t
+#include <cstdint>    // for uint64_t
+#include <vector>     // for vector
 
 #include "catch.hpp"                 // for LIBSEMIGROUPS_TEST_CASE
 #include "libsemigroups-config.hpp"  // for LIBSEMIGROUPS_HPCOMBI
@@ -3075,4 +3077,243 @@ namespace libsemigroups {
     }
     REQUIRE_THROWS_AS(S.add_base_point(6), LibsemigroupsException);
   }
+
+  LIBSEMIGROUPS_TEST_CASE("SchreierSims",
+                          "042",
+                          "randomised version",
+                          "[quick][schreier-sims]") {
+    auto             rg = ReportGuard(REPORT);
+    constexpr size_t N  = 24;
+    auto             S  = SchreierSims<N>();
+    using Perm          = decltype(S)::element_type;
+    REQUIRE(!S.randomised());
+    REQUIRE(!S.verify());
+    REQUIRE(S.confidence() == 20);
+    REQUIRE_THROWS_AS(S.confidence(0), LibsemigroupsException);
+
+    S.randomised(true).confidence(30);
+    REQUIRE(S.randomised());
+    REQUIRE(S.confidence() == 30);
+    S.add_generator(Perm({1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12,
+                          13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 0,  23}));
+    S.add_generator(Perm({0,  1,  16, 12, 3, 5,  8, 17, 2,  6,  11, 22,
+                          13, 18, 19, 14, 9, 10, 4, 21, 15, 20, 7,  23}));
+    S.add_generator(Perm({23, 22, 11, 15, 17, 9, 19, 13, 20, 5,  16, 2,
+                          21, 7,  18, 3,  10, 4, 14, 6,  8,  12, 1,  0}));
+    REQUIRE(S.size() == 244823040);
+    REQUIRE(S.finished());
+    REQUIRE(S.contains(Perm({12, 16, 18, 10, 20, 14, 21, 6,  17, 3,  22, 8,
+                             19, 4,  11, 5,  15, 7,  9,  13, 2,  23, 0,  1})));
+    REQUIRE(
+        !S.contains(Perm({0,  3,  2,  1,  4,  5,  6,  7,  8,  9,  10, 11,
+                          12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23})));
+
+    // With a single random element the stabiliser chain is probably not
+    // complete, but it is completed by the verification.
+    S.clear();
+    S.randomised(true).confidence(1).verify(true);
+    S.add_generator(Perm({1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12,
+                          13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 0,  23}));
+    S.add_generator(Perm({0,  1,  16, 12, 3, 5,  8, 17, 2,  6,  11, 22,
+                          13, 18, 19, 14, 9, 10, 4, 21, 15, 20, 7,  23}));
+    S.add_generator(Perm({23, 22, 11, 15, 17, 9, 19, 13, 20, 5,  16, 2,
+                          21, 7,  18, 3,  10, 4, 14, 6,  8,  12, 1,  0}));
+    REQUIRE(S.size() == 244823040);
+
+    // Symmetric group of degree 17, with a prescribed base
+    SchreierSims<17> T;
+    using Perm17 = SchreierSims<17>::element_type;
+    T.randomised(true).verify(true);
+    T.add_base_point(14);
+    T.add_base_point(15);
+    T.add_generator(
+        Perm17({1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 0}));
+    T.add_generator(
+        Perm17({1, 0, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16}));
+    REQUIRE(T.size() == static_cast<uint64_t>(355687428096000));
+    REQUIRE(T.base(0) == 14);
+    REQUIRE(T.base(1) == 15);
+    REQUIRE(T.contains(
+        Perm17({1, 0, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 16, 15})));
+  }
+
+  LIBSEMIGROUPS_TEST_CASE("SchreierSims",
+                          "043",
+                          "Schreier vectors",
+                          "[quick][schreier-sims]") {
+    auto             rg = ReportGuard(REPORT);
+    constexpr size_t N  = 24;
+    auto             S  = SchreierSims<N>();
+    auto             T  = SchreierSims<N>();
+    using Perm          = decltype(S)::element_type;
+    REQUIRE(!S.schreier_vectors());
+    S.schreier_vectors(true);
+    REQUIRE(S.schreier_vectors());
+
+    std::vector<Perm> gens
+        = {Perm({1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12,
+                 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 0,  23}),
+           Perm({0,  1,  16, 12, 3, 5,  8, 17, 2,  6,  11, 22,
+                 13, 18, 19, 14, 9, 10, 4, 21, 15, 20, 7,  23}),
+           Perm({23, 22, 11, 15, 17, 9, 19, 13, 20, 5,  16, 2,
+                 21, 7,  18, 3,  10, 4, 14, 6,  8,  12, 1,  0})};
+    for (auto const& x : gens) {
+      S.add_generator(x);
+      T.add_generator(x);
+    }
+    REQUIRE(S.size() == 244823040);
+    REQUIRE(T.size() == 244823040);
+    REQUIRE(S.base_size() == T.base_size());
+    for (size_t i = 0; i < S.base_size(); ++i) {
+      REQUIRE(S.base(i) == T.base(i));
+      REQUIRE(S.nr_strong_generators(i) == T.nr_strong_generators(i));
+    }
+    REQUIRE(S.contains(Perm({12, 16, 18, 10, 20, 14, 21, 6,  17, 3,  22, 8,
+                             19, 4,  11, 5,  15, 7,  9,  13, 2,  23, 0,  1})));
+    REQUIRE(
+        !S.contains(Perm({0,  3,  2,  1,  4,  5,  6,  7,  8,  9,  10, 11,
+                          12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23})));
+
+    // The sifted elements are the same as with explicit transversals
+    Perm x = Perm({0,  1,  3,  4,  2,  6,  5,  7,  8,  9,  10, 11,
+                   12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23});
+    for (size_t i = 0; i < 100; ++i) {
+      REQUIRE(S.sift(x) == T.sift(x));
+      x = x * gens[i % 3];
+    }
+
+    REQUIRE_THROWS_AS(S.schreier_vectors(false), LibsemigroupsException);
+    REQUIRE_NOTHROW(S.schreier_vectors(true));
+    S.clear();
+    REQUIRE_NOTHROW(S.schreier_vectors(false));
+    S.schreier_vectors(true).randomised(true).verify(true);
+    for (auto const& g : gens) {
+      S.add_generator(g);
+    }
+    REQUIRE(S.size() == 244823040);
+  }
+
+  LIBSEMIGROUPS_TEST_CASE("SchreierSims",
+                          "044",
+                          "base change and many elements at once",
+                          "[quick][schreier-sims]") {
+    auto             rg = ReportGuard(REPORT);
+    constexpr size_t N  = 24;
+    using Perm          = SchreierSims<N>::element_type;
+
+    std::vector<Perm> gens
+        = {Perm({1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12,
+                 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 0,  23}),
+           Perm({0,  1,  16, 12, 3, 5,  8, 17, 2,  6,  11, 22,
+                 13, 18, 19, 14, 9, 10, 4, 21, 15, 20, 7,  23}),
+           Perm({23, 22, 11, 15, 17, 9, 19, 13, 20, 5,  16, 2,
+                 21, 7,  18, 3,  10, 4, 14, 6,  8,  12, 1,  0})};
+
+    // Some elements of M24, and some elements that do not belong to M24
+    std::vector<Perm> elts;
+    Perm              x = gens[0];
+    Perm              y = Perm({0,  1,  3,  2,  4,  5,  6,  7,  8,  9,  10, 11,
+                   12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23});
+    for (size_t i = 0; i < 500; ++i) {
+      elts.push_back(x);
+      elts.push_back(x * y);
+      x = x * gens[i % 3];
+    }
+
+    for (bool sv : {false, true}) {
+      auto S = SchreierSims<N>();
+      S.schreier_vectors(sv);
+      for (auto const& g : gens) {
+        S.add_generator(g);
+      }
+      REQUIRE(S.max_threads() == 1);
+      std::vector<bool> expected;
+      for (auto const& z : elts) {
+        expected.push_back(S.contains(z));
+      }
+      REQUIRE(std::count(expected.cbegin(), expected.cend(), true) == 500);
+      REQUIRE(S.contains(elts.cbegin(), elts.cend()) == expected);
+      S.max_threads(4);
+      REQUIRE(S.max_threads() == 4);
+      REQUIRE(S.contains(elts.cbegin(), elts.cend()) == expected);
+      REQUIRE(S.contains(elts.cbegin(), elts.cbegin()).empty());
+      S.max_threads(0);
+      REQUIRE(S.max_threads() == 1);
+
+      size_t const      k = S.base_size();
+      std::vector<size_t> old_base;
+      for (size_t i = 0; i < k; ++i) {
+        old_base.push_back(S.base(i));
+      }
+      S.transpose_base_points(0);
+      REQUIRE(S.base_size() == k);
+      REQUIRE(S.base(0) == old_base[1]);
+      REQUIRE(S.base(1) == old_base[0]);
+      REQUIRE(S.size() == 244823040);
+      REQUIRE(S.contains(elts.cbegin(), elts.cend()) == expected);
+
+      S.change_base({5, 7, 11, 13});
+      REQUIRE(S.base(0) == 5);
+      REQUIRE(S.base(1) == 7);
+      REQUIRE(S.base(2) == 11);
+      REQUIRE(S.base(3) == 13);
+      REQUIRE(S.size() == 244823040);
+      for (size_t i = 0; i < elts.size(); ++i) {
+        REQUIRE(S.contains(elts[i]) == expected[i]);
+      }
+      // The strong generators at depth i fix the first i base points
+      for (size_t i = 0; i < S.base_size(); ++i) {
+        for (size_t j = 0; j < S.nr_strong_generators(i); ++j) {
+          for (size_t l = 0; l < i; ++l) {
+            REQUIRE(S.strong_generator(i, j)[S.base(l)] == S.base(l));
+          }
+        }
+      }
+
+      REQUIRE_THROWS_AS(S.transpose_base_points(S.base_size() - 1),
+                        LibsemigroupsException);
+      REQUIRE_THROWS_AS(S.change_base({1, 24}), LibsemigroupsException);
+      REQUIRE_THROWS_AS(S.change_base({1, 2, 1}), LibsemigroupsException);
+    }
+  }
+
+  LIBSEMIGROUPS_TEST_CASE("SchreierSims",
+                          "045",
+                          "randomised, more than 2N strong generators",
+                          "[quick][schreier-sims]") {
+    auto             rg = ReportGuard(REPORT);
+    constexpr size_t N  = 17;
+    using Perm          = SchreierSims<N>::element_type;
+
+    // The symmetric group generated by the transpositions (i, i + 1)
+    std::vector<Perm> gens;
+    for (size_t i = 0; i < N - 1; ++i) {
+      Perm x;
+      for (size_t j = 0; j < N; ++j) {
+        x[j] = j;
+      }
+      std::swap(x[i], x[i + 1]);
+      gens.push_back(x);
+    }
+    SchreierSims<N> S;
+    S.randomised(true).confidence(5);
+    for (auto const& x : gens) {
+      S.add_generator(x);
+    }
+    REQUIRE(S.size() == static_cast<uint64_t>(355687428096000));
+    REQUIRE(S.nr_strong_generators(1) > 2 * N);
+
+    SchreierSims<N> T;
+    T.randomised(true).confidence(5).schreier_vectors(true).verify(true);
+    for (auto const& x : gens) {
+      T.add_generator(x);
+    }
+    REQUIRE(T.size() == static_cast<uint64_t>(355687428096000));
+    REQUIRE(T.nr_strong_generators(1) > 2 * N);
+    T.change_base({16, 15, 14});
+    REQUIRE(T.size() == static_cast<uint64_t>(355687428096000));
+    for (size_t i = 0; i < 100; ++i) {
+      REQUIRE(T.contains(gens[i % (N - 1)] * gens[(7 * i) % (N - 1)]));
+    }
+  }
 }  // namespace libsemigroups
@@ -0,0 +1,191 @@
+//
+// libsemigroups - C++ library for semigroups and monoids
+// Copyright (C) 2019 James D. Mitchell
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+// The purpose of this file is to test the ThreadPool and TaskGroup classes,
+// and the function parallel_for.
+
+#include <atomic>      // for atomic
+#include <cstddef>     // for size_t
+#include <functional>  // for function
+#include <stdexcept>   // for runtime_error
+#include <thread>      // for this_thread
+#include <vector>      // for vector
+
+#include "catch.hpp"                    // for REQUIRE, REQUIRE_THROWS_AS
+#include "libsemigroups-exception.hpp"  // for LibsemigroupsException
+#include "parallel.hpp"                 // for parallel_for
+#include "test-main.hpp"                // for LIBSEMIGROUPS_TEST_CASE
+#include "thread-pool.hpp"              // for ThreadPool, TaskGroup
+
+namespace libsemigroups {
+  struct LibsemigroupsException;
+
+  using detail::TaskGroup;
+  using detail::ThreadPool;
+
+  LIBSEMIGROUPS_TEST_CASE("ThreadPool", "001", "run and wait", "[quick]") {
+    ThreadPool tp(4);
+    REQUIRE(tp.size() == 4);
+    REQUIRE(!tp.is_worker());
+    std::vector<size_t> v(1000, 0);
+    TaskGroup           tg(tp);
+    for (size_t i = 0; i < v.size(); ++i) {
+      tg.run([&v, i]() { v[i] = i * i; });
+    }
+    tg.wait();
+    REQUIRE(tg.pending() == 0);
+    for (size_t i = 0; i < v.size(); ++i) {
+      REQUIRE(v[i] == i * i);
+    }
+  }
+
+  LIBSEMIGROUPS_TEST_CASE("ThreadPool", "002", "nested tasks", "[quick]") {
+    // There are more nested waits than threads, this only works because
+    // waiting threads run the queued tasks.
+    ThreadPool          tp(2);
+    std::atomic<size_t> nr(0);
+    TaskGroup           outer(tp);
+    for (size_t i = 0; i < 8; ++i) {
+      outer.run([&tp, &nr]() {
+        TaskGroup inner(tp);
+        for (size_t j = 0; j < 8; ++j) {
+          inner.run([&nr]() { ++nr; });
+        }
+        inner.wait();
+      });
+    }
+    outer.wait();
+    REQUIRE(nr == 64);
+  }
+
+  LIBSEMIGROUPS_TEST_CASE("ThreadPool",
+                          "003",
+                          "tasks that resubmit themselves",
+                          "[quick]") {
+    ThreadPool                      tp(1);
+    TaskGroup                       tg(tp);
+    std::vector<size_t>             v(4, 0);
+    std::function<void(size_t)> step = [&tg, &v, &step](size_t i) {
+      if (++v[i] < 100) {
+        tg.run([&step, i]() { step(i); });
+      }
+    };
+    for (size_t i = 0; i < v.size(); ++i) {
+      tg.run([&step, i]() { step(i); });
+    }
+    tg.wait();
+    REQUIRE(v == std::vector<size_t>(4, 100));
+  }
+
+  LIBSEMIGROUPS_TEST_CASE("ThreadPool", "004", "exceptions", "[quick]") {
+    ThreadPool tp(2);
+    TaskGroup  tg(tp);
+    for (size_t i = 0; i < 10; ++i) {
+      tg.run([i]() {
+        if (i % 3 == 0) {
+          throw std::runtime_error("bananas");
+        }
+      });
+    }
+    REQUIRE_THROWS_AS(tg.wait(), std::runtime_error);
+    // The exception is only rethrown once
+    REQUIRE_NOTHROW(tg.wait());
+
+    std::vector<size_t> v(100, 0);
+    REQUIRE_THROWS_AS(detail::parallel_for(v.size(),
+                                           4,
+                                           1,
+                                           [&v](size_t first, size_t last) {
+                                             if (first != 0) {
+                                               throw std::runtime_error("");
+                                             }
+                                             for (; first < last; ++first) {
+                                               v[first] = 1;
+                                             }
+                                           }),
+                      std::runtime_error);
+  }
+
+  LIBSEMIGROUPS_TEST_CASE("ThreadPool", "005", "resize", "[quick]") {
+    ThreadPool tp(0);
+    REQUIRE(tp.size() == 1);
+    tp.resize(3);
+    REQUIRE(tp.size() == 3);
+    // Submitting the task directly, and not waiting for it in a TaskGroup,
+    // ensures that it is run by a worker, and not by this thread.
+    std::atomic<bool> done(false), is_worker(false), threw(false);
+    tp.submit([&tp, &done, &is_worker, &threw]() {
+      is_worker = tp.is_worker();
+      try {
+        tp.resize(2);
+      } catch (LibsemigroupsException const&) {
+        threw = true;
+      }
+      done = true;
+    });
+    while (!done) {
+      std::this_thread::yield();
+    }
+    REQUIRE(is_worker);
+    REQUIRE(threw);
+    REQUIRE(tp.size() == 3);
+  }
+
+  LIBSEMIGROUPS_TEST_CASE("ThreadPool", "006", "parallel_for", "[quick]") {
+    std::vector<size_t> v(1000, 0);
+    detail::parallel_for(v.size(), 4, 10, [&v](size_t first, size_t last) {
+      for (; first < last; ++first) {
+        v[first] += first;
+      }
+    });
+    for (size_t i = 0; i < v.size(); ++i) {
+      REQUIRE(v[i] == i);
+    }
+    REQUIRE(detail::thread_pool().size() != 0);
+  }
+
+  LIBSEMIGROUPS_TEST_CASE("ThreadPool",
+                          "007",
+                          "wait only runs tasks in its own group",
+                          "[quick]") {
+    ThreadPool tp(1);
+    // Keep the only worker busy, so that the tasks below can only be run by
+    // a thread waiting for them.
+    std::atomic<bool> started(false), release(false);
+    tp.submit([&started, &release]() {
+      started = true;
+      while (!release) {
+        std::this_thread::yield();
+      }
+    });
+    while (!started) {
+      std::this_thread::yield();
+    }
+    std::atomic<bool> ran_a(false), ran_b(false);
+    TaskGroup         a(tp), b(tp);
+    a.run([&ran_a]() { ran_a = true; });
+    b.run([&ran_b]() { ran_b = true; });
+    b.wait();
+    REQUIRE(ran_b);
+    REQUIRE(!ran_a);
+    REQUIRE(a.pending() == 1);
+    release = true;
+    a.wait();
+    REQUIRE(ran_a);
+  }
+}  // namespace libsemigroups
@@ -24,8 +24,11 @@
 #include <chrono>      // for duration, milliseconds
 #include <cstddef>     // for size_t
 #include <functional>  // for mem_fn
+#include <memory>      // for make_shared
+#include <string>      // for string
 #include <vector>      // for vector
 
+#include "blackboard.hpp"       // for Blackboard
 #include "bmat8.hpp"            // for Bmat8
 #include "catch.hpp"            // for SECTION, REQUIRE, REQUIRE_THROWS_AS
 #include "cong-intf.hpp"        // for congruence::type
@@ -1744,6 +1747,50 @@ namespace libsemigroups {
       REQUIRE(copy.complete());
       REQUIRE(copy.compatible());
     }
+
+    LIBSEMIGROUPS_TEST_CASE("ToddCoxeter",
+                            "102",
+                            "batch word_to_class_index and contains",
+                            "[todd-coxeter][quick]") {
+      auto rg    = ReportGuard(REPORT);
+      auto words = shortlex_words(2, 10);
+      words.push_back({});
+
+      for (auto knd : {twosided, left, right}) {
+        ToddCoxeter tc(knd);
+        tc.set_nr_generators(2);
+        tc.add_pair({0, 0, 0}, {0});
+        tc.add_pair({1, 1, 1, 1}, {1});
+        tc.add_pair({0, 1, 0, 1}, {0, 0});
+        tc.max_threads(4);
+        REQUIRE(tc.max_threads() == 4);
+
+        auto result = tc.words_to_class_indices(words);
+        REQUIRE(result.size() == words.size());
+        for (size_t i = 0; i < words.size(); ++i) {
+          REQUIRE(result[i] == tc.word_to_class_index(words[i]));
+        }
+
+        std::vector<relation_type> pairs;
+        for (size_t i = 0; i < 100; ++i) {
+          pairs.emplace_back(words[i], words[words.size() - i - 2]);
+          pairs.emplace_back(words[i], words[i]);
+        }
+        auto found = tc.contains(pairs);
+        REQUIRE(found.size() == pairs.size());
+        for (size_t i = 0; i < pairs.size(); ++i) {
+          REQUIRE(found[i] == tc.contains(pairs[i].first, pairs[i].second));
+        }
+      }
+      {
+        ToddCoxeter tc(twosided);
+        tc.set_nr_generators(2);
+        REQUIRE(tc.contains({{{0, 1}, {0, 1}}, {{0, 1}, {1, 0}}})
+                == std::vector<bool>({true, false}));
+        REQUIRE_THROWS_AS(tc.words_to_class_indices({{0}, {2}}),
+                          LibsemigroupsException);
+      }
+    }
   }  // namespace congruence
 
   namespace fpsemigroup {
@@ -3557,5 +3604,73 @@ namespace libsemigroups {
       REQUIRE_THROWS_AS(tc.congruence().sort_generating_pairs(shortlex_compare),
                         LibsemigroupsException);
     }
+
+    LIBSEMIGROUPS_TEST_CASE("ToddCoxeter",
+                            "099",
+                            "normal_forms and equal_to (many words)",
+                            "[todd-coxeter][quick]") {
+      auto        rg = ReportGuard(REPORT);
+      ToddCoxeter tc;
+      tc.set_alphabet("ab");
+      tc.add_rule("aaa", "a");
+      tc.add_rule("bbbb", "b");
+      tc.add_rule("abbbbbabb", "bba");
+      tc.max_threads(4);
+
+      auto words = shortlex_words(2, 10);
+      auto nfs   = tc.normal_forms(words);
+      REQUIRE(nfs.size() == words.size());
+      for (size_t i = 0; i < words.size(); ++i) {
+        REQUIRE(nfs[i] == tc.normal_form(words[i]));
+      }
+      std::sort(nfs.begin(), nfs.end());
+      nfs.erase(std::unique(nfs.begin(), nfs.end()), nfs.end());
+      REQUIRE(nfs.size() == 12);
+
+      REQUIRE(tc.normal_forms(std::vector<std::string>({"aaa", "bbbbbbb"}))
+              == std::vector<std::string>({"a", "b"}));
+      REQUIRE(tc.equal_to(std::vector<relation_type>(
+                  {{{0, 0, 0}, {0}}, {{0}, {1}}, {{1, 1, 1, 1}, {1}}}))
+              == std::vector<bool>({true, false, true}));
+      REQUIRE(tc.normal_forms(std::vector<word_type>()).empty());
+      REQUIRE_THROWS_AS(tc.normal_forms(std::vector<word_type>({{0}, {}})),
+                        LibsemigroupsException);
+    }
+
+    LIBSEMIGROUPS_TEST_CASE("ToddCoxeter",
+                            "100",
+                            "consuming pairs from a blackboard",
+                            "[todd-coxeter][quick]") {
+      auto        rg = ReportGuard(REPORT);
+      ToddCoxeter tc;
+      tc.set_alphabet("a");
+      tc.add_rule("aaaaa", "a");
+      auto bb = std::make_shared<detail::Blackboard>();
+      // Only a runner computing the same semigroup should publish a pair,
+      // here we publish one that does not hold, to check that it is used.
+      bb->publish(nullptr, {0, 0, 0}, {0});
+      tc.blackboard(bb);
+      REQUIRE(tc.size() == 2);
+    }
+
+    LIBSEMIGROUPS_TEST_CASE("ToddCoxeter",
+                            "101",
+                            "memory_limit",
+                            "[todd-coxeter][quick]") {
+      auto        rg = ReportGuard(REPORT);
+      ToddCoxeter tc;
+      tc.set_alphabet("ab");
+      tc.add_rule("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", "a");
+      tc.add_rule("bbb", "b");
+      tc.add_rule("ababa", "b");
+      tc.add_rule("aaaaaaaaaaaaaaaabaaaabaaaaaaaaaaaaaaaabaaaa", "b");
+      // The enumeration defines far more cosets than fit in 64KB.
+      tc.memory_limit(size_t(1) << 16);
+      tc.run();
+      REQUIRE(!tc.finished());
+      REQUIRE(tc.over_memory_limit());
+      REQUIRE(tc.memory_used() > size_t(1) << 16);
+      REQUIRE(tc.memory_used() == tc.congruence().memory_used());
+    }
   }  // namespace fpsemigroup
 }  // namespace libsemigroups
@@ -236,4 +236,40 @@ namespace libsemigroups {
     REQUIRE(uf1.next_rep() == 6);
     REQUIRE(uf1.next_rep() == 8);
   }
+
+  LIBSEMIGROUPS_TEST_CASE("UF",
+                          "016",
+                          "find returns the least entry",
+                          "[quick]") {
+    UF uf(8);
+    // By rank, 3 is the root of the block {0, 1, 3, 4, 5, 6}, but find returns
+    // the least entry 0
+    uf.unite(3, 4);
+    uf.unite(5, 6);
+    uf.unite(3, 5);
+    uf.unite(1, 0);
+    uf.unite(0, 6);
+    REQUIRE(uf.nr_blocks() == 3);
+    for (size_t i : {0, 1, 3, 4, 5, 6}) {
+      REQUIRE(uf.find(i) == 0);
+    }
+    REQUIRE(uf.find(2) == 2);
+    REQUIRE(uf.find(7) == 7);
+    uf.unite(7, 2);
+    REQUIRE(uf.nr_blocks() == 2);
+    REQUIRE(uf.find(7) == 2);
+    uf.unite(7, 2);
+    REQUIRE(uf.nr_blocks() == 2);
+
+    UF uf2(uf);
+    REQUIRE(uf2.nr_blocks() == 2);
+    REQUIRE(uf2.find(6) == 0);
+
+    uf.flatten();
+    REQUIRE(*uf.get_table() == UF::table_type({0, 0, 2, 0, 0, 0, 0, 2}));
+    REQUIRE(uf.nr_blocks() == 2);
+    uf.unite(2, 6);
+    REQUIRE(uf.nr_blocks() == 1);
+    REQUIRE(uf.find(7) == 0);
+  }
 }  // namespace libsemigroups